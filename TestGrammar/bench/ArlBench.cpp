@@ -0,0 +1,614 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief arl_bench: micro-benchmarks of the TestGrammar internals
+///
+/// Times the code that is most often tuned - reading Arlington TSV files,
+/// parsing and evaluating predicates, the PDF SDK shim dictionary accessors
+/// and parsing the objects of a PDF - on fixed inputs (an Arlington TSV file
+/// set and a PDF). Each benchmark is repeated and the median time per operation
+/// is reported. Results can be saved as JSON and compared against a saved
+/// baseline, so changes can be measured before and after.
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ArlingtonPDFShim.h"
+#include "ArlingtonTSVGrammarFile.h"
+#include "ArlVersion.h"
+#include "ASTNode.h"
+#include "LRParsePredicate.h"
+#include "PDFFile.h"
+#include "TestGrammarVers.h"
+#include "sarge.h"
+#include "utils.h"
+
+using namespace ArlingtonPDFShim;
+namespace fs = std::filesystem;
+
+#ifndef ARL_BENCH_TSVDIR
+#define ARL_BENCH_TSVDIR "../tsv/latest"
+#endif
+#ifndef ARL_BENCH_PDF
+#define ARL_BENCH_PDF "../PDF-Days-2021-Arlington-PDF-model.pdf"
+#endif
+
+/// @brief Results of benchmarked code are added here so the compiler cannot remove the code
+static volatile uint64_t bench_sink = 0;
+
+
+/// @brief A micro-benchmark. Each call of run() performs all of its operations once
+/// and returns how many operations there were (0 if there is no input).
+struct bench_case {
+    std::string                 name;
+    std::function<uint64_t()>   run;
+};
+
+
+/// @brief Timings of a micro-benchmark, in nanoseconds per operation
+struct bench_result {
+    std::string     name;
+    uint64_t        ops = 0;            // operations per call of run()
+    unsigned int    iterations = 0;     // calls of run() per repetition
+    double          median_ns = 0.0;
+    double          min_ns = 0.0;
+    double          max_ns = 0.0;
+};
+
+
+/// @brief Times a micro-benchmark. The first call warms up caches and sets the number of
+/// calls so that each repetition lasts at least min_ms. The median of the repetitions is
+/// used because it is not affected by the occasional slow repetition.
+///
+/// @param[in]  bench        the micro-benchmark
+/// @param[in]  repetitions  number of timed repetitions (>= 1)
+/// @param[in]  min_ms       minimum duration of a repetition in milliseconds
+/// @param[out] result       the timings
+///
+/// @returns false if the micro-benchmark had no input
+static bool measure(const bench_case& bench, const unsigned int repetitions, const unsigned int min_ms, bench_result& result)
+{
+    result.name = bench.name;
+    auto start = std::chrono::steady_clock::now();
+    result.ops = bench.run();
+    double once = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (result.ops == 0)
+        return false;
+    result.iterations = (unsigned int)std::max(1.0, std::ceil(min_ms / std::max(once, 0.001)));
+
+    std::vector<double> ns_per_op;
+    for (unsigned int r = 0; r < repetitions; r++) {
+        uint64_t ops = 0;
+        start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < result.iterations; i++)
+            ops += bench.run();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        ns_per_op.push_back(ns / (double)std::max(ops, (uint64_t)1));
+    }
+    std::sort(ns_per_op.begin(), ns_per_op.end());
+    size_t mid = ns_per_op.size() / 2;
+    result.median_ns = (ns_per_op.size() % 2 == 1) ? ns_per_op[mid] : (ns_per_op[mid - 1] + ns_per_op[mid]) / 2.0;
+    result.min_ns = ns_per_op.front();
+    result.max_ns = ns_per_op.back();
+    return true;
+}
+
+
+/// @brief Reads every PDF object reachable from the trailer of an open PDF, once each.
+/// Dictionaries (including stream dictionaries) are passed to keep(), which returns true to
+/// take ownership of the dictionary.
+///
+/// @param[in] pdfsdk  PDF SDK with an open PDF
+/// @param[in] keep    optional callback for every dictionary
+///
+/// @returns the number of PDF objects read
+static uint64_t walk_pdf(ArlingtonPDFSDK& pdfsdk, const std::function<bool(ArlPDFDictionary*)>& keep)
+{
+    ArlPDFTrailer* trailer = pdfsdk.get_trailer();
+    if (trailer == nullptr)
+        return 0;
+
+    std::set<int>               visited;    // object numbers of indirect objects
+    std::vector<ArlPDFObject*>  to_process = { trailer };
+    uint64_t                    count = 0;
+
+    auto add = [&](ArlPDFObject* obj) {
+        if (obj == nullptr)
+            return;
+        if (obj->is_indirect_ref() && !visited.insert(obj->get_object_number()).second) {
+            delete obj;
+            return;
+        }
+        to_process.push_back(obj);
+    };
+
+    while (!to_process.empty()) {
+        ArlPDFObject* obj = to_process.back();
+        to_process.pop_back();
+        count++;
+
+        ArlPDFDictionary* dict = nullptr;
+        switch (obj->get_object_type()) {
+            case PDFObjectType::ArlPDFObjTypeArray:
+                {
+                    ArlPDFArray* arr = (ArlPDFArray*)obj;
+                    int n = arr->get_num_elements();
+                    for (int i = 0; i < n; i++)
+                        add(arr->get_value(i));
+                }
+                break;
+            case PDFObjectType::ArlPDFObjTypeStream:
+                dict = ((ArlPDFStream*)obj)->get_dictionary();
+                break;
+            case PDFObjectType::ArlPDFObjTypeDictionary:
+                dict = (ArlPDFDictionary*)obj;
+                break;
+            default:
+                break;
+        }
+
+        bool kept = false;
+        if (dict != nullptr) {
+            int n = dict->get_num_keys();
+            for (int i = 0; i < n; i++)
+                add(dict->get_value(dict->get_key_name_by_index(i)));
+            kept = keep && keep(dict);
+            if ((dict != obj) && !kept)
+                delete dict;
+        }
+        if (obj->is_deleteable() && !(kept && (dict == obj)))
+            delete obj;
+    }
+    return count;
+}
+
+
+/// @brief Returns the Arlington TSV file for a dictionary from its Type and Subtype keys
+/// (e.g. PageObject, FontType1, AnnotLink), or an empty string
+///
+/// @param[in] dict      PDF dictionary
+/// @param[in] tsv_dir   folder with the Arlington TSV file set
+static std::string tsv_for_dictionary(ArlPDFDictionary* dict, const fs::path& tsv_dir)
+{
+    auto name_of = [dict](const std::wstring& key) {
+        std::string s;
+        ArlPDFObject* obj = dict->get_value(key);
+        if (obj != nullptr) {
+            if (obj->get_object_type() == PDFObjectType::ArlPDFObjTypeName)
+                s = ToUtf8(((ArlPDFName*)obj)->get_value());
+            delete obj;
+        }
+        return s;
+    };
+
+    std::string type = name_of(L"Type");
+    if (type == "Catalog")
+        return type;
+    if (type == "Page")
+        return "PageObject";
+    std::string subtype = name_of(L"Subtype");
+    if ((type == "XObject") && (subtype == "Form"))
+        subtype = "FormType1";
+    if (type.empty() || subtype.empty() || !is_file(tsv_dir / (type + subtype + ".tsv")))
+        return "";
+    return type + subtype;
+}
+
+
+/// @brief Writes a string as a JSON string
+static void write_json_string(std::ostream& ofs, const std::string& s)
+{
+    ofs << '"';
+    for (auto c : s) {
+        if ((c == '"') || (c == '\\'))
+            ofs << '\\' << c;
+        else if ((unsigned char)c < 0x20)
+            ofs << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+        else
+            ofs << c;
+    }
+    ofs << '"';
+}
+
+
+/// @brief Returns the value of a field in a line of a --json file, without any quotes
+static std::string json_field(const std::string& line, const std::string& field)
+{
+    std::string tag = "\"" + field + "\": ";
+    size_t p = line.find(tag);
+    if (p == std::string::npos)
+        return "";
+    p += tag.size();
+    if ((p < line.size()) && (line[p] == '"')) {
+        size_t e = line.find('"', p + 1);
+        return line.substr(p + 1, (e == std::string::npos) ? std::string::npos : e - p - 1);
+    }
+    size_t e = line.find_first_of(",}", p);
+    return line.substr(p, (e == std::string::npos) ? std::string::npos : e - p);
+}
+
+
+/// @brief Reads the median timings of a --json file of an earlier run. Only the layout
+/// written by arl_bench (one result per line) is understood.
+///
+/// @param[in]  fname     --baseline file
+/// @param[out] baseline  median nanoseconds per operation of each micro-benchmark
+///
+/// @returns false if the file could not be read or had no results
+static bool read_baseline(const fs::path& fname, std::map<std::string, double>& baseline)
+{
+    std::ifstream f(fname);
+    if (!f.is_open())
+        return false;
+    std::string line;
+    while (std::getline(f, line)) {
+        std::string name = json_field(line, "name");
+        std::string median = json_field(line, "median_ns");
+        if (!name.empty() && !median.empty())
+            baseline[name] = strtod(median.c_str(), nullptr);
+    }
+    return !baseline.empty();
+}
+
+
+int main(int argc, char* argv[]) {
+    Sarge   sarge;
+    sarge.setDescription("Arlington PDF Model C++ P.o.C. micro-benchmarks version " TestGrammar_VERSION);
+    sarge.setUsage("arl_bench [--tsvdir <dir>] [--pdf <fname>] [--repetitions <n>] [--min-time <ms>] [--filter <name>] [--json <file>] [--baseline <file>] [--tolerance <pct>] [--no-color]");
+    sarge.setArgument("h", "help", "This usage message.", false);
+    sarge.setArgument("t", "tsvdir", "folder containing Arlington PDF model TSV file set. Default is " ARL_BENCH_TSVDIR, true);
+    sarge.setArgument("p", "pdf", "PDF file to benchmark with. Default is " ARL_BENCH_PDF, true);
+    sarge.setArgument("r", "repetitions", "number of timed repetitions of each benchmark (default 7).", true);
+    sarge.setArgument("",  "min-time", "minimum duration of each repetition in milliseconds (default 200).", true);
+    sarge.setArgument("",  "filter", "only run benchmarks whose name contains this string.", true);
+    sarge.setArgument("",  "json", "write the results to this JSON file (e.g. to use as a later --baseline).", true);
+    sarge.setArgument("",  "baseline", "compare against the results in this JSON file of an earlier run.", true);
+    sarge.setArgument("",  "tolerance", "with --baseline, report benchmarks that are this many percent slower as regressions (default 10).", true);
+    sarge.setArgument("",  "no-color", "disable colorized text output (useful when redirecting or piping output)", false);
+
+    if (!sarge.parseArguments(argc, argv)) {
+        std::cerr << COLOR_ERROR << "error parsing command line arguments" << COLOR_RESET;
+        sarge.printHelp();
+        return -1;
+    }
+    if (sarge.exists("help")) {
+        sarge.printHelp();
+        return 0;
+    }
+    no_color = sarge.exists("no-color");
+
+    std::string     s;
+    fs::path        grammar_folder = ARL_BENCH_TSVDIR;
+    fs::path        pdf_file = ARL_BENCH_PDF;
+    unsigned int    repetitions = 7;
+    unsigned int    min_ms = 200;
+    std::string     filter;
+    fs::path        json_filename;
+    fs::path        baseline_filename;
+    double          tolerance = 10.0;
+
+    if (sarge.getFlag("tsvdir", s))
+        grammar_folder = s;
+    grammar_folder = fs::absolute(grammar_folder).lexically_normal();
+    if (!is_folder(grammar_folder)) {
+        std::cerr << COLOR_ERROR << "--tsvdir " << grammar_folder << " is not a folder!" << COLOR_RESET;
+        return -1;
+    }
+    if (sarge.getFlag("pdf", s))
+        pdf_file = s;
+    pdf_file = fs::absolute(pdf_file).lexically_normal();
+    if (!is_file(pdf_file)) {
+        std::cerr << COLOR_ERROR << "--pdf " << pdf_file << " is not a file!" << COLOR_RESET;
+        return -1;
+    }
+    if (sarge.getFlag("repetitions", s)) {
+        repetitions = (unsigned int)strtoul(s.c_str(), nullptr, 10);
+        if (repetitions < 1) {
+            std::cerr << COLOR_ERROR << "--repetitions must be at least 1!" << COLOR_RESET;
+            return -1;
+        }
+    }
+    if (sarge.getFlag("min-time", s))
+        min_ms = (unsigned int)strtoul(s.c_str(), nullptr, 10);
+    (void)sarge.getFlag("filter", filter);
+    if (sarge.getFlag("json", s))
+        json_filename = fs::absolute(s).lexically_normal();
+    if (sarge.getFlag("tolerance", s))
+        tolerance = strtod(s.c_str(), nullptr);
+
+    std::map<std::string, double> baseline;
+    if (sarge.getFlag("baseline", s)) {
+        baseline_filename = fs::absolute(s).lexically_normal();
+        if (!read_baseline(baseline_filename, baseline)) {
+            std::cerr << COLOR_ERROR << "--baseline " << baseline_filename << " could not be read!" << COLOR_RESET;
+            return -1;
+        }
+    }
+
+    ArlingtonPDFSDK pdf_io;         // PDF SDK for the PDF that stays open
+    ArlingtonPDFSDK parse_io;       // PDF SDK that repeatedly opens and parses the PDF
+    try {
+        pdf_io.initialize();
+        parse_io.initialize();
+    }
+    catch (const std::exception& e) {
+        std::cerr << COLOR_ERROR << "EXCEPTION " << e.what() << COLOR_RESET;
+        return -1;
+    }
+
+    std::cout << "arl_bench " << TestGrammar_VERSION << std::endl;
+    std::cout << "PDF SDK:              " << pdf_io.get_version_string() << std::endl;
+    std::cout << "Arlington TSV data:   " << grammar_folder << std::endl;
+    std::cout << "PDF:                  " << pdf_file << std::endl;
+    std::cout << "Repetitions:          " << repetitions << " of at least " << min_ms << " ms" << std::endl;
+#ifdef DEBUG
+    std::cout << COLOR_WARNING << "this is a Debug build - use a Release build for meaningful timings" << COLOR_RESET;
+#endif // DEBUG
+
+    // Fixed inputs: all TSV files of the TSV file set in name order...
+    std::vector<fs::path> tsv_files;
+    for (const auto& entry : fs::directory_iterator(grammar_folder))
+        if (entry.is_regular_file() && (entry.path().extension() == ".tsv"))
+            tsv_files.push_back(entry.path());
+    std::sort(tsv_files.begin(), tsv_files.end());
+
+    // ... every predicate in them, split up as when validating the Arlington PDF model...
+    CArlingtonTSVGrammarCache   grammar(grammar_folder);
+    std::vector<std::string>    predicates;
+    for (const auto& f : tsv_files) {
+        for (const auto& row : grammar.get_grammar(f.stem().string()))
+            for (const auto& col : row)
+                for (auto& fn : split(col, ';'))
+                    if (fn.find("fn:") != std::string::npos) {
+                        if ((fn[0] == '[') && (fn[fn.size() - 1] == ']'))
+                            fn = fn.substr(1, fn.size() - 2);
+                        predicates.push_back(fn);
+                    }
+    }
+
+    // ... and the PDF. The dictionary with the most keys and the values of keys with Required predicates
+    // in their Arlington definition are kept for the shim and predicate evaluation benchmarks.
+    if (!pdf_io.open_pdf(pdf_file, L"")) {
+        std::cerr << COLOR_ERROR << "--pdf " << pdf_file << " could not be opened!" << COLOR_RESET;
+        return -1;
+    }
+    CPDFFile pdf(pdf_file, pdf_io, "", {}, (size_t)fs::file_size(pdf_file));
+    std::ostringstream ignored;
+    int pdf_version = string_to_pdf_version(pdf.check_and_get_pdf_version(ignored));
+
+    struct eval_case {
+        ArlPDFDictionary*   dict;
+        ArlPDFObject*       object;
+        const ArlTSVmatrix* tsv;
+        int                 key_idx;
+        int                 type_idx;
+        ASTNode*            ast;
+    };
+    std::vector<ArlPDFDictionary*>  kept_dicts;
+    std::vector<eval_case>          eval_cases;
+    ArlPDFDictionary*               largest_dict = nullptr;
+    int                             largest_keys = 0;
+
+    (void)walk_pdf(pdf_io, [&](ArlPDFDictionary* dict) {
+        bool keep = false;
+        std::string link = tsv_for_dictionary(dict, grammar_folder);
+        if (!link.empty()) {
+            const ArlTSVmatrix& tsv = grammar.get_grammar(link);
+            for (int key_idx = 0; key_idx < (int)tsv.size(); key_idx++) {
+                const std::string& required = tsv[key_idx][TSV_REQUIRED];
+                if ((required.find("fn:") == std::string::npos) || (tsv[key_idx][TSV_KEYNAME].find('*') != std::string::npos))
+                    continue;
+                // As when checking PDF objects, the parent is the dictionary and the object is the value of the key
+                ArlPDFObject* object = dict->get_value(ToWString(tsv[key_idx][TSV_KEYNAME]));
+                if (object == nullptr)
+                    continue;
+                ArlVersion versioner(object, tsv[key_idx], pdf_version, pdf.get_extensions());
+                if (versioner.get_arlington_type_index() < 0) {
+                    delete object;
+                    continue;
+                }
+                ASTNode* ast = new ASTNode();
+                (void)LRParsePredicate(required, ast);
+                eval_cases.push_back({ dict, object, &tsv, key_idx, versioner.get_arlington_type_index(), ast });
+                keep = true;
+            }
+        }
+        if (dict->get_num_keys() > largest_keys) {
+            largest_keys = dict->get_num_keys();
+            largest_dict = dict;
+            keep = true;
+        }
+        if (keep)
+            kept_dicts.push_back(dict);
+        return keep;
+    });
+
+    std::vector<std::wstring> largest_keys_list;
+    if (largest_dict != nullptr)
+        for (int i = 0; i < largest_keys; i++)
+            largest_keys_list.push_back(largest_dict->get_key_name_by_index(i));
+
+    std::cout << "Inputs:               " << tsv_files.size() << " TSV files, " << predicates.size() << " predicates, "
+              << eval_cases.size() << " Required predicates of PDF keys, largest dictionary " << largest_keys << " keys" << std::endl;
+
+    std::vector<bench_case> benchmarks = {
+        // CArlingtonTSVGrammarFile::load of every TSV file (operation = 1 TSV file)
+        { "tsv_load", [&]() {
+            for (const auto& f : tsv_files) {
+                CArlingtonTSVGrammarFile tsv(f);
+                if (tsv.load())
+                    bench_sink = bench_sink + tsv.get_data().size();
+            }
+            return (uint64_t)tsv_files.size();
+        } },
+        // LRParsePredicate of every predicate (operation = 1 predicate expression)
+        { "predicate_parse", [&]() {
+            uint64_t ops = 0;
+            for (const auto& p : predicates) {
+                std::string expr = p;
+                while (!expr.empty()) {
+                    if (expr[0] == ' ')
+                        expr = expr.substr(1, expr.size() - 1);
+                    ASTNode* ast = new ASTNode();
+                    expr = LRParsePredicate(expr, ast);
+                    bench_sink = bench_sink + ast->node.size();
+                    delete ast;
+                    ops++;
+                    if ((expr.size() > 0) && ((expr[0] == ',') || (expr[0] == '[') || (expr[0] == ']') || (expr[0] == ';') || (expr[0] == ' ')))
+                        expr = expr.substr(1, expr.size() - 1);
+                }
+            }
+            return ops;
+        } },
+        // CPDFFile::ProcessPredicate of Required predicates, as when checking PDF objects (operation = 1 predicate)
+        { "predicate_eval", [&]() {
+            for (const auto& c : eval_cases) {
+                pdf.ClearPredicateStatus();
+                ASTNode* pp = pdf.ProcessPredicate(c.dict, c.object, c.ast, c.key_idx, *c.tsv, c.type_idx, 0, false);
+                if (pp != nullptr) {
+                    bench_sink = bench_sink + pp->node.size();
+                    delete pp;
+                }
+            }
+            return (uint64_t)eval_cases.size();
+        } },
+        // ArlPDFDictionary::has_key for every key of the largest dictionary and as many missing keys (operation = 1 lookup)
+        { "shim_has_key", [&]() {
+            for (const auto& k : largest_keys_list) {
+                bench_sink = bench_sink + (largest_dict->has_key(k) ? 1 : 0);
+                bench_sink = bench_sink + (largest_dict->has_key(k + L"_") ? 1 : 0);
+            }
+            return (uint64_t)largest_keys_list.size() * 2;
+        } },
+        // ArlPDFDictionary::get_value for every key of the largest dictionary (operation = 1 value)
+        { "shim_get_value", [&]() {
+            for (const auto& k : largest_keys_list) {
+                ArlPDFObject* obj = largest_dict->get_value(k);
+                if (obj != nullptr) {
+                    bench_sink = bench_sink + (uint64_t)obj->get_object_type();
+                    delete obj;
+                }
+            }
+            return (uint64_t)largest_keys_list.size();
+        } },
+        // Opening the PDF and reading every object once with the PDF SDK (operation = 1 PDF object)
+        { "pdf_parse", [&]() {
+            if (!parse_io.open_pdf(pdf_file, L""))
+                return (uint64_t)0;
+            uint64_t n = walk_pdf(parse_io, nullptr);
+            parse_io.close_pdf();
+            return n;
+        } },
+    };
+
+    std::vector<bench_result>   results;
+    unsigned int                regressions = 0;
+    std::cout << std::endl << std::left << std::setw(18) << "Benchmark" << std::right << std::setw(10) << "ops/call" << std::setw(8) << "calls"
+              << std::setw(14) << "median ns/op" << std::setw(12) << "min ns/op" << std::setw(9) << "spread";
+    if (!baseline.empty())
+        std::cout << std::setw(16) << "baseline ns/op" << std::setw(9) << "change";
+    std::cout << std::endl;
+    std::cout << std::fixed;
+
+    for (const auto& b : benchmarks) {
+        if (!filter.empty() && (b.name.find(filter) == std::string::npos))
+            continue;
+        bench_result r;
+        if (!measure(b, repetitions, min_ms, r)) {
+            std::cout << std::left << std::setw(18) << b.name << std::right << " skipped (no input)" << std::endl;
+            continue;
+        }
+        results.push_back(r);
+        // spread is the difference between the slowest and fastest repetitions
+        std::cout << std::left << std::setw(18) << r.name << std::right << std::setw(10) << r.ops << std::setw(8) << r.iterations
+                  << std::setprecision(1) << std::setw(14) << r.median_ns << std::setw(12) << r.min_ns
+                  << std::setw(8) << (100.0 * (r.max_ns - r.min_ns) / r.median_ns) << "%";
+        if (!baseline.empty()) {
+            auto it = baseline.find(r.name);
+            if ((it == baseline.end()) || (it->second <= 0.0))
+                std::cout << std::setw(16) << "-";
+            else {
+                double change = 100.0 * (r.median_ns - it->second) / it->second;
+                std::cout << std::setw(16) << it->second << std::setw(8) << std::showpos << change << "%" << std::noshowpos;
+                if (change > tolerance) {
+                    std::cout << " REGRESSION";
+                    regressions++;
+                }
+            }
+        }
+        std::cout << std::endl;
+    }
+    std::cout.unsetf(std::ios_base::floatfield);
+
+    for (auto& c : eval_cases) {
+        delete c.ast;
+        delete c.object;
+    }
+    for (auto& d : kept_dicts)
+        if (d->is_deleteable())
+            delete d;
+    pdf_io.close_pdf();
+    parse_io.shutdown();
+    pdf_io.shutdown();
+
+    int retval = 0;
+    if (!json_filename.empty()) {
+        std::ofstream json(json_filename, std::ofstream::out | std::ofstream::trunc);
+        json << "{" << std::endl;
+        json << "  \"arl_bench\": ";
+        write_json_string(json, TestGrammar_VERSION);
+        json << "," << std::endl << "  \"tsvdir\": ";
+        write_json_string(json, grammar_folder.string());
+        json << "," << std::endl << "  \"pdf\": ";
+        write_json_string(json, pdf_file.string());
+        json << "," << std::endl << "  \"repetitions\": " << repetitions << "," << std::endl;
+        json << "  \"results\": [" << std::endl;
+        json << std::setprecision(3) << std::fixed;
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& r = results[i];
+            json << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops << ", \"iterations\": " << r.iterations
+                 << ", \"median_ns\": " << r.median_ns << ", \"min_ns\": " << r.min_ns << ", \"max_ns\": " << r.max_ns << "}"
+                 << ((i + 1 < results.size()) ? "," : "") << std::endl;
+        }
+        json << "  ]" << std::endl << "}" << std::endl;
+        if (!json) {
+            std::cerr << COLOR_ERROR << "--json " << json_filename << " could not be written!" << COLOR_RESET;
+            retval = -1;
+        }
+        else
+            std::cout << "Results written to " << json_filename << std::endl;
+    }
+
+    if (regressions > 0) {
+        std::cerr << COLOR_ERROR << regressions << " benchmark(s) more than " << tolerance << "% slower than --baseline " << baseline_filename << COLOR_RESET;
+        retval = 1;
+    }
+    return retval;
+}
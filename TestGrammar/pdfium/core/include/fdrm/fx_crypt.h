@@ -24,6 +24,12 @@ void CRYPT_SHA1Generate(FX_LPCBYTE data, FX_DWORD size, FX_BYTE digest[20]);
 void CRYPT_SHA1Start(FX_LPVOID context);
 void CRYPT_SHA1Update(FX_LPVOID context, FX_LPCBYTE data, FX_DWORD size);
 void CRYPT_SHA1Finish(FX_LPVOID context, FX_BYTE digest[20]);
+typedef struct {
+    FX_DWORD total[2];
+    FX_DWORD state[8];
+    FX_BYTE buffer[64];
+}
+sha256_context;
 void CRYPT_SHA256Generate(FX_LPCBYTE data, FX_DWORD size, FX_BYTE digest[32]);
 void CRYPT_SHA256Start(FX_LPVOID context);
 void CRYPT_SHA256Update(FX_LPVOID context, FX_LPCBYTE data, FX_DWORD size);
@@ -161,12 +161,6 @@ void CRYPT_SHA1Generate(FX_LPCBYTE data, FX_DWORD size, FX_BYTE digest[20])
     CRYPT_SHA1Update(&s, data, size);
     CRYPT_SHA1Finish(&s, digest);
 }
-typedef struct {
-    FX_DWORD total[2];
-    FX_DWORD state[8];
-    FX_BYTE buffer[64];
-}
-sha256_context;
 #define GET_FX_DWORD(n,b,i)                       \
     {                                               \
         (n) = ( (FX_DWORD) (b)[(i)    ] << 24 )       \
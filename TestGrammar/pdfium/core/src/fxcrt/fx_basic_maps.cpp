@@ -6,8 +6,9 @@
 
 #include "../../include/fxcrt/fx_ext.h"
 #include "plex.h"
-// Global to suppress capturing duplicate keys (such as when rebuilding PDFs and encountering multiple trailers)
-FX_BOOL gSuppressDuplicateKeys = FALSE;
+// Global to suppress capturing duplicate keys (such as when rebuilding PDFs and encountering multiple trailers).
+// Per thread as each thread parses its own PDF documents (TestGrammar --jobs).
+thread_local FX_BOOL gSuppressDuplicateKeys = FALSE;
 
 static void ConstructElement(CFX_ByteString* pNewData)
 {
@@ -0,0 +1,360 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Report message severities and JSON Lines output
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sstream>
+
+#include "ArlMessages.h"
+
+
+/// @brief Returns the severity of a message. Matches the "Error:", "Warning:" or "Info:" of the text message.
+///
+/// @param[in] code   the message code
+///
+/// @returns the severity
+ArlMessageType get_message_type(const ArlMessageCode code)
+{
+    switch (code) {
+    case ArlMessageCode::Begin:
+    case ArlMessageCode::End:
+    case ArlMessageCode::XRefStream:
+    case ArlMessageCode::TraditionalTrailer:
+    case ArlMessageCode::UnsupportedEncryption:
+    case ArlMessageCode::Encrypted:
+    case ArlMessageCode::LatestFeature:
+    case ArlMessageCode::Suppressed:
+    case ArlMessageCode::HeaderVersion:
+    case ArlMessageCode::CatalogVersion:
+    case ArlMessageCode::RoundedUpVersion:
+    case ArlMessageCode::ForcedVersion:
+    case ArlMessageCode::ProcessingAsVersion:
+    case ArlMessageCode::FeatureAfterObsolescence:
+    case ArlMessageCode::FeatureBeforeIntroduction:
+    case ArlMessageCode::FeatureDeprecated:
+    case ArlMessageCode::FeatureOnlyInVersion:
+    case ArlMessageCode::MetadataKey:
+    case ArlMessageCode::AssociatedFilesKey:
+    case ArlMessageCode::SecondClassKey:
+    case ArlMessageCode::ThirdClassKey:
+    case ArlMessageCode::UnknownKey:
+    case ArlMessageCode::ArrayTooLong:
+        return ArlMessageType::Info;
+
+    case ArlMessageCode::XRefStreamOldHeader:
+    case ArlMessageCode::TwoContexts:
+    case ArlMessageCode::BitmaskNot32Bit:
+    case ArlMessageCode::IntegerOutOfRange:
+    case ArlMessageCode::BitmaskNotInteger:
+    case ArlMessageCode::NameTooLong:
+    case ArlMessageCode::StringUTF16LE:
+    case ArlMessageCode::StringUnprintable:
+    case ArlMessageCode::PossiblyInvalidDate:
+    case ArlMessageCode::RectangleLength:
+    case ArlMessageCode::MatrixLength:
+    case ArlMessageCode::SpecialCasePossiblyWrong:
+    case ArlMessageCode::PossiblyWrongValue:
+    case ArlMessageCode::RequiredKeyMaybeMissing:
+    case ArlMessageCode::InheritableKeyMaybeMissing:
+    case ArlMessageCode::ConditionalKeyMaybeMissing:
+    case ArlMessageCode::ArrayNotMultiple:
+        return ArlMessageType::Warning;
+
+    default:
+        return ArlMessageType::Error;
+    }
+}
+
+
+/// @brief Returns the name of a severity as used in JSON Lines reports and corpus statistics
+///
+/// @param[in] type   the severity
+///
+/// @returns "info", "warning" or "error"
+const char* get_message_type_name(const ArlMessageType type)
+{
+    static const char* names[] = { "info", "warning", "error" };
+    return names[(int)type];
+}
+
+
+/// @brief Counts a message in the findings of a PDF. The start and end of a report are not counted.
+/// Tabs and line breaks in keys (from PDF names) are replaced so findings can be written as TSV.
+///
+/// @param[in,out] findings  findings of a PDF, or nullptr if not needed
+/// @param[in]     code      the message code
+/// @param[in]     link      Arlington TSV object
+/// @param[in]     key       key, array index or PDF version
+void add_finding(arl_findings* findings, const ArlMessageCode code, const std::string& link, const std::string& key)
+{
+    if ((findings == nullptr) || (code == ArlMessageCode::Begin) || (code == ArlMessageCode::End))
+        return;
+    if (key.find_first_of("\t\r\n") == std::string::npos)
+        (*findings)[std::make_tuple((int)code, link, key)]++;
+    else {
+        std::string k = key;
+        for (auto& c : k)
+            if ((c == '\t') || (c == '\r') || (c == '\n'))
+                c = ' ';
+        (*findings)[std::make_tuple((int)code, link, k)]++;
+    }
+}
+
+
+/// @brief Converts findings to tab-separated lines of code, Arlington object, key and count
+///
+/// @param[in] findings  findings of a PDF
+///
+/// @returns the lines
+std::string findings_to_string(const arl_findings& findings)
+{
+    std::ostringstream  ss;
+    for (auto& f : findings)
+        ss << std::get<0>(f.first) << '\t' << std::get<1>(f.first) << '\t' << std::get<2>(f.first) << '\t' << f.second << '\n';
+    return ss.str();
+}
+
+
+/// @brief Adds findings from tab-separated lines created by findings_to_string()
+///
+/// @param[in]     s         the lines
+/// @param[in,out] findings  findings to add to
+///
+/// @returns true if all lines were valid
+bool findings_from_string(const std::string& s, arl_findings& findings)
+{
+    std::istringstream  in(s);
+    std::string         line;
+    while (std::getline(in, line)) {
+        auto t1 = line.find('\t');
+        auto t2 = (t1 == std::string::npos) ? t1 : line.find('\t', t1 + 1);
+        auto t3 = (t2 == std::string::npos) ? t2 : line.find('\t', t2 + 1);
+        if (t3 == std::string::npos)
+            return false;
+        try {
+            int          code = std::stoi(line.substr(0, t1));
+            unsigned int n = (unsigned int)std::stoul(line.substr(t3 + 1));
+            findings[std::make_tuple(code, line.substr(t1 + 1, t2 - t1 - 1), line.substr(t2 + 1, t3 - t2 - 1))] += n;
+        }
+        catch (...) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/// @brief Returns the length of the valid UTF-8 sequence at s[i], or 0 if it is not valid UTF-8
+/// (e.g. PDF names and strings that are not UTF-8). Overlong forms and surrogates are not valid.
+///
+/// @param[in] s   string
+/// @param[in] i   index of the lead byte in s
+///
+/// @returns 1 to 4, or 0
+static size_t utf8_sequence_length(const std::string& s, const size_t i)
+{
+    const unsigned char c = (unsigned char)s[i];
+    size_t        len;
+    unsigned char lo = 0x80;    // range of the 2nd byte
+    unsigned char hi = 0xBF;
+    if (c < 0x80)
+        return 1;
+    else if ((c >= 0xC2) && (c <= 0xDF))
+        len = 2;
+    else if ((c >= 0xE0) && (c <= 0xEF)) {
+        len = 3;
+        if (c == 0xE0)
+            lo = 0xA0;
+        else if (c == 0xED)
+            hi = 0x9F;
+    }
+    else if ((c >= 0xF0) && (c <= 0xF4)) {
+        len = 4;
+        if (c == 0xF0)
+            lo = 0x90;
+        else if (c == 0xF4)
+            hi = 0x8F;
+    }
+    else
+        return 0;
+    if (i + len > s.size())
+        return 0;
+    const unsigned char c2 = (unsigned char)s[i + 1];
+    if ((c2 < lo) || (c2 > hi))
+        return 0;
+    for (size_t j = 2; j < len; j++)
+        if (((unsigned char)s[i + j] & 0xC0) != 0x80)
+            return 0;
+    return len;
+}
+
+
+/// @brief Writes a JSON string value, escaping quotes, backslashes and control characters.
+/// Bytes that are not valid UTF-8 are written as U+FFFD so that every line is valid JSON.
+///
+/// @param[in] ofs   output stream
+/// @param[in] s     UTF-8 string
+static void write_json_string(std::ostream& ofs, const std::string& s)
+{
+    static const char hex[] = "0123456789abcdef";
+    ofs << '"';
+    for (size_t i = 0; i < s.size(); ) {
+        const char c = s[i];
+        switch (c) {
+        case '"':  ofs << "\\\""; break;
+        case '\\': ofs << "\\\\"; break;
+        case '\n': ofs << "\\n"; break;
+        case '\r': ofs << "\\r"; break;
+        case '\t': ofs << "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20)
+                ofs << "\\u00" << hex[(c >> 4) & 0xF] << hex[c & 0xF];
+            else if ((unsigned char)c >= 0x80) {
+                size_t len = utf8_sequence_length(s, i);
+                if (len == 0)
+                    ofs << "\\ufffd";
+                else
+                    ofs.write(s.data() + i, (std::streamsize)len);
+                i += ((len == 0) ? 1 : len);
+                continue;
+            }
+            else
+                ofs << c;
+            break;
+        }
+        i++;
+    }
+    ofs << '"';
+}
+
+
+/// @brief Writes a message as a single line JSON object. Empty fields are not written.
+///
+/// @param[in] ofs          output stream
+/// @param[in] code         the message code
+/// @param[in] link         Arlington TSV object (e.g. "Catalog")
+/// @param[in] key          key or array index
+/// @param[in] object       PDF object of the message for its object and generation numbers, or nullptr
+/// @param[in] pdf_version  PDF version the PDF is compared to (multiplied by 10), or 0 if not yet known
+/// @param[in] context      PDF DOM path of the object
+/// @param[in] value        additional data of the message (e.g. an invalid value)
+void write_jsonl_message(std::ostream& ofs, const ArlMessageCode code, const std::string& link, const std::string& key,
+    ArlPDFObject* object, const int pdf_version, const std::string& context, const std::string& value)
+{
+    ofs << "{\"code\":" << (int)code << ",\"severity\":\"" << get_message_type_name(get_message_type(code)) << '"';
+    if (!link.empty()) {
+        ofs << ",\"object\":";
+        write_json_string(ofs, link);
+    }
+    if (!key.empty()) {
+        ofs << ",\"key\":";
+        write_json_string(ofs, key);
+    }
+    if ((object != nullptr) && (object->get_object_number() > 0))
+        ofs << ",\"obj\":" << object->get_object_number() << ",\"gen\":" << object->get_generation_number();
+    if (pdf_version > 0)
+        ofs << ",\"pdf\":\"" << (pdf_version / 10) << '.' << (pdf_version % 10) << '"';
+    if (!context.empty()) {
+        ofs << ",\"context\":";
+        write_json_string(ofs, context);
+    }
+    if (!value.empty()) {
+        ofs << ",\"value\":";
+        write_json_string(ofs, value);
+    }
+    ofs << "}\n";
+}
+
+
+/// @brief Records a message. Begin and End are not messages. For text reports the text that is
+/// written next, up to the end of the line, is kept as the text of the message.
+///
+/// @param[in] code      the message code
+/// @param[in] link      Arlington TSV object
+/// @param[in] key       key, array index or PDF version
+/// @param[in] object    PDF object of the message for its object and generation numbers, or nullptr
+/// @param[in] context   PDF DOM path of the object
+/// @param[in] value     additional data of the message
+/// @param[in] format    format of the report
+void CArlMessageLog::add(const ArlMessageCode code, const std::string& link, const std::string& key, ArlPDFObject* object,
+    const std::string& context, const std::string& value, const ReportFormat format)
+{
+    if ((code == ArlMessageCode::Begin) || (code == ArlMessageCode::End))
+        return;
+    int obj_nbr = 0;
+    int gen_nbr = 0;
+    if ((object != nullptr) && (object->get_object_number() > 0)) {
+        obj_nbr = object->get_object_number();
+        gen_nbr = object->get_generation_number();
+    }
+    messages.push_back({ code, get_message_type(code), link, key, obj_nbr, gen_nbr, context, value, "" });
+    capturing = (format == ReportFormat::Text);
+}
+
+
+/// @brief Keeps a character of the text of the last message. At the end of the line the colors and
+/// the "Error: " (etc.) prefix are removed.
+///
+/// @param[in,out] msg        the last message
+/// @param[in,out] capturing  set to false at the end of the line
+/// @param[in]     c          the character
+static void capture_char(arl_message& msg, bool& capturing, const char c)
+{
+    if (c != '\n') {
+        msg.text += c;
+        return;
+    }
+    capturing = false;
+    std::string& t = msg.text;
+    std::string::size_type esc;
+    while ((esc = t.find('\033')) != std::string::npos) {
+        std::string::size_type m = t.find('m', esc);
+        t.erase(esc, (m == std::string::npos) ? std::string::npos : (m - esc + 1));
+    }
+    static const char* prefixes[] = { "Info: ", "Warning: ", "Error: " };
+    const std::string prefix = prefixes[(int)msg.type];
+    if (t.rfind(prefix, 0) == 0)
+        t.erase(0, prefix.size());
+}
+
+
+/// @brief Writes a character of the report
+CArlMessageLog::int_type CArlMessageLog::overflow(int_type c)
+{
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+        return traits_type::not_eof(c);
+    if (capturing)
+        capture_char(messages.back(), capturing, traits_type::to_char_type(c));
+    return (dest == nullptr) ? c : dest->sputc(traits_type::to_char_type(c));
+}
+
+
+/// @brief Writes characters of the report
+std::streamsize CArlMessageLog::xsputn(const char* s, std::streamsize n)
+{
+    for (std::streamsize i = 0; capturing && (i < n); i++)
+        capture_char(messages.back(), capturing, s[i]);
+    return (dest == nullptr) ? n : dest->sputn(s, n);
+}
+
+
+/// @brief Flushes the destination of the report
+int CArlMessageLog::sync()
+{
+    return (dest == nullptr) ? 0 : dest->pubsync();
+}
@@ -0,0 +1,247 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Report formats and the stable codes of report messages
+///
+/// Text reports are for people. JSON Lines reports (--format jsonl) have one
+/// compact JSON object per message so they can be post-processed without
+/// parsing the text. Message codes are stable: a code is never renumbered or
+/// reused for a different message, and new messages get new codes.
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ArlMessages_h
+#define ArlMessages_h
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <streambuf>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "ArlingtonPDFShim.h"
+
+using namespace ArlingtonPDFShim;
+
+
+/// @brief Format of a report
+enum class ReportFormat {
+    Text,       // human-readable text, optionally colorized
+    JSONL       // JSON Lines: one JSON object per message
+};
+
+
+/// @brief Severity of a message in a report
+enum class ArlMessageType {
+    Info,
+    Warning,
+    Error
+};
+
+
+/// @brief Stable message codes. The comment is the start of the equivalent text message.
+enum class ArlMessageCode : int {
+    // Whole report
+    Begin                       = 1,    // BEGIN - TestGrammar
+    End                         = 2,    // END
+    Exception                   = 3,    // EXCEPTION:
+    OpenFailed                  = 4,    // failed to open PDF
+    NoTrailer                   = 5,    // failed to acquire Trailer
+    XRefStream                  = 6,    // XRefStream detected.
+    TraditionalTrailer          = 7,    // Traditional trailer dictionary detected.
+    UnsupportedEncryption       = 8,    // Unsupported encryption
+    Encrypted                   = 9,    // Encrypted PDF
+    LatestFeature               = 10,   // Latest Arlington object was
+    WorkerFailed                = 11,   // --isolate worker process failure
+    Suppressed                  = 12,   // more messages ... suppressed (--max-repeats). value is "<code>:<number suppressed>"
+
+    // PDF version
+    HeaderVersion               = 100,  // Header is version PDF
+    BadHeaderVersion            = 101,  // Bad header is version PDF
+    CatalogVersion              = 102,  // Document Catalog/Version is PDF
+    BadCatalogVersion           = 103,  // Bad Document Catalog/Version is PDF
+    CatalogMajorVersionEarlier  = 104,  // Document Catalog major version is earlier than PDF header version!
+    CatalogMinorVersionEarlier  = 105,  // Document Catalog minor version is earlier than PDF header version!
+    NoValidVersion              = 106,  // Both Document Catalog and header versions are invalid or missing.
+    XRefStreamTooEarly          = 107,  // XRefStream is present in PDF x before introduction in PDF 1.5.
+    XRefStreamOldHeader         = 108,  // XRefStream is present in file with header
+    RoundedUpVersion            = 109,  // Rounding up PDF x to PDF 1.7
+    ForcedVersion               = 110,  // Command line forced to PDF
+    ProcessingAsVersion         = 111,  // Processing as PDF
+
+    // PDF objects
+    NoLink                      = 200,  // can't select any Link to validate PDF object
+    InheritanceTooDeep          = 201,  // recursive inheritance depth of
+    TwoContexts                 = 202,  // object identified in two different contexts.
+    NoGrammar                   = 203,  // could not open
+    IllegalObjectNumber         = 204,  // object number x is illegal.
+    DuplicateKey                = 205,  // Duplicate dictionary key:
+    UnexpectedObjectType        = 206,  // unexpected object type
+    BudgetExceeded              = 207,  // budget exceeded (--max-objects / --max-seconds, which is the key)
+    DepthBudgetExceeded         = 208,  // budget exceeded (--max-depth)
+
+    // Values of keys and array elements
+    WrongType                   = 300,  // wrong type:
+    NotIndirect                 = 301,  // not an indirect reference as required:
+    BitmaskNot32Bit             = 302,  // bitmask was not a 32-bit value
+    IntegerOutOfRange           = 303,  // integer value exceeds PDF 1.x integer range
+    BitmaskNotInteger           = 304,  // bitmask was not an integer value
+    NameTooLong                 = 305,  // PDF 1.x names were limited to 127 bytes
+    StringUTF16LE               = 306,  // string ... starts with UTF-16LE byte order marker
+    StringUnprintable           = 307,  // ASCII string contained at least one unprintable byte
+    InvalidDate                 = 308,  // invalid date string
+    PossiblyInvalidDate         = 309,  // possibly invalid date string
+    RectangleLength             = 310,  // rectangle does not have exactly 4 elements
+    RectangleNotNumeric         = 311,  // rectangle does not have 4 numeric elements
+    MatrixLength                = 312,  // matrix does not have exactly 6 elements
+    MatrixNotNumeric            = 313,  // matrix does not have 6 numeric elements
+    SpecialCaseWrong            = 314,  // special case not correct:
+    SpecialCasePossiblyWrong    = 315,  // special case possibly incorrect (some predicates NOT supported):
+    WrongValue                  = 316,  // wrong value for possible values:
+    PossiblyWrongValue          = 317,  // possibly wrong value for possible values (some predicates NOT supported):
+
+    // Dictionaries and arrays
+    NumberTreeNotDictionary     = 400,  // number-tree was not a dictionary
+    NameTreeNotDictionary       = 401,  // name-tree was not a dictionary
+    FeatureAfterObsolescence    = 402,  // detected a ... version-based feature after obsolescence
+    FeatureBeforeIntroduction   = 403,  // detected a ... version-based feature before official introduction
+    FeatureDeprecated           = 404,  // detected a ... version-based feature that was deprecated
+    FeatureOnlyInVersion        = 405,  // detected a ... version-based feature that was only in
+    MetadataKey                 = 406,  // found a PDF 1.4 Metadata key
+    AssociatedFilesKey          = 407,  // found a PDF 2.0 Associated File AF key
+    WildcardWrongType           = 408,  // wrong type for dictionary wildcard
+    SecondClassKey              = 409,  // second class key ... is not defined in Arlington
+    ThirdClassKey               = 410,  // third class key ... found
+    UnknownKey                  = 411,  // unknown key ... is not defined in Arlington
+    NoKeyValue                  = 412,  // could not get value for key
+    RequiredKeyMissing          = 413,  // non-inheritable required key does not exist:
+    RequiredKeyMaybeMissing     = 414,  // non-inheritable required key may not exist:
+    InheritableKeyMissing       = 415,  // inheritable required key does not exist:
+    InheritableKeyMaybeMissing  = 416,  // inheritable required key may not exist:
+    ConditionalKeyMaybeMissing  = 417,  // required key may not exist:
+    ArrayAsDictionary           = 418,  // PDF array object encountered, but using Arlington dictionary
+    ArrayMinimumLength          = 419,  // minimum required array length incorrect
+    ArrayTooShort               = 420,  // array length was too short
+    ArrayNotMultiple            = 421,  // array length was not an exact multiple of
+    ArrayTooLong                = 422,  // array was longer than needed
+
+    // Name trees and number trees
+    NameTreeMissingValue        = 500,  // name tree Names array element ... missing 2nd element in a pair
+    NameTreeNullKey             = 501,  // name tree Names array element ... 1st element in a pair returned null
+    NameTreeKeyNotString        = 502,  // name tree Names array element ... 1st element in a pair was not a string
+    NameTreeNoNames             = 503,  // name tree Names object was missing when Kids was also missing
+    NameTreeNamesNotArray       = 504,  // name tree Names object was not an array when Kids was also missing
+    NameTreeKidNotDictionary    = 505,  // name tree Kids array element ... was not a dictionary
+    NameTreeKidsNotArray        = 506,  // name tree Kids object was not an array
+    NumberTreeNullValue         = 510,  // number tree Nums array element ... was null
+    NumberTreeKeyNotInteger     = 511,  // number tree Nums array element ... was not an integer
+    NumberTreeNumsInvalid       = 512,  // number tree Nums array was invalid
+    NumberTreeNumsNotArray      = 513,  // number tree Nums object was not an array
+    NumberTreeNoNums            = 514,  // number tree Nums object was missing when Kids was also missing
+    NumberTreeKidNotDictionary  = 515,  // number tree Kids array element ... was not a dictionary
+    NumberTreeKidsNotArray      = 516   // number tree Kids object was not an array
+};
+
+
+/// @brief Findings of a single PDF for corpus statistics (--stats): the number of messages for each
+/// message code, Arlington object and key. For PDF version messages the key is the version.
+typedef std::map<std::tuple<int, std::string, std::string>, unsigned int> arl_findings;
+
+
+/// @brief Returns the severity of a message
+ArlMessageType get_message_type(const ArlMessageCode code);
+
+/// @brief Returns the name of a severity ("info", "warning" or "error")
+const char* get_message_type_name(const ArlMessageType type);
+
+/// @brief Counts a message in the findings of a PDF. Does nothing if findings is nullptr.
+void add_finding(arl_findings* findings, const ArlMessageCode code, const std::string& link, const std::string& key);
+
+/// @brief Converts findings to tab-separated lines (code, object, key, count)
+std::string findings_to_string(const arl_findings& findings);
+
+/// @brief Adds findings from tab-separated lines created by findings_to_string()
+bool findings_from_string(const std::string& s, arl_findings& findings);
+
+/// @brief Writes a message to a JSON Lines report
+void write_jsonl_message(std::ostream& ofs, const ArlMessageCode code, const std::string& link, const std::string& key,
+    ArlPDFObject* object, const int pdf_version, const std::string& context, const std::string& value = "");
+
+
+
+/// @brief A single message of a report, as recorded by CArlMessageLog
+struct arl_message {
+    ArlMessageCode  code;
+    ArlMessageType  type;
+    std::string     link;       // Arlington TSV object (empty for messages about the whole PDF)
+    std::string     key;        // key or array index, or the PDF version of version messages
+    int             obj_nbr;    // PDF object number (0 for direct objects or messages about the whole PDF)
+    int             gen_nbr;    // PDF generation number
+    std::string     context;    // PDF DOM path of the object being checked (empty for messages about the whole PDF)
+    std::string     value;      // additional data of the message, as in JSON Lines reports
+    std::string     text;       // text report only: the message without the "Error: " (etc.) prefix or colors
+};
+
+
+/// @class CArlMessageLog
+/// Records each message as it is reported. The report is written through this stream buffer to
+/// the destination stream buffer (if any), so that the text of each message can be kept as well.
+class CArlMessageLog : public std::streambuf {
+    /// @brief the stream buffer the report is written to, or nullptr
+    std::streambuf*             dest;
+
+    /// @brief messages in report order
+    std::vector<arl_message>    messages;
+
+    /// @brief true while the text of the last message is written
+    bool                        capturing;
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+public:
+    explicit CArlMessageLog(std::streambuf* d)
+        : dest(d), capturing(false)
+        { /* constructor */ }
+
+    /// @brief Records a message. For text reports the caller then writes its text.
+    void add(const ArlMessageCode code, const std::string& link, const std::string& key, ArlPDFObject* object,
+        const std::string& context, const std::string& value, const ReportFormat format);
+
+    /// @brief Returns the messages, in report order
+    std::vector<arl_message>& get_messages() { return messages; }
+};
+
+
+/// @brief For text reports returns true so that the caller outputs the text of a message about the whole PDF.
+/// For JSON Lines reports writes the message and returns false. PDF versions are kept in the findings.
+inline bool report_message(std::ostream& ofs, const ReportFormat format, arl_findings* findings, const ArlMessageCode code, const std::string& value = "", CArlMessageLog* log = nullptr)
+{
+    bool is_version = ((int)code >= (int)ArlMessageCode::HeaderVersion) && ((int)code <= (int)ArlMessageCode::ProcessingAsVersion);
+    add_finding(findings, code, "", (is_version ? value : ""));
+    if (log != nullptr)
+        log->add(code, "", (is_version ? value : ""), nullptr, "", value, format);
+    if (format == ReportFormat::Text)
+        return true;
+    write_jsonl_message(ofs, code, "", "", nullptr, 0, "", value);
+    return false;
+}
+
+#endif // ArlMessages_h
@@ -24,6 +24,9 @@
 
 #include <iostream>
 #include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <cassert>
@@ -88,6 +91,9 @@ namespace ArlingtonPDFShim {
         /// @brief pointer to PDF SDK dependent data object
         void*           object;
 
+        /// @brief PDF SDK context (ArlingtonPDFSDK::ctx) of the document this object belongs to
+        void*           sdk_ctx;
+
         /// @brief PDF bject number from underlying PDF SDK. Or parent if negative.
         int             obj_nbr;
 
@@ -103,12 +109,15 @@ namespace ArlingtonPDFShim {
         /// @brief Sort all dictionary keys so guaranteed same order across PDF SDKs
         std::vector<std::wstring>   sorted_keys;
 
+        /// @brief Backing store for get_raw_bytes() for PDF SDKs that cannot expose their own buffers
+        std::string                 raw_bytes;
+
         /// @brief Checks if keys are sorted and, if not, then sorts
         virtual void sort_keys();
 
     public:
         ArlPDFObject(const bool can_delete = true) :
-            object(nullptr), obj_nbr(0), gen_nbr(0), type(PDFObjectType::ArlPDFObjTypeUnknown), is_indirect(false), deleteable(can_delete)
+            object(nullptr), sdk_ctx(nullptr), obj_nbr(0), gen_nbr(0), type(PDFObjectType::ArlPDFObjTypeUnknown), is_indirect(false), deleteable(can_delete)
             { /* default constructor */ };
 
         explicit ArlPDFObject(ArlPDFObject* parent, void* obj, const bool can_delete = true);
@@ -176,6 +185,10 @@ namespace ArlingtonPDFShim {
         ArlPDFString(ArlPDFObject* parent, void* obj) : ArlPDFObject(parent, obj)
             { /* constructor */ type = PDFObjectType::ArlPDFObjTypeString; };
 
+        /// @brief Raw bytes of the string (no decoding). Only valid while this object exists.
+        std::string_view get_raw_bytes();
+
+        /// @brief Decoded string value. Only use when text semantics are needed.
         std::wstring get_value();
         bool is_hex_string();
 
@@ -192,6 +205,10 @@ namespace ArlingtonPDFShim {
         ArlPDFName(ArlPDFObject* parent, void* obj) : ArlPDFObject(parent, obj)
             { /* constructor */ type = PDFObjectType::ArlPDFObjTypeString; };
 
+        /// @brief Raw bytes of the name (#-escapes resolved, no decoding). Only valid while this object exists.
+        std::string_view get_raw_bytes();
+
+        /// @brief Decoded (UTF-8) name value. Only use when text semantics are needed.
         std::wstring get_value();
 
         friend std::ostream& operator << (std::ostream& ofs, const ArlPDFName& obj) {
@@ -282,9 +299,9 @@ namespace ArlingtonPDFShim {
         const bool            has_unsupported_encryption;
 
     public:
-        ArlPDFTrailer(void* obj, const bool has_xref, const bool encrypted, const bool unsupport_enc) : ArlPDFDictionary(nullptr, obj, false),
+        ArlPDFTrailer(void* ctx, void* obj, const bool has_xref, const bool encrypted, const bool unsupport_enc) : ArlPDFDictionary(nullptr, obj, false),
             has_xrefstm(has_xref), has_encryption(encrypted), has_unsupported_encryption(unsupport_enc)
-            { /* constructor */ };
+            { /* constructor */ sdk_ctx = ctx; };
 
         ~ArlPDFTrailer() 
             { /* destructor */ };
@@ -301,16 +318,26 @@ namespace ArlingtonPDFShim {
 
 
 
+    /// @brief Reads size bytes at offset from a PDF that is not a file (memory buffer, network stream, etc.).
+    /// Returns false if the bytes could not be read.
+    typedef std::function<bool(const size_t offset, void* buffer, const size_t size)> pdf_read_fn;
+
+
+
     /// @class ArlingtonPDFSDK
     /// Arlington PDF SDK
     class ArlingtonPDFSDK {
     public:
-        /// @brief Untyped PDF SDK context object. Needs casting appropriately
-        static void* ctx;
+        /// @brief Untyped PDF SDK context object for this instance. Needs casting appropriately.
+        /// Each instance can have its own PDF open and be used on its own thread.
+        void* ctx;
 
         /// @brief PDF SDK constructor
         explicit ArlingtonPDFSDK()
-            { /* constructor */ ctx = nullptr; };
+            : ctx(nullptr) { /* constructor */ };
+
+        ArlingtonPDFSDK(const ArlingtonPDFSDK&) = delete;
+        ArlingtonPDFSDK& operator=(const ArlingtonPDFSDK&) = delete;
 
         /// @brief Initialize the PDF SDK. Can throw exceptions on error.
         void initialize();
@@ -324,6 +351,10 @@ namespace ArlingtonPDFShim {
         /// @brief Open a PDF file (optional password) 
         bool open_pdf(const std::filesystem::path& pdf_filename, const std::wstring& password);
 
+        /// @brief Open a PDF of file_size bytes that is read via a callback (optional password).
+        /// The callback must remain valid until close_pdf().
+        bool open_pdf(pdf_read_fn reader, const size_t file_size, const std::wstring& password);
+
         /// @brief Close a previously opened PDF and free all memory and resources
         void close_pdf();
 
@@ -341,6 +372,16 @@ namespace ArlingtonPDFShim {
 
         /// @brief Get number of pages (>= 0) in the already opened PDF. -1 on error.
         int get_pdf_page_count();
+
+        /// @brief Hint that an indirect object (and its direct children) is no longer referenced by any wrapper
+        void release_object(const int obj_nbr);
+
+        /// @brief true if release_object() frees memory. Released objects are read again with get_indirect_object().
+        bool can_release_objects();
+
+        /// @brief Returns a new object for an indirect object as if reached via an indirect reference.
+        /// nullptr if there is no such object or if the PDF SDK cannot release objects.
+        ArlPDFObject* get_indirect_object(const int obj_nbr);
     };
 
 }; // namespace
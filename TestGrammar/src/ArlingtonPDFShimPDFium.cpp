@@ -29,6 +29,8 @@
 #include <algorithm>
 #include <string>
 #include <cassert>
+#include <mutex>
+#include <unordered_set>
 #include "utils.h"
 
 // pdfium
@@ -39,27 +41,34 @@
 
 using namespace ArlingtonPDFShim;
 
-void* ArlingtonPDFSDK::ctx = nullptr;
+/// @brief pdfium module managers are process-wide so are shared by all ArlingtonPDFSDK instances
+static std::mutex           pdfium_module_mutex;
+static int                  pdfium_module_refs = 0;
+static CCodec_ModuleMgr*    pdfium_codec_module = nullptr;
 
 struct pdfium_context {
     CPDF_Parser*        parser;
-    CPDF_ModuleMgr*     moduleMgr;
-    CCodec_ModuleMgr*   codecModule;
     FX_DWORD            open_err_code;
 
     ArlPDFTrailer*      pdf_trailer;
     ArlPDFDictionary*   pdf_catalog;
 
+    /// @brief Indirect objects parsed while opening the PDF. pdfium can change these (e.g. a wrong /Count
+    ///        of the page tree root) so they are never released and parsed again.
+    std::unordered_set<FX_DWORD>    loaded_on_open;
+
     pdfium_context() {
         /* Default constructor */
         open_err_code = PDFPARSE_ERROR_SUCCESS;
         pdf_trailer = nullptr;
         pdf_catalog = nullptr;
         parser = nullptr;
-        CPDF_ModuleMgr::Create();
-        codecModule = CCodec_ModuleMgr::Create();
-        moduleMgr = CPDF_ModuleMgr::Get();
-        moduleMgr->SetCodecModule(codecModule);
+        std::lock_guard<std::mutex> lock(pdfium_module_mutex);
+        if ((pdfium_module_refs++ == 0) && (CPDF_ModuleMgr::Get() == nullptr)) {
+            CPDF_ModuleMgr::Create();
+            pdfium_codec_module = CCodec_ModuleMgr::Create();
+            CPDF_ModuleMgr::Get()->SetCodecModule(pdfium_codec_module);
+        }
         // moduleMgr->InitPageModule();
         // moduleMgr->InitRenderModule();
         // moduleMgr->LoadEmbeddedGB1CMaps();
@@ -77,11 +86,16 @@ struct pdfium_context {
             parser->CloseParser();
             delete(parser);
         }
-        if (codecModule != nullptr)
-            codecModule->Destroy();
-        if (moduleMgr != nullptr)
-            moduleMgr->Destroy();
 #endif
+        std::lock_guard<std::mutex> lock(pdfium_module_mutex);
+        if (--pdfium_module_refs == 0) {
+#if !defined(__linux__) && !defined(DEBUG)
+            if (pdfium_codec_module != nullptr)
+                pdfium_codec_module->Destroy();
+            pdfium_codec_module = nullptr;
+            CPDF_ModuleMgr::Destroy();
+#endif
+        }
     };
 };
 
@@ -117,29 +131,58 @@ std::string ArlingtonPDFSDK::get_version_string()
 }
 
 
-/// @brief   Opens a PDF file (optional password) 
+/// @class CArlFileReadCallback
+/// pdfium file access for a PDF that is read via an Arlington pdf_read_fn callback.
+/// Owned (and released) by the pdfium parser.
+class CArlFileReadCallback : public IFX_FileRead {
+    pdf_read_fn     reader;
+    FX_FILESIZE     file_size;
+
+public:
+    CArlFileReadCallback(pdf_read_fn rdr, const size_t sz)
+        : reader(rdr), file_size((FX_FILESIZE)sz)
+        { /* constructor */ }
+
+    virtual void Release() override { delete this; }
+
+    virtual FX_FILESIZE GetSize() override { return file_size; }
+
+    virtual FX_BOOL ReadBlock(void* buffer, FX_FILESIZE offset, size_t size) override {
+        if ((offset < 0) || (offset > file_size) || ((FX_FILESIZE)size > file_size - offset))
+            return FALSE;
+        return reader((size_t)offset, buffer, size) ? TRUE : FALSE;
+    }
+};
+
+
+
+/// @brief   Creates a new pdfium parser for this instance, closing any previously opened document
 ///
-/// @param[in]   pdf_filename PDF filename
+/// @param[in]   pdfium_ctx   pdfium context
 /// @param[in]   password     optional password
-///
-/// @returns  true if PDF file was opened successfully. false othewise.
-bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const std::wstring &password)
+static void new_parser(pdfium_context* pdfium_ctx, const std::wstring& password)
 {
-    assert(ctx != nullptr);
-    assert(!pdf_filename.empty());
-    auto pdfium_ctx = (pdfium_context*)ctx;
-
-    // close any previously opened document
     if (pdfium_ctx->parser != nullptr) {
         pdfium_ctx->parser->CloseParser();
         delete pdfium_ctx->parser;
     }
     pdfium_ctx->parser = new CPDF_Parser;
+    pdfium_ctx->loaded_on_open.clear();
 
     if (password.size() > 0)
         pdfium_ctx->parser->SetPassword(ToUtf8(password).c_str());
+}
 
-    pdfium_ctx->open_err_code = pdfium_ctx->parser->StartParse((FX_LPCSTR)pdf_filename.string().c_str());
+
+
+/// @brief   Sets up the trailer and document catalog after pdfium has parsed a PDF
+///
+/// @param[in]   ctx   PDF SDK context
+///
+/// @returns  true if PDF file was opened successfully. false othewise.
+static bool finish_open(void* ctx)
+{
+    auto pdfium_ctx = (pdfium_context*)ctx;
     if ((pdfium_ctx->open_err_code != PDFPARSE_ERROR_SUCCESS) && (pdfium_ctx->open_err_code != PDFPARSE_ERROR_PASSWORD) && (pdfium_ctx->open_err_code != PDFPARSE_ERROR_HANDLER)) {
         delete pdfium_ctx->parser;
         pdfium_ctx->parser = nullptr;
@@ -151,7 +194,7 @@ bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const
     assert(trailr != NULL);
     if (trailr != NULL) {
         assert(trailr->GetType() == PDFOBJ_DICTIONARY);
-        pdfium_ctx->pdf_trailer = new ArlPDFTrailer(trailr,
+        pdfium_ctx->pdf_trailer = new ArlPDFTrailer(ctx, trailr,
                                         pdfium_ctx->parser->IsXRefStream(),
                                         pdfium_ctx->parser->IsEncrypted(),
                                         (pdfium_ctx->open_err_code == PDFPARSE_ERROR_PASSWORD) || (pdfium_ctx->open_err_code == PDFPARSE_ERROR_HANDLER)
@@ -177,6 +220,17 @@ bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const
         auto dc_dict = trailr->GetDict("Root");
         if (dc_dict != nullptr) {
             pdfium_ctx->pdf_catalog = new ArlPDFDictionary(pdfium_ctx->pdf_trailer, dc_dict, false);
+            CPDF_Document* doc = pdfium_ctx->parser->GetDocument();
+            if (doc != nullptr) {
+                FX_POSITION pos = doc->GetStartPosition();
+                while (pos) {
+                    // pdfium writes a whole pointer through the object number reference
+                    uintptr_t    objnum = 0;
+                    CPDF_Object* obj;
+                    doc->GetNextAssoc(pos, *(FX_DWORD*)&objnum, obj);
+                    pdfium_ctx->loaded_on_open.insert((FX_DWORD)objnum);
+                }
+            }
             return true;
         }
     }
@@ -186,6 +240,45 @@ bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const
 
 
 
+/// @brief   Opens a PDF file (optional password) 
+///
+/// @param[in]   pdf_filename PDF filename
+/// @param[in]   password     optional password
+///
+/// @returns  true if PDF file was opened successfully. false othewise.
+bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const std::wstring &password)
+{
+    assert(ctx != nullptr);
+    assert(!pdf_filename.empty());
+    auto pdfium_ctx = (pdfium_context*)ctx;
+
+    new_parser(pdfium_ctx, password);
+    pdfium_ctx->open_err_code = pdfium_ctx->parser->StartParse((FX_LPCSTR)pdf_filename.string().c_str());
+    return finish_open(ctx);
+}
+
+
+
+/// @brief   Opens a PDF that is read via a callback (optional password) 
+///
+/// @param[in]   reader       callback to read the PDF. Must remain valid until close_pdf().
+/// @param[in]   file_size    size of the PDF in bytes
+/// @param[in]   password     optional password
+///
+/// @returns  true if PDF was opened successfully. false othewise.
+bool ArlingtonPDFSDK::open_pdf(pdf_read_fn reader, const size_t file_size, const std::wstring& password)
+{
+    assert(ctx != nullptr);
+    assert(reader);
+    auto pdfium_ctx = (pdfium_context*)ctx;
+
+    new_parser(pdfium_ctx, password);
+    pdfium_ctx->open_err_code = pdfium_ctx->parser->StartParse(new CArlFileReadCallback(reader, file_size), FALSE, TRUE);
+    return finish_open(ctx);
+}
+
+
+
 /// @brief Close a previously opened PDF file. Frees all memory for a file so multiple PDFs don't accumulate leaked memory.
 void ArlingtonPDFSDK::close_pdf() {
     assert(ctx != nullptr);
@@ -280,7 +373,71 @@ int ArlingtonPDFSDK::get_pdf_page_count() {
 }
 
 
-CPDF_Object* pdfium_resolve_indirect(const CPDF_Object* pdfium_obj) {
+/// @brief  Releases a parsed indirect object so pdfium does not hold the whole PDF in memory.
+/// pdfium will re-parse the object from the file if it is requested again.
+/// Objects that pdfium itself keeps pointers to or parsed while opening the PDF are never released.
+///
+/// @param[in] obj_nbr   object number. No ArlPDFObject can still reference this object or its children!
+void ArlingtonPDFSDK::release_object(const int obj_nbr) {
+    assert(ctx != nullptr);
+    auto pdfium_ctx = (pdfium_context*)ctx;
+    if ((obj_nbr <= 0) || (pdfium_ctx->parser == nullptr))
+        return;
+
+    CPDF_Parser* parser = pdfium_ctx->parser;
+    CPDF_Document* doc = parser->GetDocument();
+    if (doc == nullptr)
+        return;
+    if ((obj_nbr == (int)parser->GetRootObjNum()) || (obj_nbr == (int)parser->GetInfoObjNum()))
+        return;
+    if ((parser->GetEncryptDict() != nullptr) && (obj_nbr == (int)parser->GetEncryptDict()->GetObjNum()))
+        return;
+    if (pdfium_ctx->loaded_on_open.find(obj_nbr) != pdfium_ctx->loaded_on_open.end())
+        return;
+
+    // Already loaded so this will not re-parse
+    CPDF_Object* obj = doc->GetIndirectObject(obj_nbr);
+    if (obj == nullptr)
+        return;
+    if ((obj->GetType() == PDFOBJ_STREAM) && (((CPDF_Stream*)obj)->GetDict() != nullptr)) {
+        // parser caches object streams and cross-reference streams by pointer
+        CFX_ByteString t = ((CPDF_Stream*)obj)->GetDict()->GetString("Type");
+        if ((t == "ObjStm") || (t == "XRef"))
+            return;
+    }
+    doc->ReleaseIndirectObject(obj_nbr);
+}
+
+
+/// @brief pdfium releases parsed indirect objects (see release_object())
+///
+/// @returns true
+bool ArlingtonPDFSDK::can_release_objects() {
+    return true;
+}
+
+
+/// @brief Returns a new object for an indirect object, re-parsing it if it was released.
+///
+/// @param[in] obj_nbr   object number (> 0)
+///
+/// @returns the object as if reached via an indirect reference (is_indirect_ref() is true) or nullptr on error
+ArlPDFObject* ArlingtonPDFSDK::get_indirect_object(const int obj_nbr) {
+    assert(ctx != nullptr);
+    auto pdfium_ctx = (pdfium_context*)ctx;
+    if ((obj_nbr <= 0) || (pdfium_ctx->parser == nullptr) || (pdfium_ctx->parser->GetDocument() == nullptr))
+        return nullptr;
+
+    // A temporary indirect reference is resolved the same way as one from a dictionary or array
+    CPDF_Reference* ref = CPDF_Reference::Create(pdfium_ctx->parser->GetDocument(), obj_nbr);
+    ArlPDFObject* retval = new ArlPDFObject(pdfium_ctx->pdf_trailer, ref);
+    ref->Release();
+    return retval;
+}
+
+
+CPDF_Object* pdfium_resolve_indirect(void* ctx, const CPDF_Object* pdfium_obj) {
+    assert(ctx != nullptr);
     assert(pdfium_obj != nullptr);
     FX_DWORD     obj_num;
     CPDF_Object* pdf_ir;
@@ -289,7 +446,7 @@ CPDF_Object* pdfium_resolve_indirect(const CPDF_Object* pdfium_obj) {
     do {
         assert(pdfium_obj->GetType() == PDFOBJ_REFERENCE);
         obj_num = ((CPDF_Reference*)pdfium_obj)->GetRefObjNum();
-        pdf_ir = ((pdfium_context*)ArlingtonPDFSDK::ctx)->parser->GetDocument()->GetIndirectObject(obj_num);
+        pdf_ir = ((pdfium_context*)ctx)->parser->GetDocument()->GetIndirectObject(obj_num);
     } while ((pdf_ir != nullptr) && (pdf_ir->GetType() == PDFOBJ_REFERENCE) && (--i > 0));
     if (i > 0)
         return pdf_ir;
@@ -300,10 +457,11 @@ CPDF_Object* pdfium_resolve_indirect(const CPDF_Object* pdfium_obj) {
 
 /// @brief  Returns the PDF object type of an object
 ///
+/// @param[in]      ctx          the pdfium_context of the PDF file that pdfium_obj belongs to
 /// @param[in,out]  pdfium_obj   the pdfium indirect object which will get updated once it is resolved
 ///
 /// @return PDFObjectType enum value for the resolved object
-PDFObjectType determine_object_type(CPDF_Object* pdfium_obj)
+PDFObjectType determine_object_type(void* ctx, CPDF_Object* pdfium_obj)
 {
     if (pdfium_obj == nullptr)
         return PDFObjectType::ArlPDFObjTypeNull;
@@ -338,11 +496,11 @@ PDFObjectType determine_object_type(CPDF_Object* pdfium_obj)
         break;
     case PDFOBJ_REFERENCE:
         {
-            pdfium_obj = pdfium_resolve_indirect(pdfium_obj);
+            pdfium_obj = pdfium_resolve_indirect(ctx, pdfium_obj);
             if (pdfium_obj == nullptr)
                 retval = PDFObjectType::ArlPDFObjTypeNull;
             else
-                retval = determine_object_type(pdfium_obj);
+                retval = determine_object_type(ctx, pdfium_obj);
         }
         break;
     case PDFOBJ_INVALID: /* fallthrough */
@@ -357,7 +515,7 @@ PDFObjectType determine_object_type(CPDF_Object* pdfium_obj)
 
 /// @brief Constructor taking a parent PDF object and a PDF SDK generic pointer of an object
 ArlPDFObject::ArlPDFObject(ArlPDFObject *parent, void* obj, const bool can_delete) :
-    object(obj), deleteable(can_delete)
+    object(obj), sdk_ctx((parent != nullptr) ? parent->sdk_ctx : nullptr), deleteable(can_delete)
 {
     assert(object != nullptr);
     CPDF_Object* pdf_obj = (CPDF_Object*)obj;
@@ -367,7 +525,7 @@ ArlPDFObject::ArlPDFObject(ArlPDFObject *parent, void* obj, const bool can_delet
 
     // Resolve the indirect reference to a terminating object
     if (is_indirect)
-        pdf_obj = pdfium_resolve_indirect(pdf_obj);
+        pdf_obj = pdfium_resolve_indirect(sdk_ctx, pdf_obj);
 
     // Object can be invalid (e.g. no valid object in PDF file or infinite loop of indirect references) 
     // so substitute a null object as constructors cannot return nullptr
@@ -375,7 +533,7 @@ ArlPDFObject::ArlPDFObject(ArlPDFObject *parent, void* obj, const bool can_delet
         pdf_obj = new CPDF_Null; /// @todo will leak 12 bytes as no distinguishig between explicit null in PDF and this error situation
 
     // Proceed to populate class data
-    type = determine_object_type(pdf_obj);
+    type = determine_object_type(sdk_ctx, pdf_obj);
     obj_nbr = pdf_obj->GetObjNum();
     gen_nbr = pdf_obj->GetGenNum();
     if ((parent != nullptr) && (obj_nbr == 0)) {
@@ -477,26 +635,32 @@ double ArlPDFNumber::get_value()
 }
 
 
-/// @brief  Returns the bytes of a PDF string object
-/// @returns The bytes of a PDF string object (can be zero length)
-std::wstring ArlPDFString::get_value()
+/// @brief  Returns the raw bytes of a PDF string object without any copying or decoding
+/// @returns A view of the bytes held by pdfium (can be zero length). Only valid while the object exists.
+std::string_view ArlPDFString::get_raw_bytes()
 {
     assert(object != nullptr);
     assert(((CPDF_Object*)object)->GetType() == PDFOBJ_STRING);
-    
+    CFX_ByteString& bs = ((CPDF_String*)object)->GetString();
+    return std::string_view((FX_LPCSTR)bs, bs.GetLength());
+}
+
+
+/// @brief  Returns the bytes of a PDF string object, each widened to a wchar_t
+/// @returns The bytes of a PDF string object (can be zero length)
+std::wstring ArlPDFString::get_value()
+{
+    std::string_view bytes = get_raw_bytes();
     std::wstring retval;
-    CPDF_String* obj = ((CPDF_String*)object);
-    CFX_ByteString bs = obj->GetString();
-    for (auto i = 0; i < bs.GetLength(); i++) {
-        wchar_t b = bs.GetAt(i);
-        retval = retval + b;
-    }
+    retval.reserve(bytes.size());
+    for (auto b : bytes)
+        retval.push_back((wchar_t)(FX_BYTE)b);
 
 #ifdef MARK_STRINGS_WHEN_ENCRYPTED
     // Make error messages slightly more understandable in the case of unsupported encryption
     // Note that this will then break any predicate checks for the always-unencrypted strings described in clause 7.6.2 
-    assert(ArlingtonPDFSDK::ctx != nullptr);
-    if (((pdfium_context*)ArlingtonPDFSDK::ctx)->unsupported_encryption)
+    assert(sdk_ctx != nullptr);
+    if (((pdfium_context*)sdk_ctx)->unsupported_encryption)
         retval = UNSUPPORTED_ENCRYPTED_STRING_MARKER;
 #endif // MARK_STRINGS_WHEN_ENCRYPTED
 
@@ -515,6 +679,17 @@ bool ArlPDFString::is_hex_string()
 }
 
 
+/// @brief  Returns the raw bytes of a PDF name object without any copying or decoding
+/// @return A view of the bytes held by pdfium (can be zero length). Only valid while the object exists.
+std::string_view ArlPDFName::get_raw_bytes()
+{
+    assert(object != nullptr);
+    assert(((CPDF_Object*)object)->GetType() == PDFOBJ_NAME);
+    CFX_ByteString& bs = ((CPDF_Name*)object)->GetString();
+    return std::string_view((FX_LPCSTR)bs, bs.GetLength());
+}
+
+
 /// @brief  Returns the name of a PDF name object as a string
 /// @return The string representation of a PDF name object (can be zero length)
 std::wstring ArlPDFName::get_value()
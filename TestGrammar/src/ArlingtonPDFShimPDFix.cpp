@@ -32,6 +32,7 @@
 #include <cassert>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 
 #include "Pdfix.h"
 #include "ArlPredicates.h"
@@ -42,7 +43,9 @@ using namespace PDFixSDK;
 
 Pdfix_statics;
 
-void* ArlingtonPDFSDK::ctx = nullptr;
+/// @brief PDFix is a process-wide singleton so is shared by all ArlingtonPDFSDK instances
+static std::mutex   pdfix_mutex;
+static int          pdfix_refs = 0;
 
 struct pdfix_context {
     Pdfix*                  pdfix = nullptr;
@@ -50,11 +53,17 @@ struct pdfix_context {
     std::filesystem::path   pdf_file;
     ArlPDFTrailer*          pdf_trailer = nullptr;
     ArlPDFDictionary*       pdf_catalog = nullptr;
+    PsCustomStream*         stream = nullptr;       // PDF opened via a pdf_read_fn callback
+    pdf_read_fn             reader;
+    size_t                  reader_size = 0;
 
     ~pdfix_context() {
         if (doc != nullptr)
             doc->Close();
-        if (pdfix != nullptr)
+        if (stream != nullptr)
+            stream->Destroy();
+        std::lock_guard<std::mutex> lock(pdfix_mutex);
+        if ((pdfix != nullptr) && (--pdfix_refs == 0))
             pdfix->Destroy();
     }
 };
@@ -66,24 +75,31 @@ void ArlingtonPDFSDK::initialize()
 {
     assert(ctx == nullptr);
 
-    // initialize Pdfix
-    std::wstring email = L"PDF Assoc. SafeDocs";
-    std::wstring license_key = L"jgrrknzeuaDobhTt";
+    std::lock_guard<std::mutex> lock(pdfix_mutex);
+    Pdfix* pdfix = nullptr;
+    if (pdfix_refs == 0) {
+        // initialize Pdfix
+        std::wstring email = L"PDF Assoc. SafeDocs";
+        std::wstring license_key = L"jgrrknzeuaDobhTt";
 
-    if (!Pdfix_init(Pdfix_MODULE_NAME))
-        throw std::runtime_error("Pdfix: Initialization failed for " Pdfix_MODULE_NAME);
+        if (!Pdfix_init(Pdfix_MODULE_NAME))
+            throw std::runtime_error("Pdfix: Initialization failed for " Pdfix_MODULE_NAME);
 
-    Pdfix* pdfix = GetPdfix();
-    if (pdfix == nullptr)
-        throw std::runtime_error("Pdfix: GetPdfix failed");
+        pdfix = GetPdfix();
+        if (pdfix == nullptr)
+            throw std::runtime_error("Pdfix: GetPdfix failed");
 
-    if (pdfix->GetVersionMajor() != PDFIX_VERSION_MAJOR ||
-        pdfix->GetVersionMinor() != PDFIX_VERSION_MINOR ||
-        pdfix->GetVersionPatch() != PDFIX_VERSION_PATCH)
-        throw std::runtime_error("Pdfix: Incompatible version");
+        if (pdfix->GetVersionMajor() != PDFIX_VERSION_MAJOR ||
+            pdfix->GetVersionMinor() != PDFIX_VERSION_MINOR ||
+            pdfix->GetVersionPatch() != PDFIX_VERSION_PATCH)
+            throw std::runtime_error("Pdfix: Incompatible version");
 
-    if (!pdfix->GetAccountAuthorization()->Authorize(email.c_str(), license_key.c_str()))
-        throw std::runtime_error("Pdfix: Authorization failed");
+        if (!pdfix->GetAccountAuthorization()->Authorize(email.c_str(), license_key.c_str()))
+            throw std::runtime_error("Pdfix: Authorization failed");
+    }
+    else
+        pdfix = GetPdfix();
+    pdfix_refs++;
 
     // Assign to void context
     auto pdfix_ctx = new pdfix_context;
@@ -115,25 +131,14 @@ std::string ArlingtonPDFSDK::get_version_string()
 }
 
 
-/// @brief   Opens a PDF file (optional password) 
+/// @brief   Sets up the trailer and document catalog after PDFix has opened a PDF
 /// 
-/// @param[in]   pdf_filename PDF filename
-/// @param[in]   password     optional password
+/// @param[in]   ctx   PDF SDK context
 /// 
 /// @return  true if PDF can be opened, false otherwise
-bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const std::wstring& password)
+static bool finish_open(void* ctx)
 {
-    assert(ctx != nullptr);
-    assert(!pdf_filename.empty());
     auto pdfix_ctx = (pdfix_context*)ctx;
-    if (pdfix_ctx->doc != nullptr) {
-        pdfix_ctx->doc->Close();
-        pdfix_ctx->doc = nullptr;
-    }
-
-    pdfix_ctx->pdf_file = pdf_filename;
-    pdfix_ctx->doc = pdfix_ctx->pdfix->OpenDoc(pdf_filename.wstring().data(), password.data());
-
     if (pdfix_ctx->doc != nullptr) {
         auto trailer = pdfix_ctx->doc->GetTrailerObject();
         if (trailer != nullptr)
@@ -142,7 +147,7 @@ bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const
             // if /Type key exists, then assume working with XRefStream
             PdsObject* type_key = trailer->Get(L"Type"); 
 
-            pdfix_ctx->pdf_trailer = new ArlPDFTrailer(trailer, 
+            pdfix_ctx->pdf_trailer = new ArlPDFTrailer(ctx, trailer, 
                                                 (type_key != nullptr),          // has a xref stream?
                                                 pdfix_ctx->doc->IsSecured(),    // is encrypted?
                                                 false                           /// @todo - is unsupported encryption? 
@@ -159,6 +164,75 @@ bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const
 
 
 
+/// @brief   Opens a PDF file (optional password) 
+/// 
+/// @param[in]   pdf_filename PDF filename
+/// @param[in]   password     optional password
+/// 
+/// @return  true if PDF can be opened, false otherwise
+bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const std::wstring& password)
+{
+    assert(ctx != nullptr);
+    assert(!pdf_filename.empty());
+    auto pdfix_ctx = (pdfix_context*)ctx;
+    if (pdfix_ctx->doc != nullptr) {
+        pdfix_ctx->doc->Close();
+        pdfix_ctx->doc = nullptr;
+    }
+
+    pdfix_ctx->pdf_file = pdf_filename;
+    pdfix_ctx->doc = pdfix_ctx->pdfix->OpenDoc(pdf_filename.wstring().data(), password.data());
+    return finish_open(ctx);
+}
+
+
+/// @brief PDFix custom stream read callback for a PDF opened via a pdf_read_fn callback
+static int pdfix_stream_read(int offset, void* buffer, int size, void* client_data) {
+    auto pdfix_ctx = (pdfix_context*)client_data;
+    if ((offset < 0) || (size < 0) || ((size_t)offset > pdfix_ctx->reader_size))
+        return 0;
+    size_t n = std::min((size_t)size, pdfix_ctx->reader_size - (size_t)offset);
+    return pdfix_ctx->reader((size_t)offset, buffer, n) ? (int)n : 0;
+}
+
+
+/// @brief PDFix custom stream size callback for a PDF opened via a pdf_read_fn callback
+static int pdfix_stream_size(void* client_data) {
+    return (int)((pdfix_context*)client_data)->reader_size;
+}
+
+
+/// @brief   Opens a PDF that is read via a callback (optional password) 
+/// 
+/// @param[in]   reader       callback to read the PDF. Must remain valid until close_pdf().
+/// @param[in]   file_size    size of the PDF in bytes
+/// @param[in]   password     optional password
+/// 
+/// @return  true if PDF can be opened, false otherwise
+bool ArlingtonPDFSDK::open_pdf(pdf_read_fn reader, const size_t file_size, const std::wstring& password)
+{
+    assert(ctx != nullptr);
+    assert(reader);
+    auto pdfix_ctx = (pdfix_context*)ctx;
+    if (pdfix_ctx->doc != nullptr) {
+        pdfix_ctx->doc->Close();
+        pdfix_ctx->doc = nullptr;
+    }
+    if (pdfix_ctx->stream != nullptr)
+        pdfix_ctx->stream->Destroy();
+
+    pdfix_ctx->pdf_file.clear();
+    pdfix_ctx->reader = reader;
+    pdfix_ctx->reader_size = file_size;
+    pdfix_ctx->stream = pdfix_ctx->pdfix->CreateCustomStream(pdfix_stream_read, pdfix_ctx);
+    if (pdfix_ctx->stream == nullptr)
+        return false;
+    pdfix_ctx->stream->SetGetSizeProc(pdfix_stream_size);
+    pdfix_ctx->doc = pdfix_ctx->pdfix->OpenDocFromStream(pdfix_ctx->stream, password.data());
+    return finish_open(ctx);
+}
+
+
 /// @brief Close a previously opened PDF file. Frees all memory for a file so multiple PDFs don't accumulate leaked memory.
 void ArlingtonPDFSDK::close_pdf() {
     assert(ctx != nullptr);
@@ -176,6 +250,11 @@ void ArlingtonPDFSDK::close_pdf() {
         pdfix_ctx->doc->Close();
         pdfix_ctx->doc = nullptr;
     }
+
+    if (pdfix_ctx->stream != nullptr) {
+        pdfix_ctx->stream->Destroy();
+        pdfix_ctx->stream = nullptr;
+    }
 }
 
 
@@ -248,7 +327,37 @@ int ArlingtonPDFSDK::get_pdf_page_count() {
 }
 
 
-PdsObject* pdfix_resolve_indirect(PdsObject* pdfix_obj) {
+/// @brief  Releases a parsed indirect object. PDFix manages its own object cache so this is a no-op.
+///
+/// @param[in] obj_nbr   object number
+void ArlingtonPDFSDK::release_object(const int obj_nbr) {
+    assert(ctx != nullptr);
+    (void)obj_nbr;
+}
+
+
+/// @brief  release_object() does not release anything.
+///
+/// @returns false
+bool ArlingtonPDFSDK::can_release_objects() {
+    return false;
+}
+
+
+/// @brief  Not needed as release_object() does not release anything.
+///
+/// @param[in] obj_nbr   object number
+///
+/// @returns nullptr
+ArlPDFObject* ArlingtonPDFSDK::get_indirect_object(const int obj_nbr) {
+    assert(ctx != nullptr);
+    (void)obj_nbr;
+    return nullptr;
+}
+
+
+PdsObject* pdfix_resolve_indirect(void* ctx, PdsObject* pdfix_obj) {
+    assert(ctx != nullptr);
     assert(pdfix_obj != nullptr);
     int        obj_num;
     PdsObject* pdf_ir = pdfix_obj;
@@ -257,7 +366,7 @@ PdsObject* pdfix_resolve_indirect(PdsObject* pdfix_obj) {
     do {
         assert(pdf_ir->GetObjectType() == kPdsReference);
         obj_num = pdf_ir->GetId();
-        pdf_ir = ((pdfix_context*)ArlingtonPDFSDK::ctx)->doc->GetObjectById(obj_num);
+        pdf_ir = ((pdfix_context*)ctx)->doc->GetObjectById(obj_num);
         loop_count--;
         if (loop_count == 0)
             return nullptr;
@@ -268,10 +377,11 @@ PdsObject* pdfix_resolve_indirect(PdsObject* pdfix_obj) {
 
 /// @brief  Returns the PDF object type of an object
 ///
+/// @param[in]      ctx         the pdfix_context of the PDF file that pdfix_obj belongs to
 /// @param[in,out]  pdfix_obj   the pdfix indirect object which will get updated once it is resolved
 ///
 /// @return PDFObjectType enum value for the resolved object
-PDFObjectType determine_object_type(PdsObject* pdfix_obj)
+PDFObjectType determine_object_type(void* ctx, PdsObject* pdfix_obj)
 {
     if (pdfix_obj == nullptr)
         return PDFObjectType::ArlPDFObjTypeNull;
@@ -307,11 +417,11 @@ PDFObjectType determine_object_type(PdsObject* pdfix_obj)
         case kPdsReference:
             {
                 // retval = PDFObjectType::ArlPDFObjTypeReference
-                pdfix_obj = pdfix_resolve_indirect(pdfix_obj);
+                pdfix_obj = pdfix_resolve_indirect(ctx, pdfix_obj);
                 if (pdfix_obj == nullptr)
                     retval = PDFObjectType::ArlPDFObjTypeNull;
                 else
-                    retval = determine_object_type(pdfix_obj);
+                    retval = determine_object_type(ctx, pdfix_obj);
             }
             break;
         default:
@@ -328,7 +438,7 @@ PDFObjectType determine_object_type(PdsObject* pdfix_obj)
 /// @param[in] parent    the parent object (so can get the object and generation numbers)
 /// @param[in] obj       the object
 ArlPDFObject::ArlPDFObject(ArlPDFObject *parent, void* obj, const bool can_delete) :
-    object(obj), deleteable(can_delete)
+    object(obj), sdk_ctx((parent != nullptr) ? parent->sdk_ctx : nullptr), deleteable(can_delete)
 {
     assert(object != nullptr);
     PdsObject* pdfix_obj = (PdsObject*)object;
@@ -338,14 +448,14 @@ ArlPDFObject::ArlPDFObject(ArlPDFObject *parent, void* obj, const bool can_delet
     is_indirect = (obj_nbr != 0); // https://pdfix.github.io/pdfix_sdk_builds/en/6.17.0/html/struct_pds_object.html#a4103892417afc9f82e4bcc385940f4f8
     if (pdfix_obj->GetObjectType() == kPdsReference) {
         is_indirect = true;
-        object = pdfix_resolve_indirect(pdfix_obj);
+        object = pdfix_resolve_indirect(sdk_ctx, pdfix_obj);
         if (object == nullptr) {
             throw std::runtime_error("PDFix could not resolve indirect reference for object " + std::to_string(obj_nbr));
             /// @todo - replace with PdfDoc::CreateNull() in a future PDFix version
         }
     }
 
-    type = determine_object_type(pdfix_obj);
+    type = determine_object_type(sdk_ctx, pdfix_obj);
 
     if ((parent != nullptr) && (obj_nbr == 0)) {
         // Populate with parents object & generation number but as negative to indicate "direct inside parent"
@@ -433,6 +543,19 @@ double ArlPDFNumber::get_value()
 }
 
 
+/// @brief  Returns the raw bytes of a PDF string object without decoding
+/// @return A view of the bytes (can be zero length). Only valid while the object exists.
+std::string_view ArlPDFString::get_raw_bytes()
+{
+    assert(object != nullptr);
+    assert(((PdsObject*)object)->GetObjectType() == kPdsString);
+    PdsString* obj = (PdsString*)object;
+    raw_bytes.resize(obj->GetValue(nullptr, 0));
+    obj->GetValue((char*)raw_bytes.data(), (int)raw_bytes.size());
+    return raw_bytes;
+}
+
+
 /// @brief  Returns the bytes of a PDF string object
 /// @return The bytes of a PDF string object (can be zero length)
 std::wstring ArlPDFString::get_value()
@@ -455,6 +578,19 @@ bool ArlPDFString::is_hex_string()
 
 
 
+/// @brief  Returns the raw bytes of a PDF name object without decoding
+/// @return A view of the bytes (can be zero length). Only valid while the object exists.
+std::string_view ArlPDFName::get_raw_bytes()
+{
+    assert(object != nullptr);
+    assert(((PdsObject*)object)->GetObjectType() == kPdsName);
+    PdsName* obj = (PdsName*)object;
+    raw_bytes.resize(obj->GetValue(nullptr, 0));
+    obj->GetValue((char*)raw_bytes.data(), (int)raw_bytes.size());
+    return raw_bytes;
+}
+
+
 /// @brief  Returns the name of a PDF name object as a string
 /// @return The string representation of a PDF name object (can be zero length)
 std::wstring ArlPDFName::get_value()
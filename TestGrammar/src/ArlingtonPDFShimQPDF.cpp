@@ -41,13 +41,12 @@
 
 using namespace ArlingtonPDFShim;
 
-void* ArlingtonPDFSDK::ctx = nullptr;
-
 
 struct qpdf_context {
     QPDF*               qpdf_ctx  = nullptr;
     ArlPDFTrailer*      pdf_trailer = nullptr;
     ArlPDFDictionary*   pdf_catalog = nullptr;
+    std::string         pdf_buffer;             // PDF opened via a pdf_read_fn callback (QPDF does not copy it)
 
     ~qpdf_context() {
     }
@@ -86,29 +85,19 @@ std::string ArlingtonPDFSDK::get_version_string()
 }
 
 
-/// @brief   Opens a PDF file (optional password) 
+/// @brief   Sets up the trailer and document catalog after QPDF has processed a PDF
 /// 
-/// @param[in]   pdf_filename PDF filename
-/// @param[in]   password     optional password
+/// @param[in]   ctx   PDF SDK context
 ///    
 /// @return  true if PDF can be opened, false otherwise
-bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const std::wstring& password)
+static bool finish_open(void* ctx)
 {
-    assert(ctx != nullptr);
     qpdf_context* qctx = (qpdf_context*)ctx;
-    assert(qctx->qpdf_ctx != nullptr);
-    assert(!pdf_filename.empty());
-
-    if (password.size() > 0)
-        qctx->qpdf_ctx->processFile(pdf_filename.string().c_str(), ToUtf8(password).c_str());
-    else
-        qctx->qpdf_ctx->processFile(pdf_filename.string().c_str());
-
     auto t = qctx->qpdf_ctx->getTrailer();
     QPDFObjectHandle* trailer = &t;
 
     if (trailer->isDictionary()) {
-        qctx->pdf_trailer = new ArlPDFTrailer(trailer, 
+        qctx->pdf_trailer = new ArlPDFTrailer(ctx, trailer, 
                                             trailer->hasKey("/Type"),
                                             qctx->qpdf_ctx->isEncrypted(), 
                                             false
@@ -121,6 +110,53 @@ bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const
 }
 
 
+/// @brief   Opens a PDF file (optional password) 
+/// 
+/// @param[in]   pdf_filename PDF filename
+/// @param[in]   password     optional password
+///    
+/// @return  true if PDF can be opened, false otherwise
+bool ArlingtonPDFSDK::open_pdf(const std::filesystem::path& pdf_filename, const std::wstring& password)
+{
+    assert(ctx != nullptr);
+    qpdf_context* qctx = (qpdf_context*)ctx;
+    assert(qctx->qpdf_ctx != nullptr);
+    assert(!pdf_filename.empty());
+
+    if (password.size() > 0)
+        qctx->qpdf_ctx->processFile(pdf_filename.string().c_str(), ToUtf8(password).c_str());
+    else
+        qctx->qpdf_ctx->processFile(pdf_filename.string().c_str());
+    return finish_open(ctx);
+}
+
+
+/// @brief   Opens a PDF that is read via a callback (optional password).
+/// QPDF needs the whole PDF in memory so it is read completely first.
+/// 
+/// @param[in]   reader       callback to read the PDF
+/// @param[in]   file_size    size of the PDF in bytes
+/// @param[in]   password     optional password
+///    
+/// @return  true if PDF can be opened, false otherwise
+bool ArlingtonPDFSDK::open_pdf(pdf_read_fn reader, const size_t file_size, const std::wstring& password)
+{
+    assert(ctx != nullptr);
+    qpdf_context* qctx = (qpdf_context*)ctx;
+    assert(qctx->qpdf_ctx != nullptr);
+    assert(reader);
+
+    qctx->pdf_buffer.resize(file_size);
+    if ((file_size > 0) && !reader(0, &qctx->pdf_buffer[0], file_size))
+        return false;
+
+    if (password.size() > 0)
+        qctx->qpdf_ctx->processMemoryFile("memory", qctx->pdf_buffer.data(), qctx->pdf_buffer.size(), ToUtf8(password).c_str());
+    else
+        qctx->qpdf_ctx->processMemoryFile("memory", qctx->pdf_buffer.data(), qctx->pdf_buffer.size());
+    return finish_open(ctx);
+}
+
 
 /// @brief Close a previously opened PDF file. Frees all memory for a file so multiple PDFs don't accumulate leaked memory.
 void ArlingtonPDFSDK::close_pdf() {
@@ -132,6 +168,9 @@ void ArlingtonPDFSDK::close_pdf() {
 
     delete qpdf_ctx->pdf_trailer;
     qpdf_ctx->pdf_trailer = nullptr;
+
+    qpdf_ctx->pdf_buffer.clear();
+    qpdf_ctx->pdf_buffer.shrink_to_fit();
 }
 
 
@@ -198,6 +237,35 @@ int ArlingtonPDFSDK::get_pdf_page_count() {
 }
 
 
+/// @brief  Releases a parsed indirect object. QPDF manages its own object cache so this is a no-op.
+///
+/// @param[in] obj_nbr   object number
+void ArlingtonPDFSDK::release_object(const int obj_nbr) {
+    assert(ctx != nullptr);
+    (void)obj_nbr;
+}
+
+
+/// @brief  release_object() does not release anything.
+///
+/// @returns false
+bool ArlingtonPDFSDK::can_release_objects() {
+    return false;
+}
+
+
+/// @brief  Not needed as release_object() does not release anything.
+///
+/// @param[in] obj_nbr   object number
+///
+/// @returns nullptr
+ArlPDFObject* ArlingtonPDFSDK::get_indirect_object(const int obj_nbr) {
+    assert(ctx != nullptr);
+    (void)obj_nbr;
+    return nullptr;
+}
+
+
 
 /// @brief   generates unique identifier for every object
 /// @return  for indirect objects it returns the unique identifier (object number)
@@ -256,7 +324,7 @@ PDFObjectType determine_object_type(QPDFObjectHandle *obj)
 
 /// @brief Constructor taking a parent PDF object and a PDF SDK generic pointer of an object
 ArlPDFObject::ArlPDFObject(ArlPDFObject *parent, void* obj, const bool can_delete) :
-    object(obj), deleteable(can_delete)
+    object(obj), sdk_ctx((parent != nullptr) ? parent->sdk_ctx : nullptr), deleteable(can_delete)
 {
     assert(object != nullptr);
     QPDFObjectHandle* pdf_obj = (QPDFObjectHandle*)obj;
@@ -357,6 +425,18 @@ double ArlPDFNumber::get_value()
 }
 
 
+/// @brief  Returns the raw bytes of a PDF string object without decoding
+/// @return A view of the bytes (can be zero length). Only valid while the object exists.
+std::string_view ArlPDFString::get_raw_bytes()
+{
+    assert(object != nullptr);
+    QPDFObjectHandle *obj = (QPDFObjectHandle *)object;
+    assert(obj->isString());
+    raw_bytes = obj->getStringValue();
+    return raw_bytes;
+}
+
+
 /// @brief  Returns the bytes of a PDF string object
 /// @return The bytes of a PDF string object (can be zero length)
 std::wstring ArlPDFString::get_value()
@@ -379,6 +459,17 @@ bool ArlPDFString::is_hex_string()
 }
 
 
+/// @brief  Returns the raw bytes of a PDF name object without decoding
+/// @return A view of the bytes (can be zero length). Only valid while the object exists.
+std::string_view ArlPDFName::get_raw_bytes()
+{
+    assert(object != nullptr);
+    QPDFObjectHandle *obj = (QPDFObjectHandle *)object;
+    raw_bytes = obj->getName();
+    return raw_bytes;
+}
+
+
 /// @brief  Returns the name of a PDF name object as a string
 /// @return The string representation of a PDF name object (can be zero length)
 std::wstring ArlPDFName::get_value()
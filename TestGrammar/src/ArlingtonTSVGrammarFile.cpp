@@ -98,3 +98,45 @@ const ArlTSVmatrix& CArlingtonTSVGrammarFile::get_data()
 {
     return data_list;
 }
+
+
+/// @brief Locates & reads in a single Arlington TSV grammar file. The input data is not altered or validated.
+/// Each TSV file is only read once. Returned references remain valid for the life of the cache.
+///
+/// @param[in] link   the stub name of an Arlington TSV grammar file from the TSV data (i.e. without folder or ".tsv" extension)
+///
+/// @returns          a row/column matrix (vector of vector) of raw strings directly from the TSV file
+const ArlTSVmatrix& CArlingtonTSVGrammarCache::get_grammar(const std::string& link)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(cache_mutex);
+        auto it = grammar_map.find(link);
+        if (it != grammar_map.end())
+            return it->second->get_data();
+    }
+
+    // Not read yet: another thread may have read it since the shared lock was released
+    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+    auto it = grammar_map.find(link);
+    if (it == grammar_map.end())
+    {
+        fs::path grammar_file = tsv_folder;
+        grammar_file /= link + ".tsv";
+        std::unique_ptr<CArlingtonTSVGrammarFile> reader(new CArlingtonTSVGrammarFile(grammar_file));
+        reader->load();
+        const ArlTSVmatrix& to_ret = reader->get_data();
+        grammar_map.insert(std::make_pair(link, std::move(reader)));
+        return to_ret;
+    }
+    return it->second->get_data();
+}
+
+
+/// @brief Reads in all Arlington TSV grammar files in the folder, e.g. before forking worker processes
+/// so that the grammar is shared copy-on-write rather than read again by each worker.
+void CArlingtonTSVGrammarCache::load_all()
+{
+    for (const auto& entry : fs::directory_iterator(tsv_folder))
+        if (entry.is_regular_file() && (entry.path().extension() == ".tsv"))
+            (void)get_grammar(entry.path().stem().string());
+}
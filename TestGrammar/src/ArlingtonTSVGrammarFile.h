@@ -29,6 +29,10 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 namespace fs = std::filesystem;
 
@@ -112,4 +116,31 @@ public:
     const ArlTSVmatrix& get_data();
 };
 
+
+/// @class CArlingtonTSVGrammarCache
+/// Thread-safe cache of all Arlington TSV grammar files read so far from a single TSV folder.
+/// One cache is shared by all PDFs (and all --jobs threads) being checked. Lookups of files that
+/// have already been read only take a shared lock, so threads do not serialize on the cache.
+class CArlingtonTSVGrammarCache
+{
+private:
+    fs::path            tsv_folder;
+    std::shared_mutex   cache_mutex;
+    std::map<std::string, std::unique_ptr<CArlingtonTSVGrammarFile>>  grammar_map;
+
+public:
+    explicit CArlingtonTSVGrammarCache(const fs::path& tsv_dir) :
+        tsv_folder(tsv_dir)
+        { /* constructor */ }
+
+    /// @brief Returns the folder with the Arlington TSV file set
+    const fs::path& get_tsv_dir() { return tsv_folder; }
+
+    /// @brief Locates & reads in a single Arlington TSV grammar file (once)
+    const ArlTSVmatrix& get_grammar(const std::string& link);
+
+    /// @brief Reads in all Arlington TSV grammar files in the folder
+    void load_all();
+};
+
 #endif // ArlingtonTSVGrammarFile_h
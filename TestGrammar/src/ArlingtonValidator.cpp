@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief libarlington: CArlingtonValidator class definition
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Roman Toda, Normex
+/// @author Frantisek Forgac, Normex
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <exception>
+#include <system_error>
+
+#include "ArlingtonValidator.h"
+#include "ParseObjects.h"
+#include "PDFFile.h"
+#include "TestGrammarVers.h"
+#include "utils.h"
+
+
+/// @brief Checks a single PDF against the Arlington PDF model
+///
+/// @param[in] pdfsdk      the already initiated PDF SDK library to use
+/// @param[in] pdf_name    PDF filename (or name of an in-memory PDF) for the report
+/// @param[in] file_size   size of the PDF in bytes
+/// @param[in] open_fn     opens the PDF with pdfsdk
+/// @param[in] opts        options
+/// @param[in] report_ofs  already open stream for the report
+/// @param[in,out] findings  findings of the PDF for --stats, or nullptr
+/// @param[out] messages   messages of the PDF, or nullptr
+///
+/// @returns true on success. false on a fatal error
+bool CArlingtonValidator::check_pdf(ArlingtonPDFSDK& pdfsdk, const fs::path& pdf_name, const size_t file_size, std::function<bool()> open_fn, const arl_options& opts, std::ostream& report_ofs, arl_findings* findings, std::vector<arl_message>* messages)
+{
+    bool retval = true;
+    const ReportFormat format = opts.format;
+
+    // Messages are recorded as they are reported, with the report written through the message log
+    CArlMessageLog  msg_log(report_ofs.rdbuf());
+    std::ostream    log_ofs(&msg_log);
+    std::ostream&   ofs = (messages != nullptr) ? log_ofs : report_ofs;
+    CArlMessageLog* log = (messages != nullptr) ? &msg_log : nullptr;
+
+    try
+    {
+        if (format == ReportFormat::JSONL)
+            write_jsonl_message(ofs, ArlMessageCode::Begin, "", "", nullptr, 0, "", pdf_name.string());
+        else {
+            ofs << "BEGIN - TestGrammar " << TestGrammar_VERSION << " " << pdfsdk.get_version_string() << '\n';
+            ofs << "Arlington TSV data: " << fs::absolute(grammar.get_tsv_dir()).lexically_normal() << '\n';
+            ofs << "PDF: " << pdf_name << '\n';
+        }
+
+        if (open_fn()) {
+            CParsePDF parser(grammar, ofs, opts.terse, opts.debug_mode);
+            parser.set_low_memory(opts.low_memory);
+            parser.set_budgets(opts.max_objects, opts.max_seconds, opts.max_depth);
+            parser.set_max_repeats(opts.max_repeats);
+            parser.set_format(format);
+            parser.set_findings(findings);
+            parser.set_message_log(log);
+            parser.set_objects_checked(opts.objects_checked);
+            CPDFFile  pdf(pdf_name, pdfsdk, opts.force_version, opts.extns, file_size);
+            std::string s;
+            ArlPDFTrailer* t = pdfsdk.get_trailer();
+            if (t != nullptr) {
+                if (t->is_xrefstm()) {
+                    if (report_message(ofs, format, findings, ArlMessageCode::XRefStream, "", log))
+                        ofs << COLOR_INFO << "XRefStream detected." << COLOR_RESET;
+                    s = "Trailer (as XRefStream)";
+                    parser.add_root_parse_object(t, "XRefStream", s);
+                }
+                else {
+                    if (report_message(ofs, format, findings, ArlMessageCode::TraditionalTrailer, "", log))
+                        ofs << COLOR_INFO << "Traditional trailer dictionary detected." << COLOR_RESET;
+                    s = "Trailer";
+                    parser.add_root_parse_object(t, "FileTrailer", s);
+                }
+
+                parser.add_root_parse_object(pdfsdk.get_document_catalog(), "Catalog", s + "->Root (as Catalog)");
+
+                if (t->is_encrypted()) {
+                    if (t->is_unsupported_encryption()) {
+                        if (report_message(ofs, format, findings, ArlMessageCode::UnsupportedEncryption, "", log))
+                            ofs << COLOR_INFO << "Unsupported encryption" << COLOR_RESET;
+                    }
+                    else {
+                        if (report_message(ofs, format, findings, ArlMessageCode::Encrypted, "", log))
+                            ofs << COLOR_INFO << "Encrypted PDF" << COLOR_RESET;
+                    }
+                }
+
+                retval = parser.parse_object(pdf);
+                if (retval && report_message(ofs, format, findings, ArlMessageCode::LatestFeature, trim(pdf.get_latest_feature_version_info()), log)) {
+                    ofs << COLOR_INFO << "Latest Arlington object was" << pdf.get_latest_feature_version_info() << " compared using" << (pdf.is_forced_version() ? " forced" : "") << " PDF " << pdf.pdf_version;
+                    if (opts.extns.size() > 0) {
+                        ofs << " with extensions ";
+                        for (size_t i = 0; i < opts.extns.size(); i++)
+                            ofs << opts.extns[i] << ((i < (opts.extns.size() - 1)) ? ", " : "");
+                    }
+                    ofs << COLOR_RESET;
+                }
+            }
+            else {
+                if (report_message(ofs, format, findings, ArlMessageCode::NoTrailer, "", log))
+                    ofs << COLOR_ERROR << "failed to acquire Trailer" << COLOR_RESET;
+            }
+            pdfsdk.close_pdf();
+        }
+        else {
+            if (report_message(ofs, format, findings, ArlMessageCode::OpenFailed, "", log))
+                ofs << COLOR_ERROR << "failed to open PDF" << COLOR_RESET;
+        }
+    }
+    catch (std::exception& ex) {
+        if (report_message(ofs, format, findings, ArlMessageCode::Exception, ex.what(), log))
+            ofs << COLOR_ERROR << "EXCEPTION: " << ex.what() << COLOR_RESET;
+        retval = false;
+    }
+
+    // Lines are not flushed as they are written, only in batches (see CParsePDF::report()) and once the whole report is complete
+    if (report_message(ofs, format, findings, ArlMessageCode::End, "", log))
+        ofs << "END" << std::endl;
+    else
+        ofs.flush();
+    if (messages != nullptr)
+        *messages = std::move(msg_log.get_messages());
+    return retval;
+}
+
+
+/// @brief Checks a PDF file against the Arlington PDF model
+///
+/// @param[in] pdfsdk      the already initiated PDF SDK library to use (one per thread)
+/// @param[in] pdf_file    PDF filename
+/// @param[in] opts        options
+/// @param[in] ofs         already open stream for the report
+/// @param[in,out] findings  findings of the PDF for --stats, or nullptr
+/// @param[out] messages   messages of the PDF, or nullptr
+///
+/// @returns true on success. false on a fatal error
+bool CArlingtonValidator::validate_file(ArlingtonPDFSDK& pdfsdk, const fs::path& pdf_file, const arl_options& opts, std::ostream& ofs, arl_findings* findings, std::vector<arl_message>* messages)
+{
+    std::error_code ec;
+    size_t file_size = (size_t)fs::file_size(pdf_file, ec);
+    if (ec)
+        file_size = 0;
+    return check_pdf(pdfsdk, fs::absolute(pdf_file).lexically_normal(), file_size,
+        [&]() { return pdfsdk.open_pdf(pdf_file, opts.password); },
+        opts, ofs, findings, messages);
+}
+
+
+/// @brief Checks a PDF in a memory buffer against the Arlington PDF model. The buffer is not copied.
+///
+/// @param[in] pdfsdk      the already initiated PDF SDK library to use (one per thread)
+/// @param[in] buffer      the PDF
+/// @param[in] size        size of the PDF in bytes
+/// @param[in] name        name of the PDF for the report
+/// @param[in] opts        options
+/// @param[in] ofs         already open stream for the report
+/// @param[in,out] findings  findings of the PDF for --stats, or nullptr
+/// @param[out] messages   messages of the PDF, or nullptr
+///
+/// @returns true on success. false on a fatal error
+bool CArlingtonValidator::validate_buffer(ArlingtonPDFSDK& pdfsdk, const void* buffer, const size_t size, const std::string& name, const arl_options& opts, std::ostream& ofs, arl_findings* findings, std::vector<arl_message>* messages)
+{
+    return validate_stream(pdfsdk,
+        [buffer, size](const size_t offset, void* buf, const size_t n) {
+            if ((offset > size) || (n > size - offset))
+                return false;
+            memcpy(buf, (const char*)buffer + offset, n);
+            return true;
+        },
+        size, name, opts, ofs, findings, messages);
+}
+
+
+/// @brief Checks a PDF in a memory buffer against the Arlington PDF model
+///
+/// @param[in]  pdfsdk      the already initiated PDF SDK library to use (one per thread)
+/// @param[in]  buffer      the PDF
+/// @param[in]  size        size of the PDF in bytes
+/// @param[in]  opts        options
+/// @param[out] messages    all messages from the report
+///
+/// @returns true on success. false on a fatal error
+bool CArlingtonValidator::validate_buffer(ArlingtonPDFSDK& pdfsdk, const void* buffer, const size_t size, const arl_options& opts, std::vector<arl_message>& messages)
+{
+    // The report is discarded. As a text report it gives each message its text.
+    arl_options  text_opts = opts;
+    text_opts.format = ReportFormat::Text;
+    return validate_buffer(pdfsdk, buffer, size, "memory", text_opts, cnull, nullptr, &messages);
+}
+
+
+/// @brief Checks a PDF that is read via a callback against the Arlington PDF model
+///
+/// @param[in] pdfsdk      the already initiated PDF SDK library to use (one per thread)
+/// @param[in] reader      reads bytes from the PDF
+/// @param[in] size        size of the PDF in bytes
+/// @param[in] name        name of the PDF for the report
+/// @param[in] opts        options
+/// @param[in] ofs         already open stream for the report
+/// @param[in,out] findings  findings of the PDF for --stats, or nullptr
+/// @param[out] messages   messages of the PDF, or nullptr
+///
+/// @returns true on success. false on a fatal error
+bool CArlingtonValidator::validate_stream(ArlingtonPDFSDK& pdfsdk, pdf_read_fn reader, const size_t size, const std::string& name, const arl_options& opts, std::ostream& ofs, arl_findings* findings, std::vector<arl_message>* messages)
+{
+    return check_pdf(pdfsdk, fs::path(name), size,
+        [&]() { return pdfsdk.open_pdf(reader, size, opts.password); },
+        opts, ofs, findings, messages);
+}
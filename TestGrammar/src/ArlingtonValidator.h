@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief libarlington: CArlingtonValidator class declaration
+///
+/// The small C++ API of the libarlington library. The Arlington PDF model is
+/// loaded once and PDFs are then checked from files, memory buffers or read
+/// callbacks. TestGrammar is a client of this API.
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ArlingtonValidator_h
+#define ArlingtonValidator_h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ArlingtonPDFShim.h"
+#include "ArlMessages.h"
+#include "ArlingtonTSVGrammarFile.h"
+
+using namespace ArlingtonPDFShim;
+namespace fs = std::filesystem;
+
+
+/// @brief Options that change how a PDF is checked and what is reported
+struct arl_options {
+    std::string                 force_version;      // forced PDF version, "exact" or empty to use the PDF version
+    std::vector<std::string>    extns;              // extension names to support ("*" for all)
+    std::wstring                password;           // password for encrypted PDFs
+    bool                        terse = false;      // brief output
+    bool                        debug_mode = false; // PDF-file specific information (object numbers, etc.)
+    bool                        low_memory = false; // release PDF objects as soon as they have been checked
+    unsigned int                max_objects = 0;    // maximum number of PDF objects to check (0 = unlimited)
+    unsigned int                max_seconds = 0;    // maximum number of seconds to spend checking (0 = unlimited)
+    int                         max_depth = 0;      // maximum depth of PDF objects below the trailer (0 = unlimited)
+    unsigned int                max_repeats = 0;    // maximum number of messages with the same code, Arlington object and key (0 = unlimited)
+    ReportFormat                format = ReportFormat::Text;    // text or JSON Lines report
+    std::atomic<uint64_t>*      objects_checked = nullptr;      // --metrics: PDF objects checked are added to this while checking, or nullptr
+};
+
+
+/// @class CArlingtonValidator
+/// Checks PDFs against an Arlington PDF model. The model is shared by all PDFs and is thread-safe,
+/// so one validator can be used by many threads as long as each thread uses its own PDF SDK instance.
+class CArlingtonValidator {
+    /// @brief The Arlington PDF model, loaded on demand or with load_all()
+    CArlingtonTSVGrammarCache   grammar;
+
+    /// @brief Checks an already opened PDF
+    bool check_pdf(ArlingtonPDFSDK& pdfsdk, const fs::path& pdf_name, const size_t file_size, std::function<bool()> open_fn, const arl_options& opts, std::ostream& report_ofs, arl_findings* findings, std::vector<arl_message>* messages);
+
+public:
+    explicit CArlingtonValidator(const fs::path& tsv_dir)
+        : grammar(tsv_dir)
+        { /* constructor */ }
+
+    /// @brief Returns the folder of the Arlington TSV file set
+    fs::path get_tsv_dir() { return grammar.get_tsv_dir(); }
+
+    /// @brief Loads the entire Arlington model now, rather than as PDFs need it
+    void load_all() { grammar.load_all(); }
+
+    /// @brief Checks a PDF file, writing the report to ofs and optionally counting its findings for --stats and returning its messages
+    bool validate_file(ArlingtonPDFSDK& pdfsdk, const fs::path& pdf_file, const arl_options& opts, std::ostream& ofs, arl_findings* findings = nullptr, std::vector<arl_message>* messages = nullptr);
+
+    /// @brief Checks a PDF in a memory buffer, writing the report to ofs and optionally counting its findings and returning its messages
+    bool validate_buffer(ArlingtonPDFSDK& pdfsdk, const void* buffer, const size_t size, const std::string& name, const arl_options& opts, std::ostream& ofs, arl_findings* findings = nullptr, std::vector<arl_message>* messages = nullptr);
+
+    /// @brief Checks a PDF in a memory buffer, returning the messages
+    bool validate_buffer(ArlingtonPDFSDK& pdfsdk, const void* buffer, const size_t size, const arl_options& opts, std::vector<arl_message>& messages);
+
+    /// @brief Checks a PDF that is read via a callback, writing the report to ofs and optionally counting its findings and returning its messages
+    bool validate_stream(ArlingtonPDFSDK& pdfsdk, pdf_read_fn reader, const size_t size, const std::string& name, const arl_options& opts, std::ostream& ofs, arl_findings* findings = nullptr, std::vector<arl_message>* messages = nullptr);
+};
+
+#endif // ArlingtonValidator_h
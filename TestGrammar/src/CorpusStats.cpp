@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief CCorpusStats class definition
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+
+#include "CorpusStats.h"
+
+/// @brief first line of every statistics file
+constexpr auto STATS_MAGIC = "TestGrammar corpus statistics";
+
+/// @brief column headings of the findings
+constexpr auto STATS_HEADINGS = "Code\tSeverity\tObject\tKey\tPDFs\tMessages";
+
+
+/// @brief Adds the findings of a single PDF. Each finding counts once towards its number of PDFs.
+///
+/// @param[in] findings  findings of the PDF
+/// @param[in] ok        false if the PDF had a fatal error
+void CCorpusStats::add_pdf(const arl_findings& findings, const bool ok) {
+    std::lock_guard<std::mutex> lock(mtx);
+    pdfs++;
+    if (!ok)
+        fatal++;
+    for (auto& f : findings) {
+        totals& t = table[f.first];
+        t.pdfs++;
+        t.messages += f.second;
+    }
+}
+
+
+/// @brief Adds a statistics file written by write(), e.g. of a --shard run
+///
+/// @param[in] stats_file  the statistics file
+///
+/// @returns true if the file was a valid statistics file
+bool CCorpusStats::merge_file(const fs::path& stats_file) {
+    std::ifstream   in(stats_file, std::ios::in | std::ios::binary);
+    std::string     line;
+    if (!in.is_open() || !std::getline(in, line) || (line != STATS_MAGIC))
+        return false;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    try {
+        while (std::getline(in, line) && (line != STATS_HEADINGS)) {
+            auto tab = line.find('\t');
+            if (tab == std::string::npos)
+                return false;
+            if (line.substr(0, tab) == "PDFs")
+                pdfs += (unsigned int)std::stoul(line.substr(tab + 1));
+            else if (line.substr(0, tab) == "Fatal")
+                fatal += (unsigned int)std::stoul(line.substr(tab + 1));
+        }
+        // Code, Severity, Object, Key, PDFs, Messages
+        while (std::getline(in, line)) {
+            std::string::size_type t[5];
+            std::string::size_type pos = 0;
+            for (int i = 0; i < 5; i++) {
+                t[i] = line.find('\t', pos);
+                if (t[i] == std::string::npos)
+                    return false;
+                pos = t[i] + 1;
+            }
+            totals& tot = table[std::make_tuple(std::stoi(line.substr(0, t[0])), line.substr(t[1] + 1, t[2] - t[1] - 1), line.substr(t[2] + 1, t[3] - t[2] - 1))];
+            tot.pdfs += (unsigned int)std::stoul(line.substr(t[3] + 1, t[4] - t[3] - 1));
+            tot.messages += std::stoull(line.substr(t[4] + 1));
+        }
+    }
+    catch (...) {
+        return false;
+    }
+    return true;
+}
+
+
+/// @brief Writes the statistics as TSV: a header with the number of PDFs, then one line per
+/// message code, Arlington object and key with the number of PDFs and the number of messages.
+/// For PDF version messages the key is the PDF version, giving the distribution of versions.
+///
+/// @param[in] ofs  output stream
+void CCorpusStats::write(std::ostream& ofs) {
+    std::lock_guard<std::mutex> lock(mtx);
+    ofs << STATS_MAGIC << "\n";
+    ofs << "PDFs\t" << pdfs << "\n";
+    ofs << "Fatal\t" << fatal << "\n";
+    ofs << STATS_HEADINGS << "\n";
+    for (auto& r : table)
+        ofs << std::get<0>(r.first) << '\t' << get_message_type_name(get_message_type((ArlMessageCode)std::get<0>(r.first))) << '\t'
+            << std::get<1>(r.first) << '\t' << std::get<2>(r.first) << '\t' << r.second.pdfs << '\t' << r.second.messages << "\n";
+    ofs.flush();
+}
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief CCorpusStats class declaration
+///
+/// Corpus statistics (--stats): how many PDFs triggered each message for each
+/// Arlington object and key, gathered while PDFs are checked.
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CorpusStats_h
+#define CorpusStats_h
+#pragma once
+
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "ArlMessages.h"
+
+namespace fs = std::filesystem;
+
+
+/// @class CCorpusStats
+/// Exact counts of the findings of all PDFs in a run. Worker threads add the findings of each PDF
+/// as it is completed. Statistics files of --shard runs are combined with --merge-stats.
+class CCorpusStats {
+    /// @brief number of PDFs and number of messages for a message code, Arlington object and key
+    struct totals {
+        unsigned int        pdfs = 0;
+        unsigned long long  messages = 0;
+    };
+
+    std::mutex          mtx;
+
+    /// @brief totals by message code, Arlington object and key
+    std::map<std::tuple<int, std::string, std::string>, totals> table;
+
+    /// @brief number of PDFs checked
+    unsigned int        pdfs;
+
+    /// @brief number of PDFs with a fatal error
+    unsigned int        fatal;
+
+public:
+    CCorpusStats()
+        : pdfs(0), fatal(0)
+        { /* constructor */ }
+
+    /// @brief Adds the findings of a single PDF. Thread safe.
+    void add_pdf(const arl_findings& findings, const bool ok);
+
+    /// @brief Adds a statistics file written by write()
+    bool merge_file(const fs::path& stats_file);
+
+    /// @brief Writes the statistics as TSV
+    void write(std::ostream& ofs);
+
+    /// @brief number of PDFs
+    unsigned int size() { return pdfs; }
+};
+
+#endif // CorpusStats_h
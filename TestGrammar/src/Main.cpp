@@ -29,9 +29,18 @@
 #endif
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <exception>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #if defined __linux__
@@ -39,11 +48,18 @@
 #endif
 
 #include "ArlingtonPDFShim.h"
+#include "ArlingtonTSVGrammarFile.h"
+#include "ArlingtonValidator.h"
 #include "ArlPredicates.h"
 #include "ParseObjects.h"
 #include "CheckGrammar.h"
+#include "CorpusStats.h"
 #include "TestGrammarVers.h"
 #include "PDFFile.h"
+#include "PDFJobs.h"
+#include "ReportStore.h"
+#include "ResultCache.h"
+#include "Server.h"
 #include "sarge.h"
 #include "utils.h"
 
@@ -51,107 +67,57 @@ using namespace ArlingtonPDFShim;
 namespace fs = std::filesystem;
 
 
-/// @brief /dev/null equivalent streams for chars - see https://stackoverflow.com/questions/6240950/platform-independent-dev-null-in-c#6240980
-std::ostream  cnull(0);
-
-/// @brief /dev/null equivalent stream for wide chars - see https://stackoverflow.com/questions/6240950/platform-independent-dev-null-in-c#6240980
-std::wostream wcnull(0);
-
-/// @brief Global control over colorized output
-bool no_color = false;
-
-/// @brief Validates a single PDF file against the Arlington PDF model
+/// @brief Validates a single PDF file against the Arlington PDF model, using the result cache if there is one
 ///
 /// @param[in] pdf_file_name  PDF filename for processing
-/// @param[in] tsv_folder  the folder with the Arlington TSV model files
+/// @param[in] validator   the Arlington PDF model (shared, may be used by multiple threads)
 /// @param[in] pdfsdk      the already initiated PDF SDK library to use
 /// @param[in] ofs         already open file stream for output
-/// @param[in] terse       terse style (brief) output (will sort | uniq better under Linux CLI)
-/// @param[in] debug_mode  verbose style output (PDF-file specific information e.g. object numbers)
-/// @param[in] forced_ver  forced PDF version or empty string to use PDF
-/// @param[in] extns       list of extension names to support
-/// @param[in] pwd         password
+/// @param[in] opts        options that change how the PDF is checked
+/// @param[in] cache       persistent result cache or nullptr
+/// @param[out] findings   findings of the PDF for --stats, or nullptr
 /// 
 /// @returns true on success. false on a fatal error
 bool process_single_pdf(
     const fs::path& pdf_file_name, 
-    const fs::path& tsv_folder, 
+    CArlingtonValidator& validator, 
     ArlingtonPDFSDK& pdfsdk, 
     std::ostream& ofs, 
-    const bool terse, 
-    const bool debug_mode, 
-    const std::string& forced_ver, 
-    std::vector<std::string>& extns,
-    std::wstring& pwd)
+    const arl_options& opts,
+    CResultCache* cache,
+    arl_findings* findings)
 {
     bool retval = true;
-    try
-    {
-        ofs << "BEGIN - TestGrammar " << TestGrammar_VERSION << " " << pdfsdk.get_version_string() << std::endl;
-        ofs << "Arlington TSV data: " << fs::absolute(tsv_folder).lexically_normal() << std::endl;
-        ofs << "PDF: " << fs::absolute(pdf_file_name).lexically_normal() << std::endl;
-
-        if (pdfsdk.open_pdf(pdf_file_name, pwd)) {
-            CParsePDF parser(tsv_folder, ofs, terse, debug_mode);
-            CPDFFile  pdf(pdf_file_name, pdfsdk, forced_ver, extns);
-            std::string s;
-            ArlPDFTrailer* t = pdfsdk.get_trailer();
-            if (t != nullptr) {
-                if (t->is_xrefstm()) {
-                    ofs << COLOR_INFO << "XRefStream detected." << COLOR_RESET;
-                    s = "Trailer (as XRefStream)";
-                    parser.add_root_parse_object(t, "XRefStream", s);
-                }
-                else {
-                    ofs << COLOR_INFO << "Traditional trailer dictionary detected." << COLOR_RESET;
-                    s = "Trailer";
-                    parser.add_root_parse_object(t, "FileTrailer", s);
-                }
-
-                parser.add_root_parse_object(pdfsdk.get_document_catalog(), "Catalog", s + "->Root (as Catalog)");
 
-                if (t->is_encrypted()) {
-                    if (t->is_unsupported_encryption()) {
-                        ofs << COLOR_INFO << "Unsupported encryption" << COLOR_RESET;
-                    }
-                    else {
-                        ofs << COLOR_INFO << "Encrypted PDF" << COLOR_RESET;
-                    }
-                }
-
-                retval = parser.parse_object(pdf);
-                if (retval) {
-                    ofs << COLOR_INFO << "Latest Arlington object was" << pdf.get_latest_feature_version_info() << " compared using" << (pdf.is_forced_version() ? " forced" : "") << " PDF " << pdf.pdf_version;
-                    if (extns.size() > 0) {
-                        ofs << " with extensions ";
-                        for (size_t i = 0; i < extns.size(); i++)
-                            ofs << extns[i] << ((i < (extns.size() - 1)) ? ", " : "");
-                    }
-                    ofs << COLOR_RESET;
-                }
-            }
-            else {
-                ofs << COLOR_ERROR << "failed to acquire Trailer" << COLOR_RESET;
-            }
-            pdfsdk.close_pdf();
-        }
-        else {
-            ofs << COLOR_ERROR << "failed to open PDF" << COLOR_RESET;
-        }
-    }
-    catch (std::exception& ex) {
-        ofs << COLOR_ERROR << "EXCEPTION: " << ex.what() << COLOR_RESET;
-        retval = false;
+    // Use a cached report if the same PDF has already been checked the same way.
+    // Otherwise check the PDF into memory so that the report can also be added to the cache.
+    // Findings are always cached so that later --stats runs can use the cached reports.
+    if (cache != nullptr) {
+        arl_findings cache_findings;
+        if (findings == nullptr)
+            findings = &cache_findings;
+        std::string key = cache->make_key(pdf_file_name);
+        if (!key.empty() && cache->lookup(key, pdf_file_name, ofs, retval, findings))
+            return retval;
+        std::ostringstream rpt;
+        retval = validator.validate_file(pdfsdk, pdf_file_name, opts, rpt, findings);
+        // A report cut short by --max-seconds depends on the machine and its load, so is not cached
+        bool timed_out = (findings->count(std::make_tuple((int)ArlMessageCode::BudgetExceeded, std::string(), std::string("--max-seconds"))) > 0);
+        if (!key.empty() && !timed_out)
+            cache->store(key, rpt.str(), retval, *findings);
+        ofs << rpt.str();
+        ofs.flush();
+        return retval;
     }
 
-    ofs << "END" << std::endl;
-    return retval;
+    return validator.validate_file(pdfsdk, pdf_file_name, opts, ofs, findings);
 };
 
 
-
 #if defined(_WIN32) || defined(WIN32)
 #include <crtdbg.h>
+#include <fcntl.h>
+#include <io.h>
 
 /// @brief #define CRT_MEMORY_LEAK_CHECK to enable C RTL memory leak checking (slow!)
 #undef CRT_MEMORY_LEAK_CHECK
@@ -186,8 +152,8 @@ int main(int argc, char* argv[]) {
     Sarge           sarge;              // Command line option processing
 
     sarge.setDescription("Arlington PDF Model C++ P.o.C. version " TestGrammar_VERSION
-        "\nChoose one of: --pdf, --checkdva or --validate.");
-    sarge.setUsage("TestGrammar --tsvdir <dir> [--force <ver>|exact] [--out <fname|dir>] [--no-color] [--clobber] [--debug] [--brief] [--extensions <extn1[,extn2]>] [--password <pwd>] [--exclude string | @textfile.txt] [--dryrun] [--allfiles] [--validate | --checkdva <formalrep> | --pdf <fname|dir|@file.txt> ]");
+        "\nChoose one of: --pdf, --checkdva, --validate, --serve or --connect.");
+    sarge.setUsage("TestGrammar --tsvdir <dir> [--force <ver>|exact] [--out <fname|dir>] [--no-color] [--clobber] [--debug] [--brief] [--extensions <extn1[,extn2]>] [--password <pwd>] [--format text|jsonl] [--compress <level>] [--exclude string | @textfile.txt] [--dryrun] [--allfiles] [--low-memory] [--max-objects <n>] [--max-seconds <n>] [--max-depth <n>] [--max-repeats <n>] [--jobs <n>] [--readahead <n>] [--isolate] [--worker-timeout <n>] [--worker-memory <n>] [--shard <k/n>] [--journal <file>] [--history <file>] [--cache <dir>] [--stats <file>] [--store <dir>] [--metrics <file>] [--validate | --checkdva <formalrep> | --pdf <fname|dir|@file.txt> | --serve <socket> | --connect <socket> --pdf <fname|dir|@file.txt> | --merge-stats <file1[,file2]> | --store <dir> --extract <pdf|@file.txt>]");
     sarge.setArgument("h", "help", "This usage message.", false);
     sarge.setArgument("b", "brief", "terse output when checking PDFs. The full PDF DOM tree is NOT output.", false);
     sarge.setArgument("c", "checkdva", "Adobe DVA formal-rep PDF file to compare against Arlington PDF model.", true);
@@ -196,15 +162,38 @@ int main(int argc, char* argv[]) {
     sarge.setArgument("",  "no-color", "disable colorized text output (useful when redirecting or piping output)", false);
     sarge.setArgument("m", "batchmode", "stop popup error dialog windows and redirect everything to console (Windows only, includes memory leak reports).", false);
     sarge.setArgument("o", "out", "output file or folder. Default is stdout. See --clobber for overwriting behavior.", true);
-    sarge.setArgument("p", "pdf", "input PDF file, folder, or text file of PDF files/folders.", true);
+    sarge.setArgument("p", "pdf", "input PDF file, folder, text file of PDF files/folders, or - for stdin.", true);
     sarge.setArgument("f", "force", "force the PDF version to the specified value (1,0, 1.1, ..., 2.0 or 'exact'). Only applicable to --pdf.", true);
     sarge.setArgument("t", "tsvdir", "[required] folder containing Arlington PDF model TSV file set.", true);
     sarge.setArgument("v", "validate", "validate the Arlington PDF model.", false);
     sarge.setArgument("e", "extensions", "a comma-separated list of extensions, or '*' for all extensions.", true);
     sarge.setArgument("",  "password", "password. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "format", "report format: text (default) or jsonl (JSON Lines, one message per line with a stable code). Only applicable to --pdf.", true);
+    sarge.setArgument("",  "compress", "gzip-compress reports (e.g. .txt.gz) at this level: 1 (fastest) to 9 (smallest). Only applicable to --pdf.", true);
     sarge.setArgument("",  "exclude", "PDF exclusion string or filelist (# is a comment). Only applicable to --pdf.", true);
     sarge.setArgument("",  "dryrun", "Dry run - don't do any actual processing.", false);
     sarge.setArgument("a", "allfiles", "Process all files regardless of file extension.", false);
+    sarge.setArgument("",  "low-memory", "release PDF objects once checked and report peak memory use. Only applicable to --pdf.", false);
+    sarge.setArgument("",  "max-objects", "stop checking a PDF after this many objects. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "max-seconds", "stop checking a PDF after this many seconds. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "max-depth", "do not check PDF objects nested deeper than this. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "max-repeats", "report each message for the same Arlington object and key at most this many times per PDF. Only applicable to --pdf.", true);
+    sarge.setArgument("j", "jobs", "number of PDFs to check in parallel. Only applicable to --pdf with folders or file lists.", true);
+    sarge.setArgument("",  "readahead", "read upcoming PDFs into the file cache while checking, up to this many MB (not Windows). Only applicable to --pdf with folders or file lists.", true);
+    sarge.setArgument("",  "isolate", "check PDFs in separate worker processes so crashes and hangs only affect one PDF (not Windows). Use with --jobs.", false);
+    sarge.setArgument("",  "worker-timeout", "with --isolate, kill a worker process after this many seconds on one PDF.", true);
+    sarge.setArgument("",  "worker-memory", "with --isolate, kill a worker process using more than this many MB (Linux only).", true);
+    sarge.setArgument("",  "shard", "only check shard k of n (e.g. 2/8) of the PDFs. Only applicable to --pdf with folders or file lists.", true);
+    sarge.setArgument("",  "journal", "record completed PDFs in this file and skip PDFs already recorded. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "history", "journal of an earlier run: check the PDFs that took longest first with --jobs or --isolate.", true);
+    sarge.setArgument("",  "cache", "folder for a persistent cache of reports of unchanged PDFs. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "stats", "write corpus statistics (number of PDFs with each message for each Arlington object and key) to this file. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "merge-stats", "a comma-separated list of --stats files (e.g. of --shard runs) to merge into the --stats file or stdout.", true);
+    sarge.setArgument("",  "store", "append all reports to segment files with an index in this folder rather than one report file per PDF. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "extract", "write the report of this PDF, or of each PDF in @file.txt, from the --store folder to --out or stdout.", true);
+    sarge.setArgument("",  "metrics", "rewrite this file with progress metrics (Prometheus text format) every 10 seconds while checking. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "serve", "run as a validation server on this Unix domain socket using --jobs worker threads (not Windows).", true);
+    sarge.setArgument("",  "connect", "send the --pdf files to a validation server on this Unix domain socket over --jobs connections and report latency (not Windows).", true);
 
 #if defined(_WIN32) || defined(WIN32)
     if (!sarge.parseArguments(argc, mbcsargv)) {
@@ -245,15 +234,40 @@ int main(int argc, char* argv[]) {
     fs::path        save_path;          // output file or folder. Optional. Default is "." or to stdout
     fs::path        input_filename;     // --pdf @filename.txt
     bool            input_is_a_file = false; // --pdf
+    bool            input_is_stdin = false;  // --pdf -
     std::vector<fs::path> input_list;   // --pdf files and folder list
-    std::ofstream   ofs;                // output filestream
+    CReportFile     ofs;                // output filestream
     std::string     force_version;      // Optional forced PDF version
     std::wstring    pdf_password;       // Optional password
+    ReportFormat    format = ReportFormat::Text;    // --format
+    int             compress_level = 0;             // --compress
     bool            clobber = sarge.exists("clobber");
     bool            debug_mode = sarge.exists("debug");
     bool            terse = sarge.exists("brief");
     bool            dryrun = sarge.exists("dryrun");
     bool            all_files = sarge.exists("allfiles");
+    bool            low_memory = sarge.exists("low-memory");
+    unsigned int    max_objects = 0;                // --max-objects
+    unsigned int    max_seconds = 0;                // --max-seconds
+    int             max_depth = 0;                  // --max-depth
+    unsigned int    max_repeats = 0;                // --max-repeats
+    unsigned int    jobs = 1;                       // --jobs
+    unsigned int    readahead_mb = 0;               // --readahead
+    bool            isolate = sarge.exists("isolate");
+    unsigned int    worker_timeout = 0;             // --worker-timeout
+    unsigned int    worker_memory = 0;              // --worker-memory
+    unsigned int    shard_k = 0;                    // --shard k/n
+    unsigned int    shard_n = 0;                    // --shard k/n
+    fs::path        journal_filename;               // --journal
+    CPDFJournal     journal;                        // --journal
+    unsigned int    skipped = 0;                    // number of files skipped due to --journal
+    fs::path        history_filename;               // --history
+    CPDFScheduler   scheduler;                      // --jobs/--isolate: estimated cost of each PDF, optionally from --history
+    fs::path        cache_folder;                   // --cache
+    fs::path        stats_filename;                 // --stats
+    CCorpusStats    corpus_stats;                   // --stats, --merge-stats
+    fs::path        store_folder;                   // --store
+    fs::path        metrics_filename;               // --metrics
     std::vector<std::string> supported_extns;       // --extensions
     bool            exclude_as_string = false;      // --exclude
     fs::path        exclusion_filename;             // --exclude
@@ -303,11 +317,15 @@ int main(int argc, char* argv[]) {
     if (s.size() > 0)
         save_path = fs::absolute(s).lexically_normal();
 
-    // --pdf can be a folder, or a single PDF file, or "@file.txt"
+    // --pdf can be a folder, or a single PDF file, or "@file.txt", or "-" for stdin
     s.clear();
     (void)sarge.getFlag("pdf", s);
     if (s.size() > 0) {
-        if (s[0] != '@') {
+        if (s == "-") {
+            input_is_stdin = true;
+            input_is_a_file = true;
+        }
+        else if (s[0] != '@') {
             // either file or folder.
             input_list.push_back(fs::absolute(s));
             try {
@@ -349,6 +367,106 @@ int main(int argc, char* argv[]) {
         force_version = s;
     }
 
+    // Optional --max-objects <n>, --max-seconds <n>, --max-depth <n>, --max-repeats <n>, -j/--jobs <n>, --readahead <n>, --worker-timeout <n>, --worker-memory <n>
+    for (auto& opt : { "max-objects", "max-seconds", "max-depth", "max-repeats", "jobs", "readahead", "worker-timeout", "worker-memory" }) {
+        if (sarge.getFlag(opt, s)) {
+            int n = -1;
+            try {
+                n = std::stoi(s);
+            }
+            catch (...) {
+                n = -1;
+            }
+            if (n <= 0) {
+                std::cerr << COLOR_ERROR << "--" << opt << " '" << s << "' is not valid! Needs to be a positive integer." << COLOR_RESET;
+                sarge.printHelp();
+                pdf_io.shutdown();
+                return -1;
+            }
+            if (std::string(opt) == "max-objects")
+                max_objects = (unsigned int)n;
+            else if (std::string(opt) == "max-seconds")
+                max_seconds = (unsigned int)n;
+            else if (std::string(opt) == "max-depth")
+                max_depth = n;
+            else if (std::string(opt) == "max-repeats")
+                max_repeats = (unsigned int)n;
+            else if (std::string(opt) == "jobs")
+                jobs = (unsigned int)n;
+            else if (std::string(opt) == "readahead")
+                readahead_mb = (unsigned int)n;
+            else if (std::string(opt) == "worker-timeout")
+                worker_timeout = (unsigned int)n;
+            else
+                worker_memory = (unsigned int)n;
+        }
+    }
+
+    // Optional --shard k/n
+    if (sarge.getFlag("shard", s)) {
+        auto kn = split(s, '/');
+        int k = -1;
+        int n = -1;
+        try {
+            if (kn.size() == 2) {
+                k = std::stoi(kn[0]);
+                n = std::stoi(kn[1]);
+            }
+        }
+        catch (...) {
+            k = n = -1;
+        }
+        if ((k < 1) || (n < 1) || (k > n)) {
+            std::cerr << COLOR_ERROR << "--shard '" << s << "' is not valid! Needs to be k/n with 1 <= k <= n." << COLOR_RESET;
+            sarge.printHelp();
+            pdf_io.shutdown();
+            return -1;
+        }
+        shard_k = (unsigned int)k;
+        shard_n = (unsigned int)n;
+    }
+
+    // Optional --journal <file>
+    if (sarge.getFlag("journal", s)) {
+        journal_filename = fs::absolute(s).lexically_normal();
+        if (!dryrun && !journal.open(journal_filename)) {
+            std::cerr << COLOR_ERROR << "--journal '" << journal_filename << "' could not be opened!" << COLOR_RESET;
+            pdf_io.shutdown();
+            return -1;
+        }
+    }
+
+    // Optional --history <file>
+    if (sarge.getFlag("history", s)) {
+        history_filename = fs::absolute(s).lexically_normal();
+        if (!scheduler.load_history(history_filename))
+            std::cerr << COLOR_WARNING << "--history '" << history_filename << "' has no check times so PDFs are scheduled by size." << COLOR_RESET;
+    }
+
+    // Optional --cache <dir>
+    if (sarge.getFlag("cache", s))
+        cache_folder = fs::absolute(s).lexically_normal();
+
+    // Optional --stats <file>
+    if (sarge.getFlag("stats", s))
+        stats_filename = fs::absolute(s).lexically_normal();
+
+    // Optional --store <dir>
+    if (sarge.getFlag("store", s))
+        store_folder = fs::absolute(s).lexically_normal();
+
+    // Optional --metrics <file>
+    if (sarge.getFlag("metrics", s))
+        metrics_filename = fs::absolute(s).lexically_normal();
+
+#if defined(_WIN32) || defined(WIN32)
+    if (isolate) {
+        std::cerr << COLOR_ERROR << "--isolate is not supported on Windows!" << COLOR_RESET;
+        pdf_io.shutdown();
+        return -1;
+    }
+#endif // _WIN32/WIN32
+
     // Optional -e/--extensions <extn1[,extn2]>
     if (sarge.getFlag("extensions", s)) {
         supported_extns = split(s, ',');
@@ -359,6 +477,42 @@ int main(int argc, char* argv[]) {
         pdf_password = ToWString(s);
     }
 
+    // Optional --format text|jsonl
+    if (sarge.getFlag("format", s)) {
+        if (s == "jsonl")
+            format = ReportFormat::JSONL;
+        else if (s != "text") {
+            std::cerr << COLOR_ERROR << "--format '" << s << "' is not valid! Needs to be text or jsonl." << COLOR_RESET;
+            sarge.printHelp();
+            pdf_io.shutdown();
+            return -1;
+        }
+    }
+
+    // Optional --compress <level>
+    if (sarge.getFlag("compress", s)) {
+        try {
+            compress_level = std::stoi(s);
+        }
+        catch (...) {
+            compress_level = -1;
+        }
+        if ((compress_level < 1) || (compress_level > 9)) {
+            std::cerr << COLOR_ERROR << "--compress '" << s << "' is not valid! Needs to be a level from 1 to 9." << COLOR_RESET;
+            sarge.printHelp();
+            pdf_io.shutdown();
+            return -1;
+        }
+        if (!store_folder.empty()) {
+            std::cerr << COLOR_ERROR << "--compress cannot be used with --store!" << COLOR_RESET;
+            pdf_io.shutdown();
+            return -1;
+        }
+    }
+
+    // Report files are .jsonl for JSON Lines, .txt for uncolorized and .ansi for colorized text, plus .gz if compressed
+    const std::string rpt_extension = std::string((format == ReportFormat::JSONL) ? ".jsonl" : (no_color ? ".txt" : ".ansi")) + ((compress_level > 0) ? ".gz" : "");
+
     //Optional --exclude <string> | @filelist.txt
     if (sarge.getFlag("exclude", s)) 
         if (s.size() > 0)
@@ -397,7 +551,9 @@ int main(int argc, char* argv[]) {
             std::cout << "Output:               stdout" << std::endl;
         else
             std::cout << "Output file/folder:   " << save_path << std::endl;
-        if (input_list.size() == 0)
+        if (input_is_stdin)
+            std::cout << "PDF file:             <stdin>" << std::endl;
+        else if (input_list.size() == 0)
             std::cout << "PDF file/folder:      <none>"<< std::endl;
         else if (input_list.size() == 1) {
             if (input_is_a_file)
@@ -413,6 +569,34 @@ int main(int argc, char* argv[]) {
         std::cout << "Dry run:              " << (dryrun ? "on" : "off") << std::endl;
         std::cout << "All files:            " << (all_files ? "on" : "off  (*.pdf only)") << std::endl;
         std::cout << "Brief mode:           " << (terse ? "on" : "off") << std::endl;
+        std::cout << "Report format:        " << ((format == ReportFormat::JSONL) ? "jsonl" : "text") << std::endl;
+        if (compress_level > 0)
+            std::cout << "Compression level:    " << compress_level << std::endl;
+        std::cout << "Low memory mode:      " << (low_memory ? "on" : "off") << std::endl;
+        std::cout << "Budgets:              " << (max_objects > 0 ? std::to_string(max_objects) : "unlimited") << " objects, "
+                  << (max_seconds > 0 ? std::to_string(max_seconds) : "unlimited") << " seconds, "
+                  << (max_depth > 0 ? std::to_string(max_depth) : "unlimited") << " depth, "
+                  << (max_repeats > 0 ? std::to_string(max_repeats) : "unlimited") << " repeats" << std::endl;
+        std::cout << "Jobs:                 " << jobs << (isolate ? " worker processes" : "") << std::endl;
+        if (readahead_mb > 0)
+            std::cout << "Read-ahead:           " << readahead_mb << " MB" << std::endl;
+        if (shard_n > 0)
+            std::cout << "Shard:                " << shard_k << " of " << shard_n << std::endl;
+        if (!journal_filename.empty())
+            std::cout << "Journal:              " << journal_filename << " (" << journal.size() << " PDFs completed)" << std::endl;
+        if (!history_filename.empty())
+            std::cout << "History:              " << history_filename << " (" << scheduler.size() << " PDFs)" << std::endl;
+        if (!cache_folder.empty())
+            std::cout << "Result cache:         " << cache_folder << std::endl;
+        if (!stats_filename.empty())
+            std::cout << "Corpus statistics:    " << stats_filename << std::endl;
+        if (!store_folder.empty())
+            std::cout << "Report store:         " << store_folder << std::endl;
+        if (!metrics_filename.empty())
+            std::cout << "Metrics:              " << metrics_filename << std::endl;
+        if (isolate)
+            std::cout << "Worker limits:        " << (worker_timeout > 0 ? std::to_string(worker_timeout) : "unlimited") << " seconds, "
+                      << (worker_memory > 0 ? std::to_string(worker_memory) : "unlimited") << " MB" << std::endl;
         if (pdf_password.size() == 0)
             std::cout << "Password:             <none>" << std::endl;
         else
@@ -497,120 +681,574 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // All --pdf reports are compressed with --compress
+    ofs.set_compression(compress_level);
+
+    // Merge corpus statistics files, e.g. from --shard runs
+    if (sarge.getFlag("merge-stats", s)) {
+        for (auto& f : split(s, ',')) {
+            if (!corpus_stats.merge_file(f)) {
+                std::cerr << COLOR_ERROR << "--merge-stats file '" << f << "' is not a valid statistics file!" << COLOR_RESET;
+                pdf_io.shutdown();
+                return -1;
+            }
+        }
+        if (stats_filename.empty())
+            corpus_stats.write(std::cout);
+        else {
+            std::ofstream stats_file(stats_filename, std::ofstream::out | std::ofstream::trunc);
+            corpus_stats.write(stats_file);
+        }
+        pdf_io.shutdown();
+        return 0;
+    }
+
+    // Extract reports from a --store folder: a single PDF or "@file.txt" with a list of PDFs.
+    // The index is only read once however many reports are extracted.
+    if (sarge.getFlag("extract", s)) {
+        if (store_folder.empty()) {
+            std::cerr << COLOR_ERROR << "--extract requires --store!" << COLOR_RESET;
+            pdf_io.shutdown();
+            return -1;
+        }
+        std::vector<std::string> extract_list;
+        if ((s.size() > 0) && (s[0] == '@')) {
+            std::ifstream extract_filelist(fs::absolute(s.substr(1, s.size() - 1)).lexically_normal());
+            while (std::getline(extract_filelist, s)) {
+                s = trim(s);
+                if ((s.size() > 0) && (s[0] != '#'))
+                    extract_list.push_back(s);
+            }
+        }
+        else
+            extract_list.push_back(s);
+
+        CReportStore    extract_store;
+        bool            found = extract_store.load_index(store_folder);
+        if (!found)
+            std::cerr << COLOR_ERROR << "--store " << store_folder << " has no index!" << COLOR_RESET;
+        else {
+            // Reports are written one after the other
+            std::ofstream rpt;
+            if (!save_path.empty())
+                rpt.open(save_path, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+            for (const auto& pdf : extract_list)
+                if (!extract_store.extract(pdf, (save_path.empty() ? std::cout : rpt))) {
+                    std::cerr << COLOR_ERROR << "--extract '" << pdf << "' was not found in --store " << store_folder << COLOR_RESET;
+                    found = false;
+                }
+        }
+        pdf_io.shutdown();
+        return (found ? 0 : -1);
+    }
+
+    // Options for checking each PDF
+    arl_options opts;
+    opts.force_version = force_version;
+    opts.extns = supported_extns;
+    opts.password = pdf_password;
+    opts.terse = terse;
+    opts.debug_mode = debug_mode;
+    opts.low_memory = low_memory;
+    opts.max_objects = max_objects;
+    opts.max_seconds = max_seconds;
+    opts.max_depth = max_depth;
+    opts.max_repeats = max_repeats;
+    opts.format = format;
+
+    // Long-running validation server, with the Arlington model and a PDF SDK instance per worker kept warm
+    if (sarge.getFlag("serve", s)) {
+        CArlingtonValidator         serve_validator(grammar_folder);
+        serve_validator.load_all();
+        std::vector<std::unique_ptr<ArlingtonPDFSDK>> sdks;
+        for (unsigned int i = 0; i < jobs; i++) {
+            sdks.emplace_back(new ArlingtonPDFSDK());
+            sdks.back()->initialize();
+        }
+
+        serve_request defaults;
+        defaults.force_version = force_version;
+        defaults.extns = supported_extns;
+        defaults.terse = terse;
+        defaults.debug_mode = debug_mode;
+        defaults.password = pdf_password;
+        defaults.format = format;
+        retval = serve(fs::absolute(s).lexically_normal(), jobs, defaults,
+            [&](const unsigned int worker, const serve_request& req, std::ostream& rpt) {
+                arl_options req_opts = opts;
+                req_opts.force_version = req.force_version;
+                req_opts.extns = req.extns;
+                req_opts.password = req.password;
+                req_opts.terse = req.terse;
+                req_opts.debug_mode = req.debug_mode;
+                req_opts.format = req.format;
+                return process_single_pdf(req.pdf_file, serve_validator, *sdks[worker], rpt, req_opts, nullptr, nullptr);
+            });
+
+        for (auto& sdk : sdks)
+            sdk->shutdown();
+        pdf_io.shutdown();
+        return retval;
+    }
+
+    // Client for the validation server: PDFs are sent over --jobs connections, one request at a time on each
+    if (sarge.getFlag("connect", s) && (input_list.size() > 0)) {
+        std::vector<fs::path> pdfs;
+        for (auto& input_file : input_list) {
+            if (fs::is_directory(input_file)) {
+                for (const auto& entry : fs::recursive_directory_iterator(input_file, fs::directory_options::skip_permission_denied))
+                    if (entry.is_regular_file() && (all_files || has_pdf_extension(entry.path())))
+                        pdfs.push_back(entry.path());
+            }
+            else
+                pdfs.push_back(input_file);
+        }
+
+        std::string options;
+        if (!force_version.empty())
+            options += "force=" + force_version + "\n";
+        if (supported_extns.size() > 0) {
+            options += "extensions=";
+            for (size_t i = 0; i < supported_extns.size(); i++)
+                options += supported_extns[i] + ((i < (supported_extns.size() - 1)) ? "," : "");
+            options += "\n";
+        }
+        if (terse)
+            options += "brief=1\n";
+        if (debug_mode)
+            options += "debug=1\n";
+        if (pdf_password.size() > 0)
+            options += "password=" + ToUtf8(pdf_password) + "\n";
+        if (format == ReportFormat::JSONL)
+            options += "format=jsonl\n";
+
+        retval = serve_client(fs::absolute(s).lexically_normal(), pdfs, (sarge.exists("out") ? save_path : fs::path()), rpt_extension, options, jobs);
+        pdf_io.shutdown();
+        return retval;
+    }
+
+    // A single PDF read from stdin into memory
+    if (input_is_stdin) {
+#if defined(_WIN32) || defined(WIN32)
+        (void)_setmode(_fileno(stdin), _O_BINARY);
+#endif // _WIN32 || WIN32
+        std::string pdf_data((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        fs::path    rptfile;
+        if (!save_path.empty())
+            rptfile = is_folder(save_path) ? (save_path / ("stdin" + rpt_extension)) : save_path;
+        std::cout << "Processing <stdin> to ";
+        if (rptfile.empty())
+            std::cout << "stdout ";
+        else {
+            std::cout << rptfile << " ";
+            ofs.open(rptfile, std::ofstream::out | std::ofstream::trunc);
+        }
+        if (!dryrun) {
+            CArlingtonValidator validator(grammar_folder);
+            if (!validator.validate_buffer(pdf_io, pdf_data.data(), pdf_data.size(), "<stdin>", opts, (rptfile.empty() ? std::cout : ofs))) {
+                std::cout << COLOR_ERROR << "- FATAL ERROR!" << COLOR_RESET_NO_EOL;
+                retval = -1;
+            }
+        }
+        if (low_memory && !dryrun)
+            std::cout << "(peak memory " << get_peak_memory_mb() << " MB) ";
+        if (!rptfile.empty())
+            ofs.close();
+        std::cout << std::endl << "DONE - 1 files processed" << std::endl;
+        pdf_io.shutdown();
+        return retval;
+    }
+
     if (input_list.size() == 0) {
         std::cerr << COLOR_ERROR << "no PDF file, folder, or file list was specified via --pdf! Or missing --validate or --checkdva." << COLOR_RESET;
         pdf_io.shutdown();
         return -1;
     }
 
-    try {
-        for (auto& input_file : input_list) {
-            fs::recursive_directory_iterator dir_iter;
-            fs::directory_entry              entry;
-            bool is_folder = false;
-            if (fs::is_directory(input_file)) {
+    CArlingtonValidator         validator(grammar_folder);  // shared by all PDFs and all --jobs threads
+    std::unique_ptr<CResultCache> result_cache;     // --cache
+    CPDFJobQueue                job_queue;          // --jobs: PDFs waiting for a worker thread
+    std::vector<std::thread>    workers;            // --jobs: worker threads
+    std::vector<double>         worker_busy;        // --jobs/--isolate: seconds each worker spent checking PDFs
+    std::mutex                  console_mutex;      // --jobs: protects std::cout and retval
+    std::set<fs::path>          assigned_rptfiles;  // --jobs/--isolate: report files already assigned during this run
+    std::vector<pdf_job>        isolated_jobs;      // --isolate: PDFs to check in worker processes
+    CPDFReadAhead               readahead(dryrun ? 0 : (uintmax_t)readahead_mb * 1024 * 1024);  // --readahead
+    uintmax_t                   total_bytes = 0;    // total size of all PDFs checked
+    auto                        start_time = std::chrono::steady_clock::now();
+    const bool                  collect_stats = !stats_filename.empty() && !dryrun;  // --stats
+    CReportStore                store;              // --store
+    const bool                  use_store = !store_folder.empty() && !dryrun;
+    CRunMetrics                 metrics;            // --metrics
+
+    // Everything other than the PDF itself that can change a report is part of the cache key.
+    // The content of the Arlington TSV files is hashed by CResultCache, so their folder is not part of it.
+    if (!cache_folder.empty() && !dryrun) {
+        std::ostringstream  cache_options;
+        cache_options << TestGrammar_VERSION << "|" << pdf_io.get_version_string() << "|" << force_version << "|";
+        for (auto& e : supported_extns)
+            cache_options << e << ",";
+        cache_options << "|" << terse << debug_mode << no_color << (int)format << "|" << ToUtf8(pdf_password) << "|"
+                      << max_objects << "|" << max_seconds << "|" << max_depth << "|" << max_repeats;
+        result_cache.reset(new CResultCache(cache_folder, grammar_folder, cache_options.str()));
+        if (!result_cache->is_valid()) {
+            std::cerr << COLOR_ERROR << "--cache " << cache_folder << " could not be used!" << COLOR_RESET;
+            result_cache.reset();
+        }
+    }
+
+    // Worker threads each use their own PDF SDK instance, share the grammar and write their own report files.
+    // Console output for each PDF is written as a single line once that PDF has been checked.
+    // --shard and --journal: true if a PDF is to be skipped. The shard is chosen by the path relative
+    // to the --pdf folder (or just the filename for individual PDFs) so it is the same on all machines.
+    auto skip_input = [&](const fs::path& pdf_file, const fs::path& input_root, const bool in_folder) {
+        if (shard_n > 0) {
+            fs::path rel = in_folder ? pdf_file.lexically_relative(input_root) : pdf_file.filename();
+            if (!in_shard(rel.generic_string(), shard_k, shard_n))
+                return true;
+        }
+        if (journal.is_done(pdf_file)) {
+            skipped++;
+            return true;
+        }
+        return false;
+    };
+
+    bool use_supervisor = isolate && !dryrun && (!save_path.empty() || use_store) && !input_is_a_file;
+    bool use_workers = !use_supervisor && (jobs > 1) && !dryrun && (!save_path.empty() || use_store) && !input_is_a_file;
+
+    // --store: each worker thread appends to its own segment. Worker processes send their reports
+    // back so that only the supervisor appends to the store.
+    if (use_store && !store.open(store_folder, rpt_extension, (use_workers ? jobs : 1))) {
+        std::cerr << COLOR_ERROR << "--store " << store_folder << " could not be used!" << COLOR_RESET;
+        pdf_io.shutdown();
+        return -1;
+    }
+
+    // --metrics: objects are counted in shared memory so that worker processes can add to them
+    if (!metrics_filename.empty() && !dryrun) {
+        if (metrics.start(metrics_filename, ((use_workers || use_supervisor) ? jobs : 1)))
+            opts.objects_checked = metrics.get_object_counter();
+        else
+            std::cerr << COLOR_ERROR << "--metrics " << metrics_filename << " could not be written!" << COLOR_RESET;
+    }
+
+    // --store: checks a PDF into memory and appends the report to the segment of a writer.
+    // stored is false if the report could not be written to the store.
+    auto check_into_store = [&](const unsigned int writer, const fs::path& pdf_file, ArlingtonPDFSDK& sdk, arl_findings& findings, bool& stored) {
+        std::ostringstream rpt;
+        bool ok = process_single_pdf(pdf_file, validator, sdk, rpt, opts, result_cache.get(), &findings);
+        stored = store.append(writer, pdf_file, rpt.str(), (ok ? "OK" : "FATAL"), findings);
+        return ok;
+    };
+
+    if (use_workers) {
+        worker_busy.assign(jobs, 0.0);
+        for (unsigned int i = 0; i < jobs; i++)
+            workers.emplace_back([&, i]() {
+                ArlingtonPDFSDK worker_sdk;
                 try {
-                    // Attempt first as a folder - will throw a C++ exception if invalid
-                    dir_iter = fs::recursive_directory_iterator(input_file, fs::directory_options::skip_permission_denied);
-                    entry = *dir_iter++;
-                    is_folder = true;
+                    worker_sdk.initialize();
+                }
+                catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(console_mutex);
+                    std::cerr << COLOR_ERROR << "EXCEPTION " << e.what() << COLOR_RESET;
+                    retval = -1;
+                    return;
                 }
-                catch (...) {
-                    // had an error as a folder name, try anyway as a normal file
-                    entry = fs::directory_entry(input_file);
-                    is_folder = false;
+                pdf_job job;
+                while (job_queue.pop(job)) {
+                    auto job_start = std::chrono::steady_clock::now();
+                    metrics.set_current(i, job.pdf_file);
+                    arl_findings findings;
+                    bool ok;
+                    bool stored = true;
+                    if (use_store) {
+                        job.rptfile = store.get_segment(i);
+                        ok = check_into_store(i, job.pdf_file, worker_sdk, findings, stored);
+                    }
+                    else {
+                        CReportFile rpt(job.rptfile, std::ofstream::out | std::ofstream::trunc, compress_level);
+                        ok = process_single_pdf(job.pdf_file, validator, worker_sdk, rpt, opts, result_cache.get(), (collect_stats ? &findings : nullptr));
+                        rpt.close();
+                    }
+                    if (collect_stats)
+                        corpus_stats.add_pdf(findings, ok);
+                    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - job_start).count();
+                    worker_busy[i] += secs;
+                    metrics.set_current(i, "");
+                    metrics.finished(job.size, ok);
+
+                    journal.record(job.pdf_file, (ok ? "OK" : "FATAL"), job.rptfile, secs, job.size);
+                    readahead.done(job.pdf_file);
+
+                    std::lock_guard<std::mutex> lock(console_mutex);
+                    std::cout << "Processing " << job.pdf_file << " to " << job.rptfile << " ";
+                    if (!ok) {
+                        std::cout << COLOR_ERROR << "- FATAL ERROR!" << COLOR_RESET_NO_EOL;
+                        retval = -1;
+                    }
+                    if (!stored) {
+                        std::cout << COLOR_ERROR << "- report could not be written to --store!" << COLOR_RESET_NO_EOL;
+                        retval = -1;
+                    }
+                    if (low_memory)
+                        std::cout << "(peak memory " << get_peak_memory_mb() << " MB) ";
+                    std::cout << std::endl;
                 }
+                worker_sdk.shutdown();
+            });
+    }
+
+    try {
+        CPDFExclusions  exclusion_matcher(exclusions);                  // --exclude, compiled once
+        // finds PDFs on a background thread. --jobs and --isolate check the most costly PDFs first,
+        // so their PDFs are read ahead once they are queued rather than in traversal order.
+        CPDFEnumerator  enumerator(input_list, all_files, ((use_workers || use_supervisor) ? nullptr : &readahead));
+        pdf_input       input;
+        while (enumerator.next(input)) {
+            if (!input.error.empty()) {
+                std::lock_guard<std::mutex> lock(console_mutex);
+                retval = -1;
+                std::cerr << std::endl << COLOR_ERROR << "EXCEPTION " << input.error << COLOR_RESET;
+                continue;
             }
-            else {
-                entry = fs::directory_entry(input_file);
-                is_folder = false;
+            if (!input.exists) {
+                std::lock_guard<std::mutex> lock(console_mutex);
+                std::cout << COLOR_ERROR << "Invalid PDF file/folder " << input.pdf_file.lexically_normal() << COLOR_RESET;
+                continue;
+            }
+            if (skip_input(input.pdf_file, input.input_root, input.in_folder)) {
+                readahead.done(input.pdf_file);
+                continue;
             }
 
+            bool queued = false;    // for a worker thread or worker process
             try {
-                do {
-                    if (entry.is_regular_file() && (all_files || iequals(entry.path().extension().string(), ".pdf"))) {
-                        fs::path  rptfile;
-                        if (!save_path.empty()) {
-                            rptfile = save_path / entry.path().stem();
-                            if (no_color)
-                                rptfile.replace_extension(".txt");  // change .pdf to .txt for uncolorized output
-                            else
-                                rptfile.replace_extension(".ansi"); // change .pdf to .ansi if colorized output
-                            if (!clobber) {
-                                // if rptfile already exists then try a different filename by continuously appending underscores...
-                                while (fs::exists(rptfile)) {
-                                    rptfile.replace_filename(rptfile.stem().string() + "_");
-                                    if (no_color)
-                                        rptfile.replace_extension(".txt");  // change .pdf to .txt for uncolorized output
-                                    else
-                                        rptfile.replace_extension(".ansi"); // change .pdf to .ansi if colorized output
-                                }
-                            }
-                            rptfile = fs::absolute(rptfile).lexically_normal();
+                const fs::path  pdf_file = input.pdf_file.lexically_normal();
+                fs::path        rptfile;
+                if (use_store)
+                    rptfile = store.get_segment(0);     // worker threads use their own segment
+                else if (!save_path.empty() && store_folder.empty()) {
+                    rptfile = save_path / pdf_file.stem();
+                    rptfile.replace_extension(rpt_extension);   // change .pdf to .txt, .ansi or .jsonl (+ .gz)
+                    if (!clobber || (assigned_rptfiles.count(rptfile) > 0)) {
+                        // if rptfile already exists then try a different filename by continuously appending underscores...
+                        while (fs::exists(rptfile) || (assigned_rptfiles.count(rptfile) > 0)) {
+                            std::string name = rptfile.filename().string();
+                            rptfile.replace_filename(name.substr(0, name.size() - rpt_extension.size()) + "_" + rpt_extension);
                         }
+                    }
+                    rptfile = fs::absolute(rptfile).lexically_normal();
+                }
 
-                        bool exclude_for_processing = false;
-                        for (auto& excl : exclusions) {
-                            s = entry.path().lexically_normal().string();
-                            if (s.find(excl) != std::string::npos) {
-                                exclude_for_processing = true;
-                            }
-#if defined(_WIN32) || defined(WIN32)
-                            // Microsoft Windows path separator is a BACKSLASH which is very annoying in C++!
-                            s = std::regex_replace(s, std::regex("\\\\"), "/");
-                            if (s.find(excl) != std::string::npos) {
-                                exclude_for_processing = true;
-                            }
-#endif // _WIN32/WIN32
-                            else {
-                                try {
-                                    if (std::regex_match(s, std::regex(excl))) {
-                                        exclude_for_processing = true;
-                                    }
-                                }
-                                catch (...) { // const std::regex_error& e 
-                                    // ignore all exceptions from regex creation and process PDF file
-                                }
-                            }
-                        } // for
-
-                        if (!exclude_for_processing) {
-                            std::cout << "Processing " << entry.path().lexically_normal() << " to ";
-                            if (rptfile.empty())
-                                std::cout << "stdout ";
-                            else {
-                                std::cout << rptfile << " ";
-                                ofs.open(rptfile, std::ofstream::out | std::ofstream::trunc);
-                            }
-                            count++;
-                            if (!dryrun)
-                                if (!process_single_pdf(entry.path().lexically_normal(), grammar_folder, pdf_io, (rptfile.empty() ? std::cout : ofs) , terse, debug_mode, force_version, supported_extns, pdf_password)) {
-                                    std::cout << COLOR_ERROR << "- FATAL ERROR!" << COLOR_RESET_NO_EOL;
-                                    retval = -1;
-                                }
-                            if (!rptfile.empty())
-                                ofs.close();
-                        }
-                        else {
-                            std::cout << COLOR_INFO << "Excluded " << entry.path().lexically_normal() << COLOR_RESET_NO_EOL;
-                        }
-                        std::cout << std::endl;
+                bool exclude_for_processing = exclusion_matcher.is_excluded(pdf_file);
+
+                if (!exclude_for_processing && !dryrun) {
+                    total_bytes += input.size;
+                    metrics.files_found++;
+                }
+
+                if (!exclude_for_processing && (use_workers || use_supervisor)) {
+                    // Create the report file now so later PDFs with the same name get unique report filenames
+                    if (!use_store) {
+                        ofs.open(rptfile, std::ofstream::out | std::ofstream::trunc);
+                        ofs.close();
+                        assigned_rptfiles.insert(rptfile);
                     }
-                    else if (!entry.exists()) {
-                        std::cout << COLOR_ERROR << "Invalid PDF file/folder " << entry.path().lexically_normal() << COLOR_RESET;
+                    count++;
+                    queued = true;
+                    pdf_job job = { pdf_file, rptfile, input.size, scheduler.estimate(pdf_file, input.size) };
+                    if (use_supervisor)
+                        isolated_jobs.push_back(job);
+                    else {
+                        readahead.add(job.pdf_file, job.size, job.cost);
+                        job_queue.push(job);
                     }
-
-                    if (is_folder) {
-                        // Recursively processing a folder so get next file
-                        entry = *dir_iter++;
+                }
+                else if (!exclude_for_processing) {
+                    std::cout << "Processing " << pdf_file << " to ";
+                    if (!store_folder.empty())
+                        std::cout << (use_store ? rptfile : store_folder) << " ";
+                    else if (rptfile.empty())
+                        std::cout << "stdout ";
+                    else {
+                        std::cout << rptfile << " ";
+                        ofs.open(rptfile, std::ofstream::out | std::ofstream::trunc);
                     }
-                } while (dir_iter != fs::end(dir_iter));
+                    count++;
+                    if (!dryrun) {
+                        auto job_start = std::chrono::steady_clock::now();
+                        arl_findings findings;
+                        bool ok;
+                        bool stored = true;
+                        metrics.set_current(0, pdf_file);
+                        if (use_store)
+                            ok = check_into_store(0, pdf_file, pdf_io, findings, stored);
+                        else
+                            ok = process_single_pdf(pdf_file, validator, pdf_io, (rptfile.empty() ? std::cout : ofs), opts, result_cache.get(), (collect_stats ? &findings : nullptr));
+                        if (collect_stats)
+                            corpus_stats.add_pdf(findings, ok);
+                        metrics.set_current(0, "");
+                        metrics.finished(input.size, ok);
+                        if (!rptfile.empty() && !use_store)
+                            ofs.flush();
+                        journal.record(pdf_file, (ok ? "OK" : "FATAL"), rptfile, std::chrono::duration<double>(std::chrono::steady_clock::now() - job_start).count(), input.size);
+                        if (!ok) {
+                            std::cout << COLOR_ERROR << "- FATAL ERROR!" << COLOR_RESET_NO_EOL;
+                            retval = -1;
+                        }
+                        if (!stored) {
+                            std::cout << COLOR_ERROR << "- report could not be written to --store!" << COLOR_RESET_NO_EOL;
+                            retval = -1;
+                        }
+                    }
+                    if (low_memory && !dryrun)
+                        std::cout << "(peak memory " << get_peak_memory_mb() << " MB) ";
+                    if (!rptfile.empty() && !use_store)
+                        ofs.close();
+                    std::cout << std::endl;
+                }
+                else {
+                    std::lock_guard<std::mutex> lock(console_mutex);
+                    std::cout << COLOR_INFO << "Excluded " << pdf_file << COLOR_RESET;
+                }
             }
             catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(console_mutex);
                 retval = -1;
                 std::cerr << std::endl << COLOR_ERROR << "EXCEPTION " << e.what() << COLOR_RESET;
             }
+            if (!queued)
+                readahead.done(input.pdf_file);
         }
+        metrics.all_found = true;
+
+        // Wait for all worker threads to finish
+        job_queue.close();
+        for (auto& w : workers)
+            w.join();
+        workers.clear();
+
+        if (use_supervisor) {
+            // Load the full grammar once so it is shared copy-on-write by all worker processes
+            validator.load_all();
+            // Most costly PDFs first so they do not decide the total time
+            std::stable_sort(isolated_jobs.begin(), isolated_jobs.end(), [](const pdf_job& a, const pdf_job& b) { return a.cost > b.cost; });
+            for (auto& job : isolated_jobs)
+                readahead.add(job.pdf_file, job.size, job.cost);
+            CPDFSupervisor supervisor(jobs, worker_timeout, worker_memory);
+            supervisor.on_job = [&](const size_t w, const pdf_job* job) {
+                metrics.set_current((unsigned int)w, (job != nullptr) ? job->pdf_file : fs::path());
+            };
+            bool ok = supervisor.run(isolated_jobs,
+                [&](const pdf_job& job, std::string& result) {
+                    arl_findings findings;
+                    bool ok;
+                    if (use_store) {
+                        // result is the size of the findings, the findings and the report
+                        std::ostringstream rpt;
+                        ok = process_single_pdf(job.pdf_file, validator, pdf_io, rpt, opts, result_cache.get(), &findings);
+                        std::string f = findings_to_string(findings);
+                        result = std::to_string(f.size()) + "\n" + f + rpt.str();
+                    }
+                    else {
+                        CReportFile rpt(job.rptfile, std::ofstream::out | std::ofstream::trunc, compress_level);
+                        ok = process_single_pdf(job.pdf_file, validator, pdf_io, rpt, opts, result_cache.get(), (collect_stats ? &findings : nullptr));
+                        rpt.close();
+                        if (collect_stats)
+                            result = findings_to_string(findings);
+                    }
+                    return ok;
+                },
+                [&](const pdf_job& job, bool ok, unsigned int peak_mb, const std::string& failure, double secs, const std::string& result) {
+                    arl_findings findings;
+                    std::string  report;
+                    if (use_store) {
+                        size_t nl = result.find('\n');
+                        size_t len = (nl == std::string::npos) ? 0 : strtoul(result.c_str(), nullptr, 10);
+                        if ((nl != std::string::npos) && (len <= result.size() - nl - 1)) {
+                            (void)findings_from_string(result.substr(nl + 1, len), findings);
+                            report = result.substr(nl + 1 + len);
+                        }
+                    }
+                    else if (collect_stats)
+                        (void)findings_from_string(result, findings);
+                    if (!failure.empty())
+                        add_finding(&findings, ArlMessageCode::WorkerFailed, "", "");
+                    if (collect_stats)
+                        corpus_stats.add_pdf(findings, ok);
+                    if (!failure.empty()) {
+                        // Replace whatever partial report the worker process wrote
+                        std::ostringstream rpt;
+                        if (format == ReportFormat::JSONL) {
+                            write_jsonl_message(rpt, ArlMessageCode::Begin, "", "", nullptr, 0, "", fs::absolute(job.pdf_file).lexically_normal().string());
+                            write_jsonl_message(rpt, ArlMessageCode::WorkerFailed, "", "", nullptr, 0, "", failure);
+                            write_jsonl_message(rpt, ArlMessageCode::End, "", "", nullptr, 0, "");
+                        }
+                        else {
+                            rpt << "BEGIN - TestGrammar " << TestGrammar_VERSION << " " << pdf_io.get_version_string() << std::endl;
+                            rpt << "Arlington TSV data: " << grammar_folder << std::endl;
+                            rpt << "PDF: " << fs::absolute(job.pdf_file).lexically_normal() << std::endl;
+                            rpt << COLOR_ERROR << failure << COLOR_RESET;
+                            rpt << "END" << std::endl;
+                        }
+                        report = rpt.str();
+                        if (!use_store) {
+                            CReportFile rpt_file(job.rptfile, std::ofstream::out | std::ofstream::trunc, compress_level);
+                            rpt_file << report;
+                        }
+                    }
+                    const char* status = (!failure.empty() ? "FAILED" : (ok ? "OK" : "FATAL"));
+                    metrics.finished(job.size, ok, !failure.empty(), peak_mb);
+                    bool stored = !use_store || store.append(0, job.pdf_file, report, status, findings);
+                    journal.record(job.pdf_file, status, job.rptfile, secs, job.size);
+                    readahead.done(job.pdf_file);
+                    std::cout << "Processing " << job.pdf_file << " to " << job.rptfile << " ";
+                    if (!failure.empty())
+                        std::cout << COLOR_ERROR << "- FATAL ERROR! " << failure << COLOR_RESET_NO_EOL;
+                    else if (!ok)
+                        std::cout << COLOR_ERROR << "- FATAL ERROR!" << COLOR_RESET_NO_EOL;
+                    if (!stored)
+                        std::cout << COLOR_ERROR << "- report could not be written to --store!" << COLOR_RESET_NO_EOL;
+                    if (!ok || !stored)
+                        retval = -1;
+                    if (low_memory && failure.empty())
+                        std::cout << "(peak memory " << peak_mb << " MB) ";
+                    std::cout << std::endl;
+                });
+            if (!ok) {
+                std::cerr << COLOR_ERROR << "failed to start worker processes" << COLOR_RESET;
+                retval = -1;
+            }
+            worker_busy = supervisor.busy_secs;
+        }
+
+        if ((sarge.exists("jobs") || use_supervisor) && !dryrun) {
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            if (secs <= 0.0)
+                secs = 0.001;
+            double mb = (double)total_bytes / (1024.0 * 1024.0);
+            std::cout << "Throughput: " << count << " files (" << std::fixed << std::setprecision(1) << mb << " MB) in " << secs << " seconds = "
+                      << std::setprecision(2) << (count / secs) << " files/s, " << (mb / secs) << " MB/s using " << ((use_workers || use_supervisor) ? jobs : 1) << (use_supervisor ? " worker process(es)" : " job(s)") << std::endl;
+            // Idle time is waiting for PDFs to be found and, at the end, for other workers to finish
+            for (size_t i = 0; i < worker_busy.size(); i++)
+                std::cout << "Worker " << (i + 1) << ": busy " << std::setprecision(1) << worker_busy[i] << " seconds, idle " << std::max(0.0, secs - worker_busy[i]) << " seconds" << std::endl;
+            std::cout.unsetf(std::ios_base::floatfield);
+        }
+        if ((result_cache != nullptr) && !use_supervisor)
+            std::cout << "Result cache: " << result_cache->hits << " hits, " << result_cache->misses << " misses" << std::endl;
+        if (readahead.is_enabled())
+            std::cout << "Read-ahead: " << readahead.files << " files (" << std::fixed << std::setprecision(1) << ((double)readahead.bytes / (1024.0 * 1024.0)) << " MB)" << std::endl;
+        std::cout.unsetf(std::ios_base::floatfield);
+        if (skipped > 0)
+            std::cout << skipped << " files skipped as already completed in journal " << journal_filename << std::endl;
+        if (collect_stats) {
+            std::ofstream stats_file(stats_filename, std::ofstream::out | std::ofstream::trunc);
+            corpus_stats.write(stats_file);
+            std::cout << "Corpus statistics of " << corpus_stats.size() << " files written to " << stats_filename << std::endl;
+        }
+        metrics.stop();     // final metrics
         std::cout << "DONE - " << count << " files processed" << std::endl;
     }
     catch (const std::exception& e) {
@@ -618,6 +1256,10 @@ int main(int argc, char* argv[]) {
         std::cerr << COLOR_ERROR << "EXCEPTION " << e.what() << COLOR_RESET;
     }
 
+    job_queue.close();
+    for (auto& w : workers)
+        w.join();
+
     if (ofs.is_open())
         ofs.close();
     pdf_io.shutdown();
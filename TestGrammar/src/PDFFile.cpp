@@ -45,8 +45,14 @@ namespace fs = std::filesystem;
 #undef PP_AST_DEBUG
 
 
-/// @brief Constructor. Calculates some details about the PDF file
-CPDFFile::CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std::string& forced_ver, const std::vector<std::string>& extns)
+/// @brief Constructor. Calculates some details about the already opened PDF file
+///
+/// @param[in] pdf_file     PDF filename (or name of an in-memory PDF)
+/// @param[in] pdf_sdk      PDF SDK with the PDF already open
+/// @param[in] forced_ver   forced PDF version, "exact" or empty string
+/// @param[in] extns        list of extension names to support
+/// @param[in] file_size    size of the PDF in bytes
+CPDFFile::CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std::string& forced_ver, const std::vector<std::string>& extns, const size_t file_size)
     : pdf_filename(pdf_file), pdfsdk(pdf_sdk), trailer_size(INT_MAX),
       latest_feature_version("1.0"), deprecated(false), fully_implemented(true), exact_version_compare(false)
 {
@@ -60,8 +66,8 @@ CPDFFile::CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std
     // Copy across the list of supported extensions
     extensions = extns;
 
-    // Get physical file size, reduced to an int for simplicity
-    filesize_bytes = (int)fs::file_size(pdf_filename);
+    // Physical file size, reduced to an int for simplicity
+    filesize_bytes = (int)file_size;
 
     // Get PDF version from file header.  No sanity checking is done.
     pdf_header_version = pdfsdk.get_pdf_version();
@@ -96,6 +102,96 @@ CPDFFile::CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std
 }
 
 
+/// @brief Destructor. Releases page tree nodes held by the inheritance cache.
+CPDFFile::~CPDFFile()
+{
+    for (auto& n : inherited_nodes)
+        delete n;
+    inherited_nodes.clear();
+    inherited_cache.clear();
+}
+
+
+/// @brief Releases a parsed PDF object in the PDF SDK once all wrappers referencing it have been deleted.
+/// Page tree nodes held by the inheritance cache are kept.
+///
+/// @param[in] obj_nbr   object number (> 0)
+void CPDFFile::release_object(const int obj_nbr) {
+    if (inherited_obj_nbrs.find(obj_nbr) == inherited_obj_nbrs.end())
+        pdfsdk.release_object(obj_nbr);
+}
+
+
+/// @brief Locates an inheritable key by walking the /Parent chain of a page tree node (but NOT obj itself).
+/// Results are remembered per page tree node so that sibling pages (and their ancestors) resolve
+/// against the nearest cached ancestor rather than re-walking to the root. Direct (non-indirect) nodes
+/// are never cached.
+///
+/// @param[in]  obj    the starting dictionary (typically a Page or Pages object)
+/// @param[in]  key    the inheritable key name
+/// @param[out] depth  number of /Parent nodes examined. > 250 if a malformed /Parent chain was abandoned.
+///
+/// @returns nullptr if 'key' is NOT located via inheritance, otherwise the PDF object which matches BY KEYNAME! Caller must free.
+ArlPDFObject* CPDFFile::get_inherited_value(ArlPDFDictionary* obj, const std::wstring& key, int& depth) {
+    assert(obj != nullptr);
+    const std::string         k = ";" + ToUtf8(key);
+    std::vector<std::string>  walked;          // cache keys of nodes examined, bottom-up
+    ArlPDFDictionary*         holder = nullptr;
+    ArlPDFObject*             key_obj = nullptr;
+    bool                      cacheable = true;
+    bool                      from_cache = false;
+
+    depth = 0;
+    ArlPDFObject* parent = obj->get_value(L"Parent");
+    while ((parent != nullptr) && (parent->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
+        ArlPDFDictionary* parent_dict = (ArlPDFDictionary*)parent;
+        if (depth > 250) {
+            delete parent;
+            return nullptr; // caller reports - never cache malformed /Parent chains
+        }
+        if (parent_dict->is_indirect_ref()) {
+            std::string id = parent_dict->get_hash_id() + k;
+            auto it = inherited_cache.find(id);
+            if (it != inherited_cache.end()) {
+                holder = it->second;
+                from_cache = true;
+                delete parent;
+                break;
+            }
+            walked.push_back(id);
+        }
+        else
+            cacheable = false;
+
+        key_obj = parent_dict->get_value(key);
+        if (key_obj != nullptr) {
+            holder = parent_dict;
+            break;
+        }
+        parent = parent_dict->get_value(L"Parent");
+        delete parent_dict;
+        depth++;
+    }
+    if (holder == nullptr)
+        delete parent; // not a dictionary (or nullptr)
+
+    if (cacheable) {
+        for (auto& id : walked)
+            inherited_cache[id] = holder;
+        if ((holder != nullptr) && !from_cache) {
+            inherited_nodes.push_back(holder);
+            inherited_obj_nbrs.insert(holder->get_object_number());
+        }
+    }
+
+    if (from_cache)
+        return (holder != nullptr) ? holder->get_value(key) : nullptr;
+    if (!cacheable)
+        delete holder;
+    return key_obj;
+}
+
+
 /// @brief Split an Arlington key path (e.g. Catalog::Names::Dests) into a vector of keys.
 /// 
 /// @param[in]   key  an Arlington key which might be a key path
@@ -1230,24 +1326,33 @@ bool CPDFFile::check_key_value(ArlPDFDictionary* dict, const std::wstring& key,
 /// @brief Work out which PDF version to use between PDF header, DocCatalog::Version and command line.
 /// Updates pdf_version field. Always returns a valid PDF version. Default version is "2.0".
 /// 
-/// @param[in,out] ofs    output stream for messages
-/// @returns              Always a valid 3-char version string ("1.0", "1.1", ..., "2.0")
-std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
+/// @param[in,out] ofs      output stream for messages
+/// @param[in]     format   report format of the messages
+/// @param[in,out] findings findings of the PDF for --stats, or nullptr
+/// @param[in,out] log      messages of the PDF for the structured API, or nullptr
+/// @returns                Always a valid 3-char version string ("1.0", "1.1", ..., "2.0")
+std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs, const ReportFormat format, arl_findings* findings, CArlMessageLog* log)
 {
     bool hdr_ok = ((pdf_header_version.size() == 3)  && FindInVector(v_ArlPDFVersions, pdf_header_version));
     bool cat_ok = ((pdf_catalog_version.size() == 3) && FindInVector(v_ArlPDFVersions, pdf_catalog_version));
 
     pdf_version.clear();
 
-    if (hdr_ok)
-        ofs << COLOR_INFO << "Header is version PDF " << pdf_header_version << COLOR_RESET;
-    else 
+    if (hdr_ok) {
+        if (report_message(ofs, format, findings, ArlMessageCode::HeaderVersion, pdf_header_version, log))
+            ofs << COLOR_INFO << "Header is version PDF " << pdf_header_version << COLOR_RESET;
+    }
+    else if (report_message(ofs, format, findings, ArlMessageCode::BadHeaderVersion, pdf_header_version, log))
         ofs << COLOR_ERROR << "Bad header is version PDF " << pdf_header_version << COLOR_RESET;
 
-    if (cat_ok)
-        ofs << COLOR_INFO << "Document Catalog/Version is PDF " << pdf_catalog_version << COLOR_RESET;
-    else if (pdf_catalog_version.size() > 0)
-        ofs << COLOR_ERROR << "Bad Document Catalog/Version is PDF " << pdf_catalog_version << COLOR_RESET;
+    if (cat_ok) {
+        if (report_message(ofs, format, findings, ArlMessageCode::CatalogVersion, pdf_catalog_version, log))
+            ofs << COLOR_INFO << "Document Catalog/Version is PDF " << pdf_catalog_version << COLOR_RESET;
+    }
+    else if (pdf_catalog_version.size() > 0) {
+        if (report_message(ofs, format, findings, ArlMessageCode::BadCatalogVersion, pdf_catalog_version, log))
+            ofs << COLOR_ERROR << "Bad Document Catalog/Version is PDF " << pdf_catalog_version << COLOR_RESET;
+    }
 
     if (hdr_ok && cat_ok) {
         // Choose latest version. Rely on ASCII for version computation
@@ -1255,7 +1360,8 @@ std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
             pdf_version = pdf_catalog_version;
         }
         else if (pdf_catalog_version[0] < pdf_header_version[0]) {
-            ofs << COLOR_ERROR << "Document Catalog major version is earlier than PDF header version! Ignoring." << COLOR_RESET;
+            if (report_message(ofs, format, findings, ArlMessageCode::CatalogMajorVersionEarlier, pdf_catalog_version, log))
+                ofs << COLOR_ERROR << "Document Catalog major version is earlier than PDF header version! Ignoring." << COLOR_RESET;
             pdf_version = pdf_header_version;
         }
         else { // major version digit is the same. Check minor digit
@@ -1263,7 +1369,8 @@ std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
                 pdf_version = pdf_catalog_version;
             }
             else if (pdf_catalog_version[2] < pdf_header_version[2]) {
-                ofs << COLOR_ERROR << "Document Catalog minor version is earlier than PDF header version! Ignoring." << COLOR_RESET;
+                if (report_message(ofs, format, findings, ArlMessageCode::CatalogMinorVersionEarlier, pdf_catalog_version, log))
+                    ofs << COLOR_ERROR << "Document Catalog minor version is earlier than PDF header version! Ignoring." << COLOR_RESET;
                 pdf_version = pdf_header_version;
             }
             else // versions are the same so fall through
@@ -1280,27 +1387,34 @@ std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
     }
     else {
         // Both must be bad - assume latest version
-        ofs << COLOR_ERROR << "Both Document Catalog and header versions are invalid or missing. Assuming PDF 2.0." << COLOR_RESET;
+        if (report_message(ofs, format, findings, ArlMessageCode::NoValidVersion, "", log))
+            ofs << COLOR_ERROR << "Both Document Catalog and header versions are invalid or missing. Assuming PDF 2.0." << COLOR_RESET;
         pdf_version = "2.0";
     }
 
     // See if XRefStream is wrong for final PDF version (i.e. before PDF 1.5)
     if (get_ptr_to_trailer()->is_xrefstm()) {
-        if ((pdf_version[0] == '1') && (pdf_version[2] < '5'))
-            ofs << COLOR_ERROR << "XRefStream is present in PDF " << pdf_version << " before introduction in PDF 1.5." << COLOR_RESET;
-        else if ((pdf_header_version[0] == '1') && (pdf_header_version[2] < '5'))
-            ofs << COLOR_WARNING << "XRefStream is present in file with header %PDF-" << pdf_header_version << " and Document Catalog Version of PDF " << pdf_catalog_version << COLOR_RESET;
+        if ((pdf_version[0] == '1') && (pdf_version[2] < '5')) {
+            if (report_message(ofs, format, findings, ArlMessageCode::XRefStreamTooEarly, pdf_version, log))
+                ofs << COLOR_ERROR << "XRefStream is present in PDF " << pdf_version << " before introduction in PDF 1.5." << COLOR_RESET;
+        }
+        else if ((pdf_header_version[0] == '1') && (pdf_header_version[2] < '5')) {
+            if (report_message(ofs, format, findings, ArlMessageCode::XRefStreamOldHeader, pdf_header_version, log))
+                ofs << COLOR_WARNING << "XRefStream is present in file with header %PDF-" << pdf_header_version << " and Document Catalog Version of PDF " << pdf_catalog_version << COLOR_RESET;
+        }
     }
 
     // To reduce lots of false warnings, snap transparency-aware PDF to 1.7
     if (!exact_version_compare && (forced_version.size() == 0) && ((pdf_version == "1.4") || (pdf_version == "1.5") || (pdf_version == "1.6"))) {
-        ofs << COLOR_INFO << "Rounding up PDF " << pdf_version << " to PDF 1.7" << COLOR_RESET;
+        if (report_message(ofs, format, findings, ArlMessageCode::RoundedUpVersion, pdf_version, log))
+            ofs << COLOR_INFO << "Rounding up PDF " << pdf_version << " to PDF 1.7" << COLOR_RESET;
         pdf_version = "1.7";
     }
 
     // Hard force to any version - expect lots of messages if this is wrong!!
     if (forced_version.size() > 0) {
-        ofs << COLOR_INFO << "Command line forced to PDF " << forced_version << COLOR_RESET;
+        if (report_message(ofs, format, findings, ArlMessageCode::ForcedVersion, forced_version, log))
+            ofs << COLOR_INFO << "Command line forced to PDF " << forced_version << COLOR_RESET;
         pdf_version = forced_version;
     }
 
@@ -1364,9 +1478,6 @@ bool CPDFFile::fn_AlwaysUnencrypted(ArlPDFObject* obj) {
     if (!t->is_encrypted())
         return true;
 
-    ArlPDFString *str = (ArlPDFString*)obj;
-    std::wstring  val = str->get_value();
-
     fully_implemented = false; /// @todo - how to determine if a string in an encrypted PDF is encrypted or unencrypted???
     return true;
 }
@@ -1385,8 +1496,8 @@ bool CPDFFile::fn_IsFieldName(ArlPDFObject* obj) {
         return false;
 
     ArlPDFString* str = (ArlPDFString*)obj;
-    std::wstring s = str->get_value();
-    if ((s.size() > 0) && (s.find('.') == std::string::npos)) {
+    std::string_view s = str->get_raw_bytes();
+    if ((s.size() > 0) && (s.find('.') == std::string_view::npos)) {
         return true;
     }
     return false;
@@ -1756,7 +1867,7 @@ bool CPDFFile::fn_FontHasLatinChars(ArlPDFObject* obj)
         return false;
     }
 
-    if (((ArlPDFName*)t)->get_value() != L"FontDescriptor") {
+    if (((ArlPDFName*)t)->get_raw_bytes() != "FontDescriptor") {
 #ifdef PP_FN_DEBUG
         std::cout << "fn_FontHasLatinChars() dictionary /Type key was not FontDescriptor!" << std::endl;
 #endif
@@ -1790,8 +1901,8 @@ bool CPDFFile::fn_HasProcessColorants(ArlPDFObject *parent, const ASTNode* obj_r
     for (int i = 0; i < arr->get_num_elements(); i++) {
         auto o = arr->get_value(i);
         if ((o != nullptr) && (o->get_object_type() == PDFObjectType::ArlPDFObjTypeName)) {
-            auto nm = ((ArlPDFName*)o)->get_value();
-            if ((nm == L"Cyan") || (nm == L"Magenta") || (nm == L"Yellow") || (nm == L"Black")) {
+            auto nm = ((ArlPDFName*)o)->get_raw_bytes();
+            if ((nm == "Cyan") || (nm == "Magenta") || (nm == "Yellow") || (nm == "Black")) {
                 delete o;
                 return true;
             }
@@ -1823,8 +1934,8 @@ bool CPDFFile::fn_HasSpotColorants(ArlPDFObject* parent, const ASTNode* obj_ref)
     for (int i = 0; i < arr->get_num_elements(); i++) {
         auto o = arr->get_value(i);
         if ((o != nullptr) && (o->get_object_type() == PDFObjectType::ArlPDFObjTypeName)) {
-            auto nm = ((ArlPDFName*)o)->get_value();
-            if ((nm != L"Cyan") && (nm != L"Magenta") && (nm != L"Yellow") && (nm != L"Black") && (nm.size() > 0)) {
+            auto nm = ((ArlPDFName*)o)->get_raw_bytes();
+            if ((nm != "Cyan") && (nm != "Magenta") && (nm != "Yellow") && (nm != "Black") && (nm.size() > 0)) {
                 delete o;
                 return true;
             }
@@ -1870,7 +1981,7 @@ bool CPDFFile::fn_ImageIsStructContentItem(ArlPDFObject* obj)
         return false;
     }
 
-    if (((ArlPDFName*)t)->get_value() != L"Image") {
+    if (((ArlPDFName*)t)->get_raw_bytes() != "Image") {
 #ifdef PP_FN_DEBUG
         std::cout << "fn_ImageIsStructContentItem() dictionary /Subtype key was not Image!" << std::endl;
 #endif
@@ -2056,7 +2167,7 @@ bool CPDFFile::fn_InNameTree(ArlPDFObject* parent, ArlPDFObject* obj, const ASTN
 
     bool retval = false;
     if ((nametree_obj != nullptr) && (nametree_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-        auto obj_str = ((ArlPDFString*)obj)->get_value();
+        auto obj_str = ((ArlPDFString*)obj)->get_raw_bytes();
         auto nametree_dict = (ArlPDFDictionary*)nametree_obj;
         auto names = nametree_dict->get_value(L"Names");
         if ((names != nullptr) && (names->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)) {
@@ -2065,7 +2176,7 @@ bool CPDFFile::fn_InNameTree(ArlPDFObject* parent, ArlPDFObject* obj, const ASTN
             for (int i = 0; i < names_arr->get_num_elements(); i += 2) {
                 auto o = names_arr->get_value(i);
                 if ((o != nullptr) && (o->get_object_type() == PDFObjectType::ArlPDFObjTypeString)) {
-                    if (((ArlPDFString*)o)->get_value() == obj_str) {
+                    if (((ArlPDFString*)o)->get_raw_bytes() == obj_str) {
                         delete o;
                         retval = true;
                         break;
@@ -2146,7 +2257,7 @@ bool CPDFFile::fn_IsEncryptedWrapper()
     if ((collection != nullptr) && (collection->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
         ArlPDFObject* view = ((ArlPDFDictionary*)collection)->get_value(L"View");
         if ((view != nullptr) && (view->get_object_type() == PDFObjectType::ArlPDFObjTypeName)) {
-            if (((ArlPDFName*)view)->get_value() == L"H") {
+            if (((ArlPDFName*)view)->get_raw_bytes() == "H") {
                 ArlPDFObject* names = doccat->get_value(L"Names");
                 if ((names != nullptr) && (names->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
                     ArlPDFObject* embedded_files = ((ArlPDFDictionary*)names)->get_value(L"EmbeddedFiles");
@@ -2161,7 +2272,7 @@ bool CPDFFile::fn_IsEncryptedWrapper()
                                 if ((afile != nullptr) && (afile->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
                                     ArlPDFObject* af_rel = ((ArlPDFDictionary*)afile)->get_value(L"AFRelationship");
                                     if ((af_rel != nullptr) && (af_rel->get_object_type() == PDFObjectType::ArlPDFObjTypeName)) {
-                                        if (((ArlPDFName*)af_rel)->get_value() == L"EncryptedPayload") {
+                                        if (((ArlPDFName*)af_rel)->get_raw_bytes() == "EncryptedPayload") {
                                             delete af_rel;
                                             retval = true;
                                             break;
@@ -2447,6 +2558,16 @@ ASTNode* CPDFFile::fn_PageProperty(ArlPDFObject* parent, ASTNode* pg, ASTNode* p
     if ((pg_obj != nullptr) && (pg_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
         auto pg_key_parts = split_key_path(pg_key->node);
         ArlPDFObject* pg_key_obj = get_object_for_path(parent, pg_key_parts);
+        if ((pg_key_obj == nullptr) && (pg_key_parts.size() == 1) &&
+            ((pg_key_parts[0] == "Resources") || (pg_key_parts[0] == "MediaBox") || (pg_key_parts[0] == "CropBox") || (pg_key_parts[0] == "Rotate"))) {
+            // Inheritable page attributes (Table 31)
+            std::wstring k = ToWString(pg_key_parts[0]);
+            pg_key_obj = ((ArlPDFDictionary*)pg_obj)->get_value(k);
+            if (pg_key_obj == nullptr) {
+                int depth;
+                pg_key_obj = get_inherited_value((ArlPDFDictionary*)pg_obj, k, depth);
+            }
+        }
         if (pg_key_obj != nullptr) {
             ASTNode* retval = convert_basic_object_to_ast(pg_key_obj);
             if (retval == nullptr) {
@@ -2737,7 +2858,7 @@ int CPDFFile::fn_StringLength(ArlPDFObject* parent, const ASTNode* key) {
     ArlPDFObject* o = get_object_for_path(parent, key_parts);
     if ((o != nullptr) && (o->get_object_type() == PDFObjectType::ArlPDFObjTypeString)) {
         ArlPDFString* str_obj = (ArlPDFString*)o;
-        int len = (int)str_obj->get_value().size();
+        int len = (int)str_obj->get_raw_bytes().size();
         delete o;
         return len;
     }
@@ -28,9 +28,12 @@
 #include "ASTNode.h"
 #include "ArlingtonPDFShim.h"
 #include "ArlingtonTSVGrammarFile.h"
+#include "ArlMessages.h"
 
 #include <string>
 #include <vector>
+#include <map>
+#include <set>
 #include <filesystem>
 #include <iostream>
 
@@ -40,7 +43,7 @@ namespace fs = std::filesystem;
 class CPDFFile
 {
 private:
-    /// @brief PDF filename
+    /// @brief PDF filename (or name of an in-memory PDF)
     fs::path                pdf_filename;
 
     /// @brief PDF SDK object reference
@@ -84,6 +87,16 @@ private:
     /// @brief List of names of extensions being supported. Default = empty list
     std::vector<std::string>    extensions;
 
+    /// @brief Page tree inheritance cache. Key is hash_id of a page tree node plus the inheritable key.
+    ///        Value is the nearest dictionary at or above that node which has the key (or nullptr).
+    std::map<std::string, ArlPDFDictionary*>    inherited_cache;
+
+    /// @brief Page tree nodes referenced by inherited_cache (owned)
+    std::vector<ArlPDFDictionary*>              inherited_nodes;
+
+    /// @brief Object numbers of inherited_nodes (which must never be released)
+    std::set<int>                               inherited_obj_nbrs;
+
     /// @brief Method to check if a key value is within a prescribed set of values
     bool check_key_value(ArlPDFDictionary* dict, const std::wstring& key, const std::vector<std::wstring> values);
 
@@ -142,9 +155,9 @@ public:
     /// @brief PDF version being used (always a valid version, default is "2.0"). PUBLIC
     std::string             pdf_version;
 
-    CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std::string& forced_ver, const std::vector<std::string>& extns);
+    CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std::string& forced_ver, const std::vector<std::string>& extns, const size_t file_size);
 
-    ~CPDFFile() { /* destructor  delete doccat; */ };
+    ~CPDFFile();
 
     /// @brief Returns the PDF files trailer dictionary or nullptr on error. DO NOT FREE!
     ArlPDFTrailer* get_ptr_to_trailer() { return pdfsdk.get_trailer(); };
@@ -153,7 +166,7 @@ public:
     int get_trailer_size() { return trailer_size; };
 
     /// @brief PDF version to use when processing a PDF file (always a valid version)
-    std::string  check_and_get_pdf_version(std::ostream& ofs);
+    std::string  check_and_get_pdf_version(std::ostream& ofs, const ReportFormat format = ReportFormat::Text, arl_findings* findings = nullptr, CArlMessageLog* log = nullptr);
 
     /// @brief Set the PDF version for an encountered feature so we can track latest version used
     void set_feature_version(const std::string& ver, const std::string& arl, const std::string& key);
@@ -167,6 +180,18 @@ public:
     /// @brief returns the list of currently support extensions. Could be an empty vector.
     std::vector<std::string> get_extensions() { return extensions; }
 
+    /// @brief Locates an inheritable key (e.g. Resources, MediaBox, CropBox, Rotate) via the page tree /Parent chain
+    ArlPDFObject* get_inherited_value(ArlPDFDictionary* obj, const std::wstring& key, int& depth);
+
+    /// @brief Releases a PDF object in the PDF SDK once no longer needed (--low-memory)
+    void release_object(const int obj_nbr);
+
+    /// @brief true if release_object() frees memory in the PDF SDK
+    bool can_release_objects() { return pdfsdk.can_release_objects(); }
+
+    /// @brief Returns a new object for an indirect object (nullptr if not possible). See ArlingtonPDFSDK::get_indirect_object().
+    ArlPDFObject* get_indirect_object(const int obj_nbr) { return pdfsdk.get_indirect_object(obj_nbr); }
+
     /// @brief Calculates an Arlington predicate expression
     ASTNode* ProcessPredicate(ArlPDFObject* parent, ArlPDFObject* obj, const ASTNode* in_ast, const int key_idx, const ArlTSVmatrix& tsv_data, const int type_idx, int depth, const bool use_default_values);
 
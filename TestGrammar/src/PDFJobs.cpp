@@ -0,0 +1,1020 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Corpus processing support: PDF job queue (--jobs), the
+/// crash-isolating worker process supervisor (--isolate), sharding (--shard),
+/// the journal of completed PDFs (--journal), exclusions (--exclude),
+/// finding PDFs in the --pdf folders and reading them ahead (--readahead)
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+#include "PDFJobs.h"
+#include "utils.h"
+
+#if !defined(_WIN32) && !defined(WIN32)
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+
+/// @brief Adds a PDF file to the queue and wakes up a worker
+///
+/// @param[in] job  the PDF to check
+void CPDFJobQueue::push(const pdf_job& job) {
+    {
+        std::lock_guard<std::mutex> lock(q_mutex);
+        jobs.push({ job, pushed++ });
+    }
+    q_cv.notify_one();
+}
+
+
+/// @brief No more PDF files will be added. Workers finish once the queue is empty.
+void CPDFJobQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(q_mutex);
+        closed = true;
+    }
+    q_cv.notify_all();
+}
+
+
+/// @brief Waits for the next PDF file, which is the most costly one queued
+///
+/// @param[out] job   the next PDF to check
+///
+/// @returns true if job was assigned, false if the queue is closed and empty
+bool CPDFJobQueue::pop(pdf_job& job) {
+    std::unique_lock<std::mutex> lock(q_mutex);
+    q_cv.wait(lock, [this] { return closed || !jobs.empty(); });
+    if (jobs.empty())
+        return false;
+    job = jobs.top().first;
+    jobs.pop();
+    return true;
+}
+
+
+/// @brief Compiles all exclusion strings that are valid regexes
+///
+/// @param[in] exclusions  the --exclude strings
+CPDFExclusions::CPDFExclusions(const std::vector<std::string>& exclusions)
+    : patterns(exclusions)
+{
+    for (auto& excl : patterns) {
+        try {
+            regexes.emplace_back(new std::regex(excl));
+        }
+        catch (...) { // const std::regex_error& e
+            // not a regex, so only used as a string
+            regexes.emplace_back(nullptr);
+        }
+    }
+}
+
+
+/// @brief Returns true if a PDF is to be excluded. On Windows both the native path and the
+/// path with '/' separators are matched. Thread-safe.
+///
+/// @param[in] pdf_file  the PDF file
+///
+/// @returns true if the PDF matches any exclusion
+bool CPDFExclusions::is_excluded(const fs::path& pdf_file) const {
+    if (patterns.empty())
+        return false;
+
+    const std::string s = pdf_file.lexically_normal().string();
+#if defined(_WIN32) || defined(WIN32)
+    // Microsoft Windows path separator is a BACKSLASH which is very annoying in C++!
+    std::string g = s;
+    std::replace(g.begin(), g.end(), '\\', '/');
+#else
+    const std::string& g = s;
+#endif // _WIN32/WIN32
+
+    for (size_t i = 0; i < patterns.size(); i++) {
+        if ((s.find(patterns[i]) != std::string::npos) || (g.find(patterns[i]) != std::string::npos))
+            return true;
+        if ((regexes[i] != nullptr) && std::regex_match(g, *regexes[i]))
+            return true;
+    }
+    return false;
+}
+
+
+/// @brief Returns true if read-ahead is being used
+bool CPDFReadAhead::is_enabled() {
+#if defined(_WIN32) || defined(WIN32)
+    return false;
+#else
+    return (budget > 0);
+#endif // _WIN32 || WIN32
+}
+
+
+/// @brief Moves the PDFs that will be checked next from waiting to advised while they fit in the budget.
+/// At least one PDF is always read ahead, even if it is larger than the budget.
+///
+/// @param[out] to_advise  the PDFs to read ahead (once r_mutex is unlocked)
+void CPDFReadAhead::next_to_advise(std::vector<std::pair<std::string, uintmax_t>>& to_advise) {
+    while (!waiting.empty() && ((in_flight == 0) || (in_flight + waiting.begin()->second.second <= budget))) {
+        auto& pdf = waiting.begin()->second;
+        in_flight += pdf.second;
+        advised[pdf.first] = pdf.second;
+        files++;
+        bytes += pdf.second;
+        waiting_order.erase(pdf.first);
+        to_advise.push_back(std::move(pdf));
+        waiting.erase(waiting.begin());
+    }
+}
+
+
+/// @brief Asks the operating system to start reading a whole PDF into its file cache. Does not wait.
+///
+/// @param[in] pdf_file  the PDF file
+/// @param[in] size      size of pdf_file in bytes
+void CPDFReadAhead::advise(const std::string& pdf_file, const uintmax_t size) {
+#if defined(_WIN32) || defined(WIN32)
+    (void)pdf_file;
+    (void)size;
+#else
+    int fd = ::open(pdf_file.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+#if defined(__APPLE__)
+    struct radvisory ra;
+    ra.ra_offset = 0;
+    ra.ra_count = (int)std::min<uintmax_t>(size, INT32_MAX);
+    (void)fcntl(fd, F_RDADVISE, &ra);
+#else
+    (void)posix_fadvise(fd, 0, (off_t)size, POSIX_FADV_WILLNEED);
+#endif // __APPLE__
+    ::close(fd);    // the file cache is kept after closing
+#endif // _WIN32 || WIN32
+}
+
+
+/// @brief Adds a PDF that will be checked. It is read ahead now if it is one of the next PDFs
+/// to be checked and within budget.
+///
+/// @param[in] pdf_file  the PDF file
+/// @param[in] size      size of pdf_file in bytes
+/// @param[in] cost      estimated cost, as used by CPDFJobQueue (0 if checked in the order added)
+void CPDFReadAhead::add(const fs::path& pdf_file, const uintmax_t size, const double cost) {
+    if (!is_enabled())
+        return;
+
+    std::vector<std::pair<std::string, uintmax_t>> to_advise;
+    {
+        std::lock_guard<std::mutex> lock(r_mutex);
+        std::string k = key(pdf_file);
+        if ((advised.count(k) == 0) && (waiting_order.count(k) == 0)) {
+            check_order order(-cost, added++);
+            waiting[order] = std::make_pair(k, size);
+            waiting_order[k] = order;
+        }
+        next_to_advise(to_advise);
+    }
+    for (auto& pdf : to_advise)
+        advise(pdf.first, pdf.second);
+}
+
+
+/// @brief A PDF has been checked or skipped, so more PDFs can be read ahead. A PDF that
+/// was checked before it was read ahead is removed from waiting, so it never uses the budget.
+///
+/// @param[in] pdf_file  the PDF file
+void CPDFReadAhead::done(const fs::path& pdf_file) {
+    if (!is_enabled())
+        return;
+
+    std::string k = key(pdf_file);
+    std::vector<std::pair<std::string, uintmax_t>> to_advise;
+    {
+        std::lock_guard<std::mutex> lock(r_mutex);
+        auto it = advised.find(k);
+        if (it != advised.end()) {
+            in_flight -= it->second;
+            advised.erase(it);
+        }
+        else {
+            // checked before it could be read ahead (e.g. many --jobs and a small budget)
+            auto w = waiting_order.find(k);
+            if (w != waiting_order.end()) {
+                waiting.erase(w->second);
+                waiting_order.erase(w);
+            }
+        }
+        next_to_advise(to_advise);
+    }
+    for (auto& pdf : to_advise)
+        advise(pdf.first, pdf.second);
+}
+
+
+/// @brief Starts traversing inputs on a background thread
+///
+/// @param[in] inputs     the --pdf files and folders
+/// @param[in] all_files  true to return all regular files (--allfiles), not just those with a .pdf extension
+/// @param[in] ra         every PDF found is added for read-ahead (--readahead), unless nullptr because
+///                       PDFs are checked in a different order (--jobs, --isolate)
+CPDFEnumerator::CPDFEnumerator(const std::vector<fs::path>& inputs, const bool all_files, CPDFReadAhead* ra)
+    : readahead(ra)
+{
+    walker = std::thread(&CPDFEnumerator::walk, this, inputs, all_files);
+}
+
+
+/// @brief Stops the background thread, if it is still running
+CPDFEnumerator::~CPDFEnumerator() {
+    {
+        std::lock_guard<std::mutex> lock(e_mutex);
+        stopping = true;
+    }
+    not_full.notify_all();
+    if (walker.joinable())
+        walker.join();
+}
+
+
+/// @brief Adds to the queue, waiting while the queue is full
+///
+/// @param[in] input  a PDF that was found
+///
+/// @returns false if the enumerator is being destroyed
+bool CPDFEnumerator::add(pdf_input&& input) {
+    {
+        std::unique_lock<std::mutex> lock(e_mutex);
+        not_full.wait(lock, [this] { return stopping || (found.size() < MAX_QUEUED); });
+        if (stopping)
+            return false;
+        found.push_back(std::move(input));
+    }
+    not_empty.notify_one();
+    return true;
+}
+
+
+/// @brief Background thread: traverses all inputs in order. Folders are traversed recursively.
+///
+/// @param[in] inputs     the --pdf files and folders
+/// @param[in] all_files  true to return all regular files, not just those with a .pdf extension
+void CPDFEnumerator::walk(const std::vector<fs::path> inputs, const bool all_files) {
+    for (auto& input_file : inputs) {
+        pdf_input   in;
+        in.input_root = input_file;
+        try {
+            fs::directory_entry root(input_file);
+            if (root.is_directory()) {
+                fs::recursive_directory_iterator dir_iter;
+                try {
+                    dir_iter = fs::recursive_directory_iterator(input_file, fs::directory_options::skip_permission_denied);
+                }
+                catch (...) {
+                    // a folder that cannot be read contains no PDFs
+                    continue;
+                }
+                in.in_folder = true;
+                for (; dir_iter != fs::end(dir_iter); ++dir_iter) {
+                    const fs::directory_entry& entry = *dir_iter;
+                    if (entry.is_regular_file()) {
+                        if (all_files || has_pdf_extension(entry.path())) {
+                            std::error_code ec;
+                            in.pdf_file = entry.path();
+                            in.size = entry.file_size(ec);
+                            if (ec)
+                                in.size = 0;
+                            if (readahead != nullptr)
+                                readahead->add(in.pdf_file, in.size);
+                            if (!add(pdf_input(in)))
+                                return;
+                        }
+                    }
+                    else if (!entry.exists()) {
+                        in.pdf_file = entry.path();
+                        in.exists = false;
+                        if (!add(pdf_input(in)))
+                            return;
+                        in.exists = true;
+                    }
+                }
+            }
+            else {
+                in.pdf_file = input_file;
+                in.exists = root.exists();
+                if (in.exists && root.is_regular_file() && (all_files || has_pdf_extension(input_file))) {
+                    std::error_code ec;
+                    in.size = root.file_size(ec);
+                    if (ec)
+                        in.size = 0;
+                    if (readahead != nullptr)
+                        readahead->add(in.pdf_file, in.size);
+                }
+                else if (in.exists)
+                    continue;
+                if (!add(std::move(in)))
+                    return;
+            }
+        }
+        catch (const std::exception& e) {
+            in.pdf_file = input_file;
+            in.exists = true;
+            in.error = e.what();
+            if (!add(std::move(in)))
+                return;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(e_mutex);
+        finished = true;
+    }
+    not_empty.notify_all();
+}
+
+
+/// @brief Waits for the next PDF
+///
+/// @param[out] input  the next PDF (or problem with an input)
+///
+/// @returns true if input was assigned, false if all inputs have been traversed
+bool CPDFEnumerator::next(pdf_input& input) {
+    {
+        std::unique_lock<std::mutex> lock(e_mutex);
+        not_empty.wait(lock, [this] { return finished || !found.empty(); });
+        if (found.empty())
+            return false;
+        input = std::move(found.front());
+        found.pop_front();
+    }
+    not_full.notify_one();
+    return true;
+}
+
+
+/// @brief Returns true if a PDF belongs to shard k of n (1 <= k <= n). The partition is a stable
+/// hash (64-bit FNV-1a) of the key so it does not depend on directory iteration order or platform.
+///
+/// @param[in] key  PDF path relative to the input folder, with '/' separators
+/// @param[in] k    shard number (1-based)
+/// @param[in] n    total number of shards
+///
+/// @returns true if the PDF is to be processed by shard k
+bool in_shard(const std::string& key, const unsigned int k, const unsigned int n) {
+    uint64_t h = 14695981039346656037ULL;
+    for (const unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return (h % n) == (uint64_t)(k - 1);
+}
+
+
+/// @brief Reads all previously completed PDFs from an existing journal and then opens it for appending.
+/// Lines starting with '#' are comments.
+///
+/// @param[in] journal_file   the journal filename (may not exist yet)
+///
+/// @returns true if the journal can be written
+bool CPDFJournal::open(const fs::path& journal_file) {
+    std::ifstream   in(journal_file);
+    std::string     line;
+    while (std::getline(in, line)) {
+        if (line.empty() || (line[0] == '#'))
+            continue;
+        auto t1 = line.find('\t');
+        if (t1 == std::string::npos)
+            continue;
+        auto t2 = line.find('\t', t1 + 1);
+        completed.insert(line.substr(t1 + 1, (t2 == std::string::npos) ? std::string::npos : t2 - t1 - 1));
+    }
+    in.close();
+
+    bool is_new = !fs::exists(journal_file);
+    journal.open(journal_file, std::ofstream::out | std::ofstream::app);
+    if (is_new && journal.is_open())
+        journal << "# TestGrammar journal: status<TAB>PDF<TAB>report<TAB>milliseconds<TAB>bytes" << std::endl;
+    return journal.is_open();
+}
+
+
+/// @brief Returns true if the PDF was completed in an earlier run (constant time).
+/// The set of completed PDFs is not changed after open() so no locking is required.
+///
+/// @param[in] pdf_file  the PDF
+bool CPDFJournal::is_done(const fs::path& pdf_file) {
+    if (completed.empty())
+        return false;
+    return (completed.count(key(pdf_file)) > 0);
+}
+
+
+/// @brief Records that a PDF has been completely checked. Each line is flushed immediately
+/// so the journal remains valid if the run is killed.
+///
+/// @param[in] pdf_file  the PDF
+/// @param[in] status    the outcome: "OK", "FATAL" or "FAILED"
+/// @param[in] rptfile   the report file (empty if stdout)
+/// @param[in] secs      time taken to check the PDF
+/// @param[in] size      size of the PDF in bytes
+void CPDFJournal::record(const fs::path& pdf_file, const std::string& status, const fs::path& rptfile, const double secs, const uintmax_t size) {
+    if (!journal.is_open())
+        return;
+    std::lock_guard<std::mutex> lock(j_mutex);
+    journal << status << '\t' << key(pdf_file) << '\t' << rptfile.string() << '\t' << (uintmax_t)(secs * 1000.0) << '\t' << size << std::endl;
+}
+
+
+/// @brief Reads the check time of every PDF in a journal written by an earlier run (--history).
+/// Lines without times (from older versions) are ignored.
+///
+/// @param[in] journal_file   the journal filename
+///
+/// @returns true if at least one check time was read
+bool CPDFScheduler::load_history(const fs::path& journal_file) {
+    std::ifstream   in(journal_file);
+    std::string     line;
+    double          total_secs = 0.0;
+    double          total_bytes = 0.0;
+    while (std::getline(in, line)) {
+        if (line.empty() || (line[0] == '#'))
+            continue;
+        std::vector<std::string> fields;
+        std::istringstream       ss(line);
+        std::string              field;
+        while (std::getline(ss, field, '\t'))
+            fields.push_back(field);
+        if (fields.size() < 5)
+            continue;
+        try {
+            double secs = std::stod(fields[3]) / 1000.0;
+            double bytes = std::stod(fields[4]);
+            history_secs[fields[1]] = secs;
+            total_secs += secs;
+            total_bytes += bytes;
+        }
+        catch (...) {
+            // ignore malformed lines
+        }
+    }
+    if (total_bytes > 0.0)
+        secs_per_byte = total_secs / total_bytes;
+    return !history_secs.empty();
+}
+
+
+/// @brief Returns the estimated cost of checking a PDF. Thread-safe as history is not changed
+/// after load_history().
+///
+/// @param[in] pdf_file  the PDF
+/// @param[in] size      size of pdf_file in bytes
+///
+/// @returns seconds if there is history, otherwise bytes
+double CPDFScheduler::estimate(const fs::path& pdf_file, const uintmax_t size) const {
+    if (history_secs.empty())
+        return (double)size;
+    auto it = history_secs.find(fs::absolute(pdf_file).lexically_normal().string());
+    if (it != history_secs.end())
+        return it->second;
+    return (double)size * secs_per_byte;
+}
+
+
+#if defined(_WIN32) || defined(WIN32)
+
+/// @brief Worker processes are not supported on Windows (no fork)
+///
+/// @returns false always
+bool CPDFSupervisor::run(const std::vector<pdf_job>& jobs, check_fn check, done_fn done) {
+    UNREFERENCED_FORMAL_PARAM(jobs);
+    UNREFERENCED_FORMAL_PARAM(check);
+    UNREFERENCED_FORMAL_PARAM(done);
+    return false;
+}
+
+#else
+
+/// @brief Result sent from a worker process back to the supervisor after each PDF
+struct worker_result {
+    uint32_t    index;          // index of the job
+    uint32_t    ok;             // 1 = success, 0 = fatal error
+    uint32_t    peak_mb;        // peak memory of the worker process
+    uint32_t    result_size;    // length of the result data that follows
+};
+
+
+/// @brief State of a single worker process, as seen by the supervisor
+struct worker_process {
+    pid_t   pid = -1;
+    int     job_fd = -1;        // supervisor writes job indices
+    int     result_fd = -1;     // supervisor reads worker_result
+    int     job = -1;           // job currently being checked or -1 if idle
+    std::chrono::steady_clock::time_point started;
+};
+
+
+/// @brief Reads exactly len bytes, retrying on EINTR
+///
+/// @returns true if all len bytes were read, false on EOF or error
+static bool read_fully(int fd, void* buf, size_t len) {
+    char* p = (char*)buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if ((n < 0) && (errno == EINTR))
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+
+/// @brief Writes exactly len bytes, retrying on EINTR
+///
+/// @returns true if all len bytes were written
+static bool write_fully(int fd, const void* buf, size_t len) {
+    const char* p = (const char*)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if ((n < 0) && (errno == EINTR))
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+
+/// @brief Returns the current resident memory of a process in MB, or 0 if unknown (Linux only)
+static unsigned int resident_memory_mb(pid_t pid) {
+#if defined(__linux__)
+    std::ifstream statm("/proc/" + std::to_string(pid) + "/statm");
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    if (statm >> size >> resident)
+        return (unsigned int)((resident * (unsigned long)sysconf(_SC_PAGESIZE)) / (1024 * 1024));
+#else
+    UNREFERENCED_FORMAL_PARAM(pid);
+#endif
+    return 0;
+}
+
+
+/// @brief Describes why a worker process ended, from its waitpid() status
+static std::string describe_exit(int status) {
+    if (WIFSIGNALED(status))
+        return "worker process crashed with signal " + std::to_string(WTERMSIG(status)) + " (" + strsignal(WTERMSIG(status)) + ")";
+    if (WIFEXITED(status))
+        return "worker process exited unexpectedly with status " + std::to_string(WEXITSTATUS(status));
+    return "worker process ended unexpectedly";
+}
+
+
+/// @brief Closes the supervisor's pipes to a worker process
+static void close_worker(worker_process& w) {
+    if (w.job_fd >= 0)
+        close(w.job_fd);
+    if (w.result_fd >= 0)
+        close(w.result_fd);
+    w.job_fd = w.result_fd = -1;
+    w.pid = -1;
+    w.job = -1;
+}
+
+
+/// @brief Forks a new worker process which checks the PDFs it is sent until its job pipe is closed
+///
+/// @param[in,out] workers  all worker processes (pipes of the others are closed in the new worker)
+/// @param[in]     idx      which worker to (re)start
+///
+/// @returns true if the worker was started
+static bool spawn_worker(std::vector<worker_process>& workers, size_t idx, const std::vector<pdf_job>& jobs, CPDFSupervisor::check_fn& check) {
+    int job_pipe[2];
+    int result_pipe[2];
+    if (pipe(job_pipe) != 0)
+        return false;
+    if (pipe(result_pipe) != 0) {
+        close(job_pipe[0]);
+        close(job_pipe[1]);
+        return false;
+    }
+
+    // Avoid duplicated output from buffered data being flushed by both processes
+    std::cout.flush();
+    std::cerr.flush();
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(job_pipe[0]);
+        close(job_pipe[1]);
+        close(result_pipe[0]);
+        close(result_pipe[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        // Worker process: only keep its own pipe ends so other workers see EOF correctly
+        for (auto& w : workers)
+            close_worker(w);
+        close(job_pipe[1]);
+        close(result_pipe[0]);
+
+        // Do not litter the output folder with core dumps from crashing PDFs
+        struct rlimit no_core = { 0, 0 };
+        (void)setrlimit(RLIMIT_CORE, &no_core);
+
+        worker_result r;
+        std::string   result;
+        while (read_fully(job_pipe[0], &r.index, sizeof(r.index))) {
+            result.clear();
+            try {
+                r.ok = check(jobs[r.index], result) ? 1 : 0;
+            }
+            catch (...) {
+                r.ok = 0;
+            }
+            r.peak_mb = get_peak_memory_mb();
+            r.result_size = (uint32_t)result.size();
+            if (!write_fully(result_pipe[1], &r, sizeof(r)) || !write_fully(result_pipe[1], result.data(), result.size()))
+                break;
+        }
+        // Skip all static destructors and atexit handlers of the supervisor (PDF SDK, etc.)
+        _exit(0);
+    }
+
+    close(job_pipe[0]);
+    close(result_pipe[1]);
+    workers[idx].pid = pid;
+    workers[idx].job_fd = job_pipe[1];
+    workers[idx].result_fd = result_pipe[0];
+    workers[idx].job = -1;
+    return true;
+}
+
+
+/// @brief Checks all PDFs using worker processes. Each PDF is reported via done exactly once.
+/// A PDF that crashes a worker, takes too long or uses too much memory is reported as a failure
+/// and the worker process is replaced.
+///
+/// @param[in] jobs   the PDFs to check
+/// @param[in] check  checks a single PDF (in a worker process)
+/// @param[in] done   reports the outcome of a single PDF (in this process)
+///
+/// @returns true if all jobs were processed, false if worker processes could not be started
+bool CPDFSupervisor::run(const std::vector<pdf_job>& jobs, check_fn check, done_fn done) {
+    std::vector<worker_process> workers(std::max(1u, num_workers));
+    size_t  next_job = 0;
+    bool    retval = true;
+
+    busy_secs.assign(workers.size(), 0.0);
+
+    // Time the current job of a worker took
+    auto job_secs = [&](size_t i) {
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - workers[i].started).count();
+        busy_secs[i] += secs;
+        return secs;
+    };
+
+    // A worker dying while being sent a job must not kill the supervisor
+    auto old_sigpipe = signal(SIGPIPE, SIG_IGN);
+
+    // Sends the next job to an idle worker, if any remain
+    auto assign = [&](worker_process& w) {
+        if ((w.pid <= 0) || (next_job >= jobs.size()))
+            return true;
+        uint32_t idx = (uint32_t)next_job;
+        if (!write_fully(w.job_fd, &idx, sizeof(idx)))
+            return false;
+        next_job++;
+        w.job = (int)idx;
+        w.started = std::chrono::steady_clock::now();
+        if (on_job)
+            on_job((size_t)(&w - workers.data()), &jobs[idx]);
+        return true;
+    };
+
+    // Reports the current job of a failed worker and starts a replacement
+    auto replace = [&](size_t i, const std::string& failure) {
+        worker_process& w = workers[i];
+        if (w.job >= 0) {
+            if (on_job)
+                on_job(i, nullptr);
+            done(jobs[w.job], false, 0, failure, job_secs(i), "");
+        }
+        close_worker(w);
+        if (spawn_worker(workers, i, jobs, check))
+            return assign(workers[i]);
+        return false;
+    };
+
+    for (size_t i = 0; i < workers.size(); i++)
+        if (spawn_worker(workers, i, jobs, check))
+            (void)assign(workers[i]);
+
+    while (true) {
+        std::vector<struct pollfd> fds;
+        std::vector<size_t>        fd_worker;
+        for (size_t i = 0; i < workers.size(); i++)
+            if ((workers[i].pid > 0) && (workers[i].job >= 0)) {
+                fds.push_back({ workers[i].result_fd, POLLIN, 0 });
+                fd_worker.push_back(i);
+            }
+        if (fds.empty()) {
+            // No busy workers: either all done, or all workers failed to start
+            retval = (next_job >= jobs.size());
+            break;
+        }
+
+        int n = poll(fds.data(), (nfds_t)fds.size(), 100);
+        if ((n < 0) && (errno != EINTR))
+            break;
+
+        for (size_t f = 0; (n > 0) && (f < fds.size()); f++) {
+            if (fds[f].revents == 0)
+                continue;
+            size_t i = fd_worker[f];
+            worker_process& w = workers[i];
+            worker_result r;
+            std::string   result;
+            if (read_fully(w.result_fd, &r, sizeof(r)) && ((int)r.index == w.job)) {
+                result.resize(r.result_size);
+                if ((r.result_size > 0) && !read_fully(w.result_fd, &result[0], r.result_size))
+                    result.clear();
+                w.job = -1;
+                if (on_job)
+                    on_job(i, nullptr);
+                done(jobs[r.index], (r.ok != 0), r.peak_mb, "", job_secs(i), result);
+                if (!assign(w)) {
+                    int status = 0;
+                    (void)waitpid(w.pid, &status, 0);
+                    (void)replace(i, describe_exit(status));
+                }
+            }
+            else {
+                // EOF or garbage: the worker process has died
+                int status = 0;
+                (void)waitpid(w.pid, &status, 0);
+                (void)replace(i, describe_exit(status));
+            }
+        }
+
+        // Check time and memory limits of all busy workers
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < workers.size(); i++) {
+            worker_process& w = workers[i];
+            if ((w.pid <= 0) || (w.job < 0))
+                continue;
+            std::string failure;
+            if ((timeout_secs > 0) && (std::chrono::duration_cast<std::chrono::seconds>(now - w.started).count() >= (long long)timeout_secs))
+                failure = "worker process timed out after " + std::to_string(timeout_secs) + " seconds";
+            else if (memory_mb > 0) {
+                unsigned int mb = resident_memory_mb(w.pid);
+                if (mb > memory_mb)
+                    failure = "worker process exceeded memory limit of " + std::to_string(memory_mb) + " MB (" + std::to_string(mb) + " MB)";
+            }
+            if (!failure.empty()) {
+                (void)kill(w.pid, SIGKILL);
+                (void)waitpid(w.pid, nullptr, 0);
+                (void)replace(i, failure);
+            }
+        }
+    }
+
+    // Closing the job pipes makes all idle workers exit
+    for (auto& w : workers) {
+        pid_t pid = w.pid;
+        close_worker(w);
+        if (pid > 0)
+            (void)waitpid(pid, nullptr, 0);
+    }
+
+    (void)signal(SIGPIPE, old_sigpipe);
+    return retval;
+}
+
+#endif // _WIN32 || WIN32
+
+
+/// @brief Allocates the object counter, in shared memory if possible so that it is also
+/// updated by --isolate worker processes
+CRunMetrics::CRunMetrics()
+    : objects(nullptr), objects_shared(false), files_found(0), files_done(0), bytes_done(0),
+      files_fatal(0), worker_failures(0), worker_peak_mb(0), all_found(false)
+{
+#if !defined(_WIN32) && !defined(WIN32)
+    void* p = mmap(nullptr, sizeof(std::atomic<uint64_t>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED) {
+        objects = new (p) std::atomic<uint64_t>(0);
+        objects_shared = true;
+    }
+#endif // _WIN32 || WIN32
+    if (objects == nullptr)
+        objects = new std::atomic<uint64_t>(0);
+}
+
+
+CRunMetrics::~CRunMetrics() {
+    stop();
+#if !defined(_WIN32) && !defined(WIN32)
+    if (objects_shared) {
+        (void)munmap((void*)objects, sizeof(std::atomic<uint64_t>));
+        return;
+    }
+#endif // _WIN32 || WIN32
+    delete objects;
+}
+
+
+/// @brief Writes the metrics file now and then starts the background thread that rewrites it
+///
+/// @param[in] file     metrics filename (e.g. in the node_exporter textfile collector folder)
+/// @param[in] workers  number of worker threads or worker processes
+///
+/// @returns true if the metrics file could be written
+bool CRunMetrics::start(const fs::path& file, const unsigned int workers) {
+    metrics_file = file;
+    start_time = std::chrono::steady_clock::now();
+    slots.clear();
+    for (unsigned int i = 0; i < std::max(1u, workers); i++)
+        slots.emplace_back(new worker_slot);
+    if (!write()) {
+        metrics_file.clear();
+        return false;
+    }
+    writer = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(stop_mutex);
+        while (!stop_cv.wait_for(lock, std::chrono::seconds(INTERVAL_SECS), [this]() { return stopping; })) {
+            lock.unlock();
+            (void)write();
+            lock.lock();
+        }
+    });
+    return true;
+}
+
+
+/// @brief Sets the PDF a worker is checking, once per PDF. Only takes the lock of that worker's
+/// slot, which the writer thread holds just long enough to copy the filename.
+///
+/// @param[in] worker    worker thread or worker process (0 to workers - 1)
+/// @param[in] pdf_file  the PDF, or empty if the worker is idle
+void CRunMetrics::set_current(const unsigned int worker, const fs::path& pdf_file) {
+    if (!is_enabled() || (worker >= slots.size()))
+        return;
+    std::lock_guard<std::mutex> lock(slots[worker]->s_mutex);
+    slots[worker]->pdf_file = pdf_file.lexically_normal().string();
+    slots[worker]->started = std::chrono::steady_clock::now();
+}
+
+
+/// @brief Counts a finished PDF
+///
+/// @param[in] size     size of the PDF in bytes
+/// @param[in] ok       false if the PDF had a fatal error
+/// @param[in] failed   true if the --isolate worker process failed (crashed, timed out, etc.)
+/// @param[in] peak_mb  peak memory of the --isolate worker process, or 0
+void CRunMetrics::finished(const uintmax_t size, const bool ok, const bool failed, const unsigned int peak_mb) {
+    if (!is_enabled())
+        return;
+    files_done++;
+    bytes_done += size;
+    if (!ok)
+        files_fatal++;
+    if (failed)
+        worker_failures++;
+    unsigned int prev = worker_peak_mb;
+    while ((peak_mb > prev) && !worker_peak_mb.compare_exchange_weak(prev, peak_mb))
+        ;
+}
+
+
+/// @brief Escapes a Prometheus label value
+static std::string prometheus_label(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (const char c : s) {
+        if ((c == '\\') || (c == '"'))
+            out += '\\';
+        if (c == '\n')
+            out += "\\n";
+        else
+            out += c;
+    }
+    return out;
+}
+
+
+/// @brief Writes all metrics to a temporary file which is then renamed, so that a collector
+/// never reads a partial file
+///
+/// @returns true on success
+bool CRunMetrics::write() {
+    double   secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    uint64_t found = files_found;
+    uint64_t done = files_done;
+    uint64_t objs = *objects;
+    uint64_t peak_mb = std::max(get_peak_memory_mb(), (unsigned int)worker_peak_mb);
+
+    std::ostringstream m;
+    m << std::fixed << std::setprecision(3);
+    // Integer values are written as integers, others with 3 decimal places
+    auto metric = [&](const char* name, const char* type, const char* help, const auto value) {
+        m << "# HELP testgrammar_" << name << " " << help << "\n"
+          << "# TYPE testgrammar_" << name << " " << type << "\n"
+          << "testgrammar_" << name << " " << value << "\n";
+    };
+    metric("elapsed_seconds", "gauge", "Time since the run started.", secs);
+    metric("files_found_total", "counter", "PDF files found to check so far.", found);
+    metric("files_done_total", "counter", "PDF files checked.", done);
+    metric("files_remaining", "gauge", "PDF files found but not yet checked.", ((found > done) ? (found - done) : 0));
+    metric("files_all_found", "gauge", "1 once all --pdf inputs have been traversed.", (all_found ? 1 : 0));
+    metric("bytes_done_total", "counter", "Total size of the PDF files checked.", (uint64_t)bytes_done);
+    metric("objects_checked_total", "counter", "PDF objects checked.", objs);
+    metric("objects_per_second", "gauge", "PDF objects checked per second since the run started.", ((secs > 0.0) ? (objs / secs) : 0.0));
+    metric("files_fatal_total", "counter", "PDF files with a fatal error.", (uint64_t)files_fatal);
+    metric("worker_failures_total", "counter", "Worker processes that crashed, timed out or exceeded the memory limit (--isolate).", (uint64_t)worker_failures);
+    metric("peak_rss_bytes", "gauge", "Peak resident memory of TestGrammar or any worker process.", peak_mb * 1024 * 1024);
+
+    m << "# HELP testgrammar_worker_current_seconds Time the worker has spent on the PDF it is checking.\n"
+      << "# TYPE testgrammar_worker_current_seconds gauge\n";
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < slots.size(); i++) {
+        std::string                             pdf;
+        std::chrono::steady_clock::time_point   started;
+        {
+            std::lock_guard<std::mutex> lock(slots[i]->s_mutex);
+            pdf = slots[i]->pdf_file;
+            started = slots[i]->started;
+        }
+        if (!pdf.empty())
+            m << "testgrammar_worker_current_seconds{worker=\"" << (i + 1) << "\",pdf=\"" << prometheus_label(pdf) << "\"} "
+              << std::fixed << std::setprecision(3) << std::chrono::duration<double>(now - started).count() << "\n";
+    }
+
+    try {
+        fs::path tmp = metrics_file;
+        tmp += ".tmp";
+        {
+            std::ofstream out(tmp, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+            out << m.str();
+            out.close();
+            if (out.fail())
+                return false;
+        }
+        fs::rename(tmp, metrics_file);
+    }
+    catch (...) {
+        return false;
+    }
+    return true;
+}
+
+
+/// @brief Stops the background thread and writes the final metrics
+void CRunMetrics::stop() {
+    if (!writer.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_cv.notify_all();
+    writer.join();
+    (void)write();
+}
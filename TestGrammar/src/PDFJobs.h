@@ -0,0 +1,355 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Corpus processing support: PDF job queue (--jobs), the
+/// crash-isolating worker process supervisor (--isolate), sharding (--shard),
+/// the journal of completed PDFs (--journal), exclusions (--exclude),
+/// finding PDFs in the --pdf folders and reading them ahead (--readahead)
+/// and progress metrics (--metrics)
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef PDFJobs_h
+#define PDFJobs_h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <regex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+
+/// @brief A single PDF file to be checked by a worker thread or worker process
+struct pdf_job {
+    fs::path    pdf_file;       // PDF to check
+    fs::path    rptfile;        // output report file (already created)
+    uintmax_t   size = 0;       // size of pdf_file in bytes
+    double      cost = 0.0;     // estimated time to check (see CPDFScheduler). Most costly PDFs are checked first.
+};
+
+
+/// @class CPDFJobQueue
+/// Thread-safe queue of PDF files to be checked by the --jobs worker threads.
+/// Filled by the main thread as input folders are traversed. The most costly PDF
+/// queued so far is always next, so large PDFs do not end up last and decide the
+/// total time. PDFs of equal cost are checked in the order they were queued.
+class CPDFJobQueue {
+    /// @brief a job and the order it was queued
+    typedef std::pair<pdf_job, uint64_t> queued_job;
+
+    /// @brief priority_queue ordering: highest cost, then first queued
+    struct job_order {
+        bool operator()(const queued_job& a, const queued_job& b) const {
+            if (a.first.cost != b.first.cost)
+                return a.first.cost < b.first.cost;
+            return a.second > b.second;
+        }
+    };
+
+    std::mutex              q_mutex;
+    std::condition_variable q_cv;
+    std::priority_queue<queued_job, std::vector<queued_job>, job_order> jobs;
+    uint64_t                pushed = 0;
+    bool                    closed = false;
+
+public:
+    /// @brief Adds a PDF file to the queue and wakes up a worker
+    void push(const pdf_job& job);
+
+    /// @brief No more PDF files will be added. Workers finish once the queue is empty.
+    void close();
+
+    /// @brief Waits for the next PDF file
+    bool pop(pdf_job& job);
+};
+
+
+/// @class CPDFSupervisor
+/// Checks PDF files in separate worker processes (POSIX fork) so that a PDF that crashes
+/// or hangs the PDF SDK only affects that PDF. Workers are forked after the Arlington
+/// grammar has been loaded so it is shared copy-on-write. Jobs are handed out over pipes.
+/// Workers that crash, exceed the time limit or exceed the memory limit are replaced.
+class CPDFSupervisor {
+public:
+    /// @brief Checks a single PDF. Called in a worker process. Returns false on a fatal error.
+    /// result is sent back to the supervisor (e.g. the findings of the PDF for --stats).
+    typedef std::function<bool(const pdf_job& job, std::string& result)> check_fn;
+
+    /// @brief Reports the outcome of a single PDF. Called in the supervisor process.
+    /// failure is empty unless the worker process failed (crashed, timed out, etc.).
+    typedef std::function<void(const pdf_job& job, bool ok, unsigned int peak_mb, const std::string& failure, double secs, const std::string& result)> done_fn;
+
+    /// @brief A worker process was sent a PDF, or has finished one (job is nullptr). Called in the supervisor process.
+    typedef std::function<void(const size_t worker, const pdf_job* job)> job_fn;
+
+private:
+    unsigned int    num_workers;
+    unsigned int    timeout_secs;
+    unsigned int    memory_mb;
+
+public:
+    std::vector<double> busy_secs;  // time each worker process spent checking PDFs
+    job_fn              on_job;     // optional, e.g. for --metrics
+
+    CPDFSupervisor(const unsigned int workers, const unsigned int timeout, const unsigned int memory)
+        : num_workers(workers), timeout_secs(timeout), memory_mb(memory)
+        { /* constructor */ }
+
+    /// @brief Checks all PDFs using worker processes, in the order of jobs
+    bool run(const std::vector<pdf_job>& jobs, check_fn check, done_fn done);
+};
+
+
+/// @class CPDFExclusions
+/// The --exclude strings. A PDF is excluded if its path contains a string or fully matches
+/// it as a regex. Regexes are compiled once rather than for every PDF.
+class CPDFExclusions {
+    std::vector<std::string>                    patterns;
+    std::vector<std::unique_ptr<std::regex>>    regexes;    // nullptr if the pattern is not a valid regex
+
+public:
+    explicit CPDFExclusions(const std::vector<std::string>& exclusions);
+
+    /// @brief Returns true if a PDF is to be excluded. Thread-safe.
+    bool is_excluded(const fs::path& pdf_file) const;
+};
+
+
+/// @class CPDFReadAhead
+/// --readahead: asks the operating system to start reading upcoming PDFs into its file cache
+/// (posix_fadvise or F_RDADVISE) while the current PDFs are being checked, so that cold reads
+/// from network or spinning-disk storage do not stall the PDF SDK. PDFs are read ahead in the
+/// same order as CPDFJobQueue checks them: highest cost first, then in the order they were added
+/// (so in the order they were found when checking one PDF at a time). PDFs are removed once checked.
+/// The PDFs in the file cache are limited by a byte budget. Does nothing on Windows or with a budget
+/// of 0. Thread-safe.
+class CPDFReadAhead {
+    /// @brief check order of a PDF: negative cost, then the order it was added
+    typedef std::pair<double, uint64_t> check_order;
+
+    std::mutex                                      r_mutex;
+    uintmax_t                                       budget;         // bytes
+    uintmax_t                                       in_flight = 0;  // bytes read ahead but not yet checked
+    uint64_t                                        added = 0;      // number of PDFs added
+    std::map<check_order, std::pair<std::string, uintmax_t>>  waiting;  // PDFs not yet read ahead, in check order
+    std::unordered_map<std::string, check_order>    waiting_order;  // PDF -> key in waiting
+    std::unordered_map<std::string, uintmax_t>      advised;        // PDFs read ahead but not yet checked
+
+    /// @brief the key used for a PDF file
+    static std::string key(const fs::path& pdf_file) { return pdf_file.lexically_normal().string(); }
+
+    /// @brief Moves PDFs from waiting to advised while within budget. r_mutex must be locked.
+    void next_to_advise(std::vector<std::pair<std::string, uintmax_t>>& to_advise);
+
+    /// @brief Asks the operating system to read a PDF into its file cache
+    static void advise(const std::string& pdf_file, const uintmax_t size);
+
+public:
+    uintmax_t   files = 0;      // number of PDFs read ahead
+    uintmax_t   bytes = 0;      // total size of PDFs read ahead
+
+    explicit CPDFReadAhead(const uintmax_t budget_bytes)
+        : budget(budget_bytes)
+        { /* constructor */ }
+
+    /// @brief Returns true if read-ahead is being used
+    bool is_enabled();
+
+    /// @brief Adds a PDF that will be checked, with the same cost as its pdf_job
+    void add(const fs::path& pdf_file, const uintmax_t size, const double cost = 0.0);
+
+    /// @brief A PDF has been checked (or skipped) so is no longer needed in the file cache
+    void done(const fs::path& pdf_file);
+};
+
+
+/// @brief A PDF file found by CPDFEnumerator, or a problem with one of the inputs
+struct pdf_input {
+    fs::path    pdf_file;           // PDF file found (or the input file/folder if !exists or error)
+    fs::path    input_root;         // the --pdf file or folder that pdf_file came from
+    bool        in_folder = false;  // true if found by traversing input_root
+    uintmax_t   size = 0;           // size of pdf_file in bytes
+    bool        exists = true;      // false if the file or folder does not exist
+    std::string error;              // exception while traversing input_root
+};
+
+
+/// @class CPDFEnumerator
+/// Finds PDF files in the --pdf files and folders on a background thread so that traversing
+/// large folders overlaps with checking PDFs. PDFs are returned in traversal order.
+class CPDFEnumerator {
+    /// @brief Maximum number of PDFs found but not yet returned by next()
+    static constexpr size_t MAX_QUEUED = 4096;
+
+    std::mutex              e_mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<pdf_input>   found;
+    bool                    finished = false;   // background thread has traversed all inputs
+    bool                    stopping = false;   // object is being destroyed
+    CPDFReadAhead*          readahead;          // nullptr if PDFs are not checked in traversal order
+    std::thread             walker;
+
+    /// @brief Background thread: traverses all inputs
+    void walk(const std::vector<fs::path> inputs, const bool all_files);
+
+    /// @brief Adds to the queue, waiting if it is full. Returns false if stopping.
+    bool add(pdf_input&& input);
+
+public:
+    /// @brief Starts traversing inputs. Only files with a .pdf extension are returned unless all_files.
+    /// The size of every PDF is found and, if PDFs are checked in traversal order, it is also added to readahead.
+    CPDFEnumerator(const std::vector<fs::path>& inputs, const bool all_files, CPDFReadAhead* readahead);
+    ~CPDFEnumerator();
+
+    /// @brief Waits for the next PDF. Returns false once all inputs have been traversed.
+    bool next(pdf_input& input);
+};
+
+
+/// @brief Returns true if a PDF belongs to shard k of n (1 <= k <= n)
+bool in_shard(const std::string& key, const unsigned int k, const unsigned int n);
+
+
+/// @class CPDFJournal
+/// Thread-safe append-only record of PDFs that have been completely checked, so that an
+/// interrupted corpus run can be restarted and skip already finished PDFs.
+/// Each line is: status TAB PDF-filename TAB report-filename TAB milliseconds TAB bytes
+/// (journals written by older versions only have the first 3 fields).
+class CPDFJournal {
+    std::mutex                      j_mutex;
+    std::ofstream                   journal;
+    std::unordered_set<std::string> completed;
+
+    /// @brief the key used for a PDF file
+    static std::string key(const fs::path& pdf_file) { return fs::absolute(pdf_file).lexically_normal().string(); }
+
+public:
+    /// @brief Reads all previously completed PDFs and opens the journal for appending
+    bool open(const fs::path& journal_file);
+
+    /// @brief Returns true if a journal is being used
+    bool is_open() { return journal.is_open(); }
+
+    /// @brief Returns the number of PDFs previously completed
+    size_t size() { return completed.size(); }
+
+    /// @brief Returns true if the PDF was completed in an earlier run
+    bool is_done(const fs::path& pdf_file);
+
+    /// @brief Records that a PDF has been completely checked
+    void record(const fs::path& pdf_file, const std::string& status, const fs::path& rptfile, const double secs, const uintmax_t size);
+};
+
+
+/// @class CPDFScheduler
+/// Estimates the cost of checking each PDF for CPDFJobQueue and CPDFSupervisor. Without any
+/// history the cost is the file size. With the journal of an earlier run (--history) the cost
+/// is the time the PDF took then, or for new PDFs the time estimated from their size using
+/// the average speed of the earlier run.
+class CPDFScheduler {
+    std::unordered_map<std::string, double> history_secs;   // PDF -> seconds
+    double                                  secs_per_byte = 0.0;
+
+public:
+    /// @brief Reads the check times from a journal. Returns false if it has no times.
+    bool load_history(const fs::path& journal_file);
+
+    /// @brief Returns the number of PDFs with a known check time
+    size_t size() { return history_secs.size(); }
+
+    /// @brief Returns the estimated cost of checking a PDF. Thread-safe.
+    double estimate(const fs::path& pdf_file, const uintmax_t size) const;
+};
+
+
+/// @class CRunMetrics
+/// Progress of a corpus run (--metrics). A background thread rewrites the metrics file in the
+/// Prometheus textfile collector format every few seconds. Workers only update atomic counters,
+/// plus the PDF they are checking once per PDF, so they never wait for the writer. The object
+/// counter is in shared memory (POSIX) so that --isolate worker processes can add to it directly.
+class CRunMetrics {
+    /// @brief seconds between rewrites of the metrics file
+    static constexpr unsigned int INTERVAL_SECS = 10;
+
+    /// @brief PDF currently being checked by a worker
+    struct worker_slot {
+        std::mutex                              s_mutex;    // only held to set or copy pdf_file
+        std::string                             pdf_file;   // empty if idle
+        std::chrono::steady_clock::time_point   started;
+    };
+
+    fs::path                                    metrics_file;
+    std::vector<std::unique_ptr<worker_slot>>   slots;
+    std::chrono::steady_clock::time_point       start_time;
+    std::atomic<uint64_t>*                      objects;    // PDF objects checked (see get_object_counter())
+    bool                                        objects_shared;
+    std::thread                                 writer;
+    std::mutex                                  stop_mutex;
+    std::condition_variable                     stop_cv;
+    bool                                        stopping = false;
+
+    /// @brief Writes the metrics file (atomically, via a temporary file)
+    bool write();
+
+public:
+    std::atomic<uint64_t>       files_found;        // PDFs to check found so far
+    std::atomic<uint64_t>       files_done;         // PDFs checked
+    std::atomic<uint64_t>       bytes_done;         // total size of PDFs checked
+    std::atomic<uint64_t>       files_fatal;        // PDFs with a fatal error
+    std::atomic<uint64_t>       worker_failures;    // --isolate worker processes that crashed, timed out, etc.
+    std::atomic<unsigned int>   worker_peak_mb;     // highest peak memory of any --isolate worker process
+    std::atomic<bool>           all_found;          // all inputs have been traversed
+
+    CRunMetrics();
+    ~CRunMetrics();
+
+    /// @brief Starts the background thread that writes the metrics file
+    bool start(const fs::path& file, const unsigned int workers);
+
+    /// @brief Returns true if --metrics is being used
+    bool is_enabled() { return !metrics_file.empty(); }
+
+    /// @brief Counter for arl_options::objects_checked, or nullptr if not enabled
+    std::atomic<uint64_t>* get_object_counter() { return (is_enabled() ? objects : nullptr); }
+
+    /// @brief Sets the PDF a worker is checking (empty if idle)
+    void set_current(const unsigned int worker, const fs::path& pdf_file);
+
+    /// @brief Counts a finished PDF. Thread-safe without locks.
+    void finished(const uintmax_t size, const bool ok, const bool failed = false, const unsigned int peak_mb = 0);
+
+    /// @brief Stops the background thread and writes the final metrics
+    void stop();
+};
+
+#endif // PDFJobs_h
@@ -38,6 +38,7 @@
 #include <math.h>
 #include <cassert>
 #include <regex>
+#include <chrono>
 
 using namespace ArlingtonPDFShim;
 namespace fs = std::filesystem;
@@ -51,25 +52,14 @@ namespace fs = std::filesystem;
 #undef CHECKS_DEBUG
 
 
-/// @brief Locates & reads in a single Arlington TSV grammar file. The input data is not altered or validated.
+/// @brief Locates & reads in a single Arlington TSV grammar file via the shared grammar cache.
 ///
 /// @param[in] link   the stub name of an Arlington TSV grammar file from the TSV data (i.e. without folder or ".tsv" extension)
 ///
 /// @returns          a row/column matrix (vector of vector) of raw strings directly from the TSV file
 const ArlTSVmatrix& CParsePDF::get_grammar(const std::string &link)
 {
-    auto it = grammar_map.find(link);
-    if (it == grammar_map.end())
-    {
-        fs::path grammar_file = grammar_folder;
-        grammar_file /= link + ".tsv";
-        std::unique_ptr<CArlingtonTSVGrammarFile> reader(new CArlingtonTSVGrammarFile(grammar_file));
-        reader->load();
-        const ArlTSVmatrix& to_ret = reader->get_data();
-        grammar_map.insert(std::make_pair(link, std::move(reader)));
-        return to_ret;
-    }
-    return it->second->get_data();
+    return grammar_cache.get_grammar(link);
 }
 
 
@@ -82,7 +72,7 @@ const ArlTSVmatrix& CParsePDF::get_grammar(const std::string &link)
 bool CParsePDF::check_numeric_array(ArlPDFArray* arr, const int elems_to_check) {
     bool retval = true;
     int  max_len = arr->get_num_elements();
-    for (auto i = 0; i < std::min(elems_to_check, max_len); i++) {
+    for (auto i = 0; (i < std::min(elems_to_check, max_len)) && !past_deadline(); i++) {
         ArlPDFObject* elem = arr->get_value(i);
         retval = retval && ((elem != nullptr) && (elem->get_object_type() == PDFObjectType::ArlPDFObjTypeNumber));
         delete elem;
@@ -91,18 +81,51 @@ bool CParsePDF::check_numeric_array(ArlPDFArray* arr, const int elems_to_check)
 }
 
 
+/// @brief Returns the best score any PDF object could possibly achieve against each row of an Arlington
+/// TSV file, as a suffix sum (i.e. element [i] is the best score possible from rows i ... N-1). Used to stop
+/// scoring a link as soon as it can no longer beat the best link found so far.
+/// Includes the per-matched-row bonus for when all required keys are good (see recommended_link_for_object()).
+///
+/// @param[in] link   the stub name of an Arlington TSV grammar file
+///
+/// @returns  suffix sums of the best possible per-row scores. One more element than the TSV has rows.
+const std::vector<int>& CParsePDF::get_best_row_scores(const std::string& link)
+{
+    auto it = best_row_scores.find(link);
+    if (it != best_row_scores.end())
+        return it->second;
+
+    const ArlTSVmatrix& data_list = get_grammar(link);
+    std::vector<int> best(data_list.size() + 1, 0);
+    for (int i = (int)data_list.size() - 1; i >= 0; i--) {
+        const std::string& k = data_list[i][TSV_KEYNAME];
+        int row_best;
+        if ((k == "Type") || (k == "Subtype") || (k == "S") || (k == "Parent") || (k == "TransformMethod"))
+            row_best = -80;
+        else if (k == "0")
+            row_best = -60;
+        else
+            row_best = -10;
+        best[i] = best[i + 1] + row_best - 8;
+    }
+    return best_row_scores.insert(std::make_pair(link, best)).first->second;
+}
+
+
 ///@brief  Choose a specific link for a PDF object from a provided set of Arlington links to validate further.
 /// Select a link with as many required values with matching "Possible Values" as possible.
 /// Sometimes required values are missing, are inherited, etc.
 /// Scoring mechanism is used (lower score = better, like golf):
 /// Arlington grammar file with the lowest score is our selected link (like golf).
+/// The outcome for indirect objects is remembered per link set, as shared objects (fonts, resources, etc.)
+/// are reached through many different links.
 ///
 /// @param[in]  obj          the PDF object in question
 /// @param[in]  links        vector of Arlington 'Links' to try (predicates are SAFE)
 /// @param[in]  obj_name     the path of the PDF object in the PDF file
 ///
 /// @returns a single Arlington link that is the best match for the given PDF object. Or "" if no link.
-std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std::vector<std::string> links, const std::string obj_name) {
+std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std::vector<std::string>& links, const std::string& obj_name) {
     assert(obj != nullptr);
 
     if (links.size() == 0) // Nothing to choose from
@@ -111,6 +134,55 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
     if (links.size() == 1)  // Choice of 1
         return links[0];
 
+    int to_ret;
+    if (obj->is_indirect_ref()) {
+        // Direct objects share their parent's object number so cannot be remembered
+        std::string link_set;
+        for (auto& l : links)
+            link_set += ";" + l;
+        int link_set_id = link_set_ids.emplace(link_set, (int)link_set_ids.size()).first->second;
+        auto memo_key = std::make_pair(object_key(obj), link_set_id);
+        auto found = link_scores.find(memo_key);
+        if (found != link_scores.end())
+            to_ret = found->second;
+        else {
+            to_ret = score_links_for_object(obj, links, obj_name);
+            link_scores.insert(std::make_pair(memo_key, to_ret));
+        }
+    }
+    else
+        to_ret = score_links_for_object(obj, links, obj_name);
+
+    // lowest score wins
+    if (to_ret >= 0)
+        return links[to_ret];
+
+    add_finding(ArlMessageCode::NoLink, "", "", obj, strip_leading_whitespace(obj_name), PDFObjectType_strings[(int)obj->get_object_type()]);
+    if (format == ReportFormat::JSONL)
+        write_jsonl_message(output, ArlMessageCode::NoLink, "", "", obj, pdf_version, strip_leading_whitespace(obj_name), PDFObjectType_strings[(int)obj->get_object_type()]);
+    else {
+        output << COLOR_ERROR << "can't select any Link to validate PDF object " << strip_leading_whitespace(obj_name) << " as " << PDFObjectType_strings[(int)obj->get_object_type()];
+        if (debug_mode)
+            output << " (" << *obj << ")";
+        output << COLOR_RESET;
+    }
+    return "";
+}
+
+
+/// @brief  Scores each of the provided set of Arlington links against a PDF object. See recommended_link_for_object().
+/// Scoring of a link stops as soon as it can no longer beat the best link found so far.
+///
+/// @param[in]  obj          the PDF object in question
+/// @param[in]  links        vector of Arlington 'Links' to try (predicates are SAFE). At least 2.
+/// @param[in]  obj_name     the path of the PDF object in the PDF file
+///
+/// @returns the index into links of the link with the lowest score. Or -1 if no link.
+int CParsePDF::score_links_for_object(ArlPDFObject* obj, const std::vector<std::string>& links, const std::string& obj_name) {
+    assert(obj != nullptr);
+    assert(links.size() > 1);
+    UNREFERENCED_FORMAL_PARAM(obj_name);
+
     auto obj_type = obj->get_object_type();
 
     int  to_ret = -1;
@@ -146,9 +218,27 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
 
             int num_keys_matched = 0;
             bool a_required_key_was_bad = false;
+            bool pruned = false;
+            const std::vector<int>& best_scores = get_best_row_scores(links[i]);
+            ArlPDFDictionary* stmDictObj = nullptr;
+            if (obj_type == PDFObjectType::ArlPDFObjTypeStream)
+                stmDictObj = ((ArlPDFStream*)obj)->get_dictionary();
             PredicateProcessor pp(pdfc, data_list);
             for (auto& vec : data_list) {
                 key_idx++;
+
+                // Stop if this link cannot beat the best link so far, even if all remaining rows were perfect matches.
+                // The bonus of up to -10 for the proportion of keys matched is applied at the end.
+                int best_possible = link_score + best_scores[key_idx] - 10;
+                if (a_required_key_was_bad)
+                    best_possible += 8 * ((int)data_list.size() - key_idx); // no bonus for matched keys
+                else
+                    best_possible += -8 * num_keys_matched;
+                if (best_possible >= min_score) {
+                    pruned = true;
+                    break;
+                }
+
                 ArlPDFObject* inner_object = nullptr;
                 switch (obj_type) {
                     case PDFObjectType::ArlPDFObjTypeArray:
@@ -167,12 +257,8 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
                         }
                         break;
                     case PDFObjectType::ArlPDFObjTypeStream:
-                        {
-                            ArlPDFDictionary* stmDictObj = ((ArlPDFStream*)obj)->get_dictionary();
-                            if (stmDictObj->has_key(utf8ToUtf16(vec[TSV_KEYNAME])))
-                                inner_object = stmDictObj->get_value(utf8ToUtf16(vec[TSV_KEYNAME]));
-                            delete stmDictObj;
-                        }
+                        if (stmDictObj->has_key(utf8ToUtf16(vec[TSV_KEYNAME])))
+                            inner_object = stmDictObj->get_value(utf8ToUtf16(vec[TSV_KEYNAME]));
                         break;
                     default:
                         assert(false && "Unexpected object type in recommended_link_for_object()!");
@@ -267,6 +353,14 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
                     }
                 }
             } // for-each key in TSV
+            delete stmDictObj;
+
+            if (pruned) {
+#if defined(SCORING_DEBUG)
+                std::cout << " Cannot beat score " << min_score << " so stopped." << std::endl;
+#endif
+                continue;
+            }
 
             // If all required keys were good then get a bonus weighting to definitions with less keys
             assert(num_keys_matched <= (int)data_list.size());
@@ -290,45 +384,34 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
         } // if (dict || stream || array)
     } // for
 
-    // lowest score wins
-    if (to_ret >= 0) {
 #if defined(SCORING_DEBUG)
+    if (to_ret >= 0)
         std::cout << "\tOutcome: " << *obj << " as " << links[to_ret] << " with score " << min_score << std::endl;
 #endif
-        return links[to_ret];
-    }
-
-    output << COLOR_ERROR << "can't select any Link to validate PDF object " << strip_leading_whitespace(obj_name) << " as " << PDFObjectType_strings[(int)obj_type];
-    if (debug_mode)
-        output << " (" << *obj << ")";
-    output << COLOR_RESET;
-    return "";
+    return to_ret;
 }
 
 
-/// @brief  Recursively looks for 'key' via inheritance (i.e. through "/Parent" keys)
+/// @brief  Looks for 'key' via inheritance (i.e. through "/Parent" keys) using the per-document
+///         page tree cache in CPDFFile
 ///
 /// @param[in] obj
 /// @param[in] key        the key to find
-/// @param[in] depth      recursive depth (in case of malformed PDFs to stop infinite loops!)
 ///
 /// @returns nullptr if 'key' is NOT located via inheritance, otherwise the PDF object which matches BY KEYNAME!
-ArlPDFObject* CParsePDF::find_via_inheritance(ArlPDFDictionary* obj, const std::wstring& key, const int depth) {
+ArlPDFObject* CParsePDF::find_via_inheritance(ArlPDFDictionary* obj, const std::wstring& key) {
     assert(obj != nullptr);
+    assert(pdfc != nullptr);
+    int depth;
+    ArlPDFObject* key_obj = pdfc->get_inherited_value(obj, key, depth);
     if (depth > 250) {
-        output << COLOR_ERROR << "recursive inheritance depth of " << depth << " exceeded for " << ToUtf8(key) << COLOR_RESET;
-        return nullptr;
-    }
-    ArlPDFObject* parent = obj->get_value(L"Parent");
-    if ((parent != nullptr) && (parent->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-        ArlPDFDictionary* parent_dict = (ArlPDFDictionary*)parent;
-        ArlPDFObject* key_obj = parent_dict->get_value(key);
-if (key_obj == nullptr)
-key_obj = find_via_inheritance(parent_dict, key, depth + 1);
-delete parent;
-return key_obj;
+        add_finding(ArlMessageCode::InheritanceTooDeep, "", ToUtf8(key), obj, "", std::to_string(depth));
+        if (format == ReportFormat::JSONL)
+            write_jsonl_message(output, ArlMessageCode::InheritanceTooDeep, "", ToUtf8(key), obj, pdf_version, "", std::to_string(depth));
+        else
+            output << COLOR_ERROR << "recursive inheritance depth of " << depth << " exceeded for " << ToUtf8(key) << COLOR_RESET;
     }
-    return nullptr;
+    return key_obj;
 }
 
 
@@ -351,8 +434,6 @@ void CParsePDF::check_everything(ArlPDFObject* parent, ArlPDFObject* object, con
     assert(key_index >= 0);
     auto obj_type = object->get_object_type();
 
-    queue_elem fake_e(parent, object, grammar_file, context);
-
     // Need to cope with wildcard keys "*" or <digit>* for arrays in TSV data as key_index might be beyond rows in tsv_data[]
     int key_idx = key_index;
     if (key_index >= (int)tsv_data.size()) {
@@ -378,12 +459,13 @@ void CParsePDF::check_everything(ArlPDFObject* parent, ArlPDFObject* object, con
     // Ignore null as this is the same as nonexistent
     if ((!versioner.object_matched_arlington_type() || (obj_type == PDFObjectType::ArlPDFObjTypeNull))) {
         if (obj_type != PDFObjectType::ArlPDFObjTypeNull) {
-            show_context(fake_e);
-            ofs << COLOR_ERROR << "wrong type: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
-            ofs << " should be " << tsv_data[key_idx][TSV_TYPE] << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << " and is " << versioner.get_object_arlington_type();
-            if (debug_mode)
-                ofs << " (" << *object << ")";
-            ofs << COLOR_RESET;
+            if (report(ArlMessageCode::WrongType, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME], versioner.get_object_arlington_type())) {
+                ofs << COLOR_ERROR << "wrong type: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+                ofs << " should be " << tsv_data[key_idx][TSV_TYPE] << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << " and is " << versioner.get_object_arlington_type();
+                if (debug_mode)
+                    ofs << " (" << *object << ")";
+                ofs << COLOR_RESET;
+            }
         }
 #ifdef CHECKS_DEBUG
         ofs << std::endl;
@@ -397,83 +479,102 @@ void CParsePDF::check_everything(ArlPDFObject* parent, ArlPDFObject* object, con
     // Also treat null object as though the key is nonexistent (i.e. don't report an error)
     if ((ir == ReferenceType::MustBeIndirect) && (!object->is_indirect_ref() &&
         (obj_type != PDFObjectType::ArlPDFObjTypeNull) && (obj_type != PDFObjectType::ArlPDFObjTypeReference))) {
-        show_context(fake_e);
-        ofs << COLOR_ERROR << "not an indirect reference as required: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") ";
-        ofs << "in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+        if (report(ArlMessageCode::NotIndirect, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME])) {
+            ofs << COLOR_ERROR << "not an indirect reference as required: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") ";
+            ofs << "in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+        }
     }
 
-    // String-ify the value of the PDF object for potential output messages
-    std::wstring        str_value;
-    double              num_value;
-    switch (object->get_object_type())
+    // The value of the PDF object as text for messages. Only created when a message needs it.
+    auto value_as_text = [object, obj_type]() -> std::wstring {
+        switch (obj_type) {
+        case PDFObjectType::ArlPDFObjTypeBoolean:
+            return (((ArlPDFBoolean*)object)->get_value() ? L"true" : L"false");
+        case PDFObjectType::ArlPDFObjTypeNumber:
+            if (((ArlPDFNumber*)object)->is_integer_value())
+                return std::to_wstring(((ArlPDFNumber*)object)->get_integer_value());
+            return std::to_wstring(((ArlPDFNumber*)object)->get_value());
+        case PDFObjectType::ArlPDFObjTypeString:
+            return ((ArlPDFString*)object)->get_value();
+        case PDFObjectType::ArlPDFObjTypeName:
+            return ((ArlPDFName*)object)->get_value();
+        default:
+            return L"";
+        }
+    };
+
+    // The value of the PDF object for JSON Lines messages. Encrypted strings are not output.
+    auto message_value = [&]() -> std::string {
+        if ((format == ReportFormat::Text) || !FindInVector(v_ArlNonComplexTypes, versioner.get_object_arlington_type()))
+            return "";
+        if ((versioner.get_object_arlington_type().find("string") != std::string::npos) && pdfc->get_ptr_to_trailer()->is_unsupported_encryption())
+            return "";
+        return ToUtf8(value_as_text());
+    };
+
+    switch (obj_type)
     {
-    case PDFObjectType::ArlPDFObjTypeBoolean:
-        if (((ArlPDFBoolean*)object)->get_value())
-            str_value = L"true";
-        else
-            str_value = L"false";
-        break;
-
     case PDFObjectType::ArlPDFObjTypeNumber:
             {
                 ArlPDFNumber* numobj = (ArlPDFNumber*)object;
                 if (numobj->is_integer_value()) {
                     long long ivalue = numobj->get_integer_value();
-                    str_value = std::to_wstring(ivalue);
                     if ((arl_type == "bitmask") && (ivalue > 0xFFFFFFFF)) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "bitmask was not a 32-bit value for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        if (report(ArlMessageCode::BitmaskNot32Bit, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME]))
+                            ofs << COLOR_WARNING << "bitmask was not a 32-bit value for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                     if (((ivalue > 2147483647LL) || (ivalue < -2147483648LL)) && (pdf_version <= 17)) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "integer value exceeds PDF 1.x integer range for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        if (report(ArlMessageCode::IntegerOutOfRange, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME]))
+                            ofs << COLOR_WARNING << "integer value exceeds PDF 1.x integer range for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
                 else {
-                    num_value = numobj->get_value();
-                    str_value = std::to_wstring(num_value);
                     if (arl_type == "bitmask") {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "bitmask was not an integer value for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        if (report(ArlMessageCode::BitmaskNotInteger, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME]))
+                            ofs << COLOR_WARNING << "bitmask was not an integer value for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
             }
             break;
 
         case PDFObjectType::ArlPDFObjTypeName:
-            str_value = ((ArlPDFName*)object)->get_value();
-            if ((str_value.size() > 127) && (pdf_version <= 17)) {
-                show_context(fake_e);
-                ofs << COLOR_WARNING << "PDF 1.x names were limited to 127 bytes (was " << str_value.size() << ") for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+            if ((((ArlPDFName*)object)->get_raw_bytes().size() > 127) && (pdf_version <= 17)) {
+                if (report(ArlMessageCode::NameTooLong, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME]))
+                    ofs << COLOR_WARNING << "PDF 1.x names were limited to 127 bytes (was " << ((ArlPDFName*)object)->get_raw_bytes().size() << ") for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
             }
             break;
 
         case PDFObjectType::ArlPDFObjTypeString:
             {
-                str_value = ((ArlPDFString*)object)->get_value();
+                // Checks are done on the raw bytes. Only decode to text when a date or message needs it
+                std::string_view raw_value = ((ArlPDFString*)object)->get_raw_bytes();
                 auto t = pdfc->get_ptr_to_trailer();
                 // Warn if string starts with UTF-16LE byte-order-marker - DEPENDS ON PDF SDK!
-                if ((str_value.size() >= 2) && (str_value[0] == 255) && (str_value[1] == 254) && !t->is_unsupported_encryption()) {
-                    show_context(fake_e);
-                    ofs << COLOR_WARNING << "string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") starts with UTF-16LE byte order marker" << COLOR_RESET;
+                if ((raw_value.size() >= 2) && ((uint8_t)raw_value[0] == 255) && ((uint8_t)raw_value[1] == 254) && !t->is_unsupported_encryption()) {
+                    if (report(ArlMessageCode::StringUTF16LE, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME]))
+                        ofs << COLOR_WARNING << "string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") starts with UTF-16LE byte order marker" << COLOR_RESET;
                 }
                 // Warn if an ASCII string contains bytes in the unprintable area of ASCII (based on C++ isprint())
                 if ((arl_type == "string-ascii") && !t->is_unsupported_encryption()) {
                     bool pure_ascii = true;
-                    for (size_t i = 0; i < str_value.size(); i++)
-                        pure_ascii = pure_ascii && isprint(str_value[i]);
+                    for (size_t i = 0; pure_ascii && (i < raw_value.size()); i++)
+                        pure_ascii = isprint((uint8_t)raw_value[i]);
                     if (!pure_ascii) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "ASCII string contained at least one unprintable byte for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        if (report(ArlMessageCode::StringUnprintable, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME]))
+                            ofs << COLOR_WARNING << "ASCII string contained at least one unprintable byte for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
                 // If Arlington says it is a date string then check if PDF string complies
-                if ((arl_type == "date") && (!is_valid_pdf_date_string(str_value))) {
-                    show_context(fake_e);
-                    if (!t->is_unsupported_encryption())
-                        ofs << COLOR_ERROR << "invalid date string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << "): \"" << ToUtf8(str_value) << "\"" << COLOR_RESET;
-                    else
-                        ofs << COLOR_WARNING << "possibly invalid date string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - unsupported encryption" << COLOR_RESET;
+                if (arl_type == "date") {
+                    std::wstring date_value = ((ArlPDFString*)object)->get_value();
+                    if (!is_valid_pdf_date_string(date_value)) {
+                        if (!t->is_unsupported_encryption()) {
+                            if (report(ArlMessageCode::InvalidDate, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME], ToUtf8(date_value)))
+                                ofs << COLOR_ERROR << "invalid date string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << "): \"" << ToUtf8(date_value) << "\"" << COLOR_RESET;
+                        }
+                        else if (report(ArlMessageCode::PossiblyInvalidDate, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME]))
+                            ofs << COLOR_WARNING << "possibly invalid date string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - unsupported encryption" << COLOR_RESET;
+                    }
                 }
             }
             break;
@@ -484,22 +585,22 @@ void CParsePDF::check_everything(ArlPDFObject* parent, ArlPDFObject* object, con
                 int arr_len = ((ArlPDFArray*)object)->get_num_elements();
                 if (arl_type == "rectangle") {
                     if (arr_len != 4) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "rectangle does not have exactly 4 elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - had " << arr_len << COLOR_RESET;
+                        if (report(ArlMessageCode::RectangleLength, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME], std::to_string(arr_len)))
+                            ofs << COLOR_WARNING << "rectangle does not have exactly 4 elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - had " << arr_len << COLOR_RESET;
                     }
                     if (!check_numeric_array((ArlPDFArray*)object, 4)) {
-                        show_context(fake_e);
-                        ofs << COLOR_ERROR << "rectangle does not have 4 numeric elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        if (report(ArlMessageCode::RectangleNotNumeric, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME]))
+                            ofs << COLOR_ERROR << "rectangle does not have 4 numeric elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
                 if (arl_type == "matrix") {
                     if (arr_len != 6) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "matrix does not have exactly 6 elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - had " << arr_len << COLOR_RESET;
+                        if (report(ArlMessageCode::MatrixLength, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME], std::to_string(arr_len)))
+                            ofs << COLOR_WARNING << "matrix does not have exactly 6 elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - had " << arr_len << COLOR_RESET;
                     }
                     if (!check_numeric_array((ArlPDFArray*)object, 6)) {
-                        show_context(fake_e);
-                        ofs << COLOR_ERROR << "matrix does not have 6 numeric elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        if (report(ArlMessageCode::MatrixNotNumeric, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME]))
+                            ofs << COLOR_ERROR << "matrix does not have 6 numeric elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
             }
@@ -516,28 +617,30 @@ void CParsePDF::check_everything(ArlPDFObject* parent, ArlPDFObject* object, con
     ofs << "SpecialCase = {" << (checks_passed ? "OK" : "not OK") << (pp.WasFullyImplemented() ? "" : ",partial implementation") << (pp.SomethingWasDeprecated() ? ",deprecated" : "") << "} ";
 #endif
     if (!checks_passed || !pp.WasFullyImplemented()) {
-        show_context(fake_e);
-        // If predicates ARE fully processed then we know it is the right or wrong value.
-        // If predicates are partially processed then just a warning with additional output
-        if (!pp.WasFullyImplemented())
-            ofs << COLOR_WARNING << "special case possibly incorrect (some predicates NOT supported): " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
-        else
-            ofs << COLOR_ERROR << "special case not correct: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
-        ofs << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-        ofs << " should be: " << tsv_data[key_idx][TSV_TYPE] << " " << tsv_data[key_idx][TSV_SPECIALCASE];
-        if (FindInVector(v_ArlNonComplexTypes, versioner.get_object_arlington_type())) {
-            auto t = pdfc->get_ptr_to_trailer();
-            if ((versioner.get_object_arlington_type().find("string") != std::string::npos) && t->is_unsupported_encryption()) {
-                // Don't output encrypted strings
-                ofs << " - string when unsupported encryption";
-            }
-            else {
-                ofs << " and is " << versioner.get_object_arlington_type() << "==" << ToUtf8(str_value);
-                if (debug_mode)
-                    ofs << " (" << *object << ")";
+        ArlMessageCode code = (pp.WasFullyImplemented() ? ArlMessageCode::SpecialCaseWrong : ArlMessageCode::SpecialCasePossiblyWrong);
+        if (report(code, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME], message_value())) {
+            // If predicates ARE fully processed then we know it is the right or wrong value.
+            // If predicates are partially processed then just a warning with additional output
+            if (!pp.WasFullyImplemented())
+                ofs << COLOR_WARNING << "special case possibly incorrect (some predicates NOT supported): " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+            else
+                ofs << COLOR_ERROR << "special case not correct: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+            ofs << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+            ofs << " should be: " << tsv_data[key_idx][TSV_TYPE] << " " << tsv_data[key_idx][TSV_SPECIALCASE];
+            if (FindInVector(v_ArlNonComplexTypes, versioner.get_object_arlington_type())) {
+                auto t = pdfc->get_ptr_to_trailer();
+                if ((versioner.get_object_arlington_type().find("string") != std::string::npos) && t->is_unsupported_encryption()) {
+                    // Don't output encrypted strings
+                    ofs << " - string when unsupported encryption";
+                }
+                else {
+                    ofs << " and is " << versioner.get_object_arlington_type() << "==" << ToUtf8(value_as_text());
+                    if (debug_mode)
+                        ofs << " (" << *object << ")";
+                }
             }
+            ofs << COLOR_RESET;
         }
-        ofs << COLOR_RESET;
     }
 
     // Check value against Arlington PossibleValue field
@@ -547,27 +650,29 @@ void CParsePDF::check_everything(ArlPDFObject* parent, ArlPDFObject* object, con
     ofs << "PossibleValues = {" << (checks_passed ? "OK" : "not OK") << (pp.WasFullyImplemented() ? "" : ",partial implementation") << (pp.SomethingWasDeprecated() ? ",deprecated" : "") << "} ";
 #endif
     if (!checks_passed || !pp.WasFullyImplemented()) {
-        show_context(fake_e);
-        // If predicates ARE fully processed then we know it is the right or wrong value.
-        // If predicates are partially processed then just a warning with additional output
-        if (!pp.WasFullyImplemented())
-            ofs << COLOR_WARNING << "possibly wrong value for possible values (some predicates NOT supported): " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
-        else
-            ofs << COLOR_ERROR << "wrong value for possible values: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
-        ofs << " should be: " << tsv_data[key_idx][TSV_TYPE] << " " << tsv_data[key_idx][TSV_POSSIBLEVALUES] << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-        if (FindInVector(v_ArlNonComplexTypes, versioner.get_object_arlington_type())) {
-            auto t = pdfc->get_ptr_to_trailer();
-            if ((versioner.get_object_arlington_type().find("string") != std::string::npos) && t->is_unsupported_encryption()) {
-                // Don't output encrypted strings
-                ofs << " - string when unsupported encryption";
-            }
-            else {
-                ofs << " and is " << versioner.get_object_arlington_type() << "==" << ToUtf8(str_value);
-                if (debug_mode)
-                    ofs << " (" << *object << ")";
+        ArlMessageCode code = (pp.WasFullyImplemented() ? ArlMessageCode::WrongValue : ArlMessageCode::PossiblyWrongValue);
+        if (report(code, object, context, grammar_file, tsv_data[key_idx][TSV_KEYNAME], message_value())) {
+            // If predicates ARE fully processed then we know it is the right or wrong value.
+            // If predicates are partially processed then just a warning with additional output
+            if (!pp.WasFullyImplemented())
+                ofs << COLOR_WARNING << "possibly wrong value for possible values (some predicates NOT supported): " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+            else
+                ofs << COLOR_ERROR << "wrong value for possible values: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+            ofs << " should be: " << tsv_data[key_idx][TSV_TYPE] << " " << tsv_data[key_idx][TSV_POSSIBLEVALUES] << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+            if (FindInVector(v_ArlNonComplexTypes, versioner.get_object_arlington_type())) {
+                auto t = pdfc->get_ptr_to_trailer();
+                if ((versioner.get_object_arlington_type().find("string") != std::string::npos) && t->is_unsupported_encryption()) {
+                    // Don't output encrypted strings
+                    ofs << " - string when unsupported encryption";
+                }
+                else {
+                    ofs << " and is " << versioner.get_object_arlington_type() << "==" << ToUtf8(value_as_text());
+                    if (debug_mode)
+                        ofs << " (" << *object << ")";
+                }
             }
+            ofs << COLOR_RESET;
         }
-        ofs << COLOR_RESET;
     }
 #ifdef CHECKS_DEBUG
     ofs << std::endl;
@@ -580,19 +685,27 @@ void CParsePDF::check_everything(ArlPDFObject* parent, ArlPDFObject* object, con
 /// @param[in]     obj          PDF name tree object (dictionary)
 /// @param[in]     links        set of Arlington links (predicates are SAFE)
 /// @param[in,out] context
+/// @param[in]     loc          where obj was reached from (only for low_memory)
 /// @param[in]     root         true if the root node of a Name tree
-void CParsePDF::parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::string> &links, const std::string context, const bool root) {
+void CParsePDF::parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::string> &links, const std::string context, const obj_location& loc, const bool root) {
     assert(obj != nullptr);
     assert(obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary);
     ArlPDFObject *kids_obj   = obj->get_value(L"Kids");
     ArlPDFObject *names_obj  = obj->get_value(L"Names");
     //ArlPDFObject *limits_obj = obj->get_value(L"Limits");
 
-    queue_elem fake_e(nullptr, obj, "name-tree", context);
+    // --low-memory: tree nodes stay loaded while their values are spilled (see flush_spill())
+    const int node_nbrs[] = { obj->get_object_number(), (kids_obj != nullptr) ? kids_obj->get_object_number() : 0, (names_obj != nullptr) ? names_obj->get_object_number() : 0 };
+    if (low_memory)
+        for (int n : node_nbrs)
+            pin_object(n);
+    obj_location node_loc = object_location(obj, loc);
+    obj_location kids_loc = object_location(kids_obj, locate(node_loc, L"Kids"));
+    obj_location names_loc = object_location(names_obj, locate(node_loc, L"Names"));
 
     if ((names_obj != nullptr) && (names_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)) {
         ArlPDFArray *array_obj = (ArlPDFArray*)names_obj;
-        for (int i = 0; i < array_obj->get_num_elements(); i += 2) {
+        for (int i = 0; (i < array_obj->get_num_elements()) && !past_deadline(); i += 2) {
             // Pairs of entries: name (string), value. value has to be further validated
             ArlPDFObject* obj1 = array_obj->get_value(i);
 
@@ -604,23 +717,24 @@ void CParsePDF::parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::st
                     std::string  as = ToUtf8(str);
                     std::string  best_link = recommended_link_for_object(obj2, links, as);
                     if (best_link.size() > 0)
-                        add_parse_object(obj, obj2, best_link, context + "->[" + as + "]");
+                        add_parse_object(obj, obj2, best_link, context + "->[" + as + "]", locate(names_loc, i + 1));
                     else
                         delete obj2;
 
                 }
                 else {
                     // Error: name tree Names array did not have pairs of entries (obj2 == nullptr)
-                    show_context(fake_e);
-                    output << COLOR_ERROR << "name tree Names array element #" << i << " - missing 2nd element in a pair for " << strip_leading_whitespace(context) << COLOR_RESET;
+                    if (report(ArlMessageCode::NameTreeMissingValue, obj, context, "", "", std::to_string(i)))
+                        output << COLOR_ERROR << "name tree Names array element #" << i << " - missing 2nd element in a pair for " << strip_leading_whitespace(context) << COLOR_RESET;
                 }
             }
             else {
                 // Error: 1st in the pair was not OK
-                show_context(fake_e);
-                if (obj1 == nullptr)
-                    output << COLOR_ERROR << "name tree Names array element #" << i << " - 1st element in a pair returned null for " << strip_leading_whitespace(context) << COLOR_RESET;
-                else {
+                if (obj1 == nullptr) {
+                    if (report(ArlMessageCode::NameTreeNullKey, obj, context, "", "", std::to_string(i)))
+                        output << COLOR_ERROR << "name tree Names array element #" << i << " - 1st element in a pair returned null for " << strip_leading_whitespace(context) << COLOR_RESET;
+                }
+                else if (report(ArlMessageCode::NameTreeKeyNotString, obj, context, "", "", std::to_string(i))) {
                     output << COLOR_ERROR << "name tree Names array element #" << i << " - 1st element in a pair was not a string for " << strip_leading_whitespace(context);
                     if (debug_mode)
                         output << " (" << *obj1 << ")";
@@ -628,18 +742,21 @@ void CParsePDF::parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::st
                 }
             }
             delete obj1;
+            if (spill_file != nullptr)
+                flush_spill();
         }
     }
     else {
         // Table 36 Names: "Root and leaf nodes only; required in leaf nodes; present in the root node
         //                  if and only if Kids is not present"
         if (root && (kids_obj == nullptr)) {
-            show_context(fake_e);
-            if (names_obj == nullptr)
-                output << COLOR_ERROR << "name tree Names object was missing when Kids was also missing for " << strip_leading_whitespace(context);
-            else
-                output << COLOR_ERROR << "name tree Names object was not an array when Kids was also missing for " << strip_leading_whitespace(context);
-            output << COLOR_RESET;
+            if (report((names_obj == nullptr) ? ArlMessageCode::NameTreeNoNames : ArlMessageCode::NameTreeNamesNotArray, obj, context, "")) {
+                if (names_obj == nullptr)
+                    output << COLOR_ERROR << "name tree Names object was missing when Kids was also missing for " << strip_leading_whitespace(context);
+                else
+                    output << COLOR_ERROR << "name tree Names object was not an array when Kids was also missing for " << strip_leading_whitespace(context);
+                output << COLOR_RESET;
+            }
         }
     }
     delete names_obj;
@@ -647,28 +764,32 @@ void CParsePDF::parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::st
     if (kids_obj != nullptr) {
         if (kids_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeArray) {
             ArlPDFArray* array_obj = (ArlPDFArray*)kids_obj;
-            for (int i = 0; i < array_obj->get_num_elements(); i++) {
+            for (int i = 0; (i < array_obj->get_num_elements()) && !past_deadline(); i++) {
                 ArlPDFObject* item = array_obj->get_value(i);
                 if ((item != nullptr) && (item->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary))
-                    parse_name_tree((ArlPDFDictionary*)item, links, context, false);
+                    parse_name_tree((ArlPDFDictionary*)item, links, context, locate(kids_loc, i), false);
                 else {
                     // Error: individual kid isn't dictionary in PDF name tree
-                    show_context(fake_e);
-                    output << COLOR_ERROR << "name tree Kids array element number #" << i << " was not a dictionary for " << strip_leading_whitespace(context);
-                    if (debug_mode && (item != nullptr))
-                        output << " (" << *item << ")";
-                    output << COLOR_RESET;
+                    if (report(ArlMessageCode::NameTreeKidNotDictionary, obj, context, "", "", std::to_string(i))) {
+                        output << COLOR_ERROR << "name tree Kids array element number #" << i << " was not a dictionary for " << strip_leading_whitespace(context);
+                        if (debug_mode && (item != nullptr))
+                            output << " (" << *item << ")";
+                        output << COLOR_RESET;
+                    }
                 }
                 delete item;
             }
         }
         else {
             // error: Kids isn't array in PDF name tree
-            show_context(fake_e);
-            output << COLOR_ERROR << "name tree Kids object was not an array for " << strip_leading_whitespace(context) << COLOR_RESET;
+            if (report(ArlMessageCode::NameTreeKidsNotArray, obj, context, ""))
+                output << COLOR_ERROR << "name tree Kids object was not an array for " << strip_leading_whitespace(context) << COLOR_RESET;
         }
         delete kids_obj;
     }
+    if (low_memory)
+        for (int n : node_nbrs)
+            unpin_object(n, false);
 }
 
 
@@ -677,20 +798,28 @@ void CParsePDF::parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::st
 /// @param[in]     obj          PDF number tree object (dictionary)
 /// @param[in]     links        set of Arlington links (Predicates are SAFE!)
 /// @param[in,out] context
+/// @param[in]     loc          where obj was reached from (only for low_memory)
 /// @param[in]     root         true if the root node of a Name tree
-void CParsePDF::parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::string>&links, const std::string context, const bool root) {
+void CParsePDF::parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::string>&links, const std::string context, const obj_location& loc, const bool root) {
     assert(obj != nullptr);
     assert(obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary);
     ArlPDFObject *kids_obj   = obj->get_value(L"Kids");
     ArlPDFObject *nums_obj   = obj->get_value(L"Nums");
     // ArlPDFObject *limits_obj = obj->get_value(L"Limits");
 
-    queue_elem fake_e(nullptr, obj, "number-tree", context);
+    // --low-memory: tree nodes stay loaded while their values are spilled (see flush_spill())
+    const int node_nbrs[] = { obj->get_object_number(), (kids_obj != nullptr) ? kids_obj->get_object_number() : 0, (nums_obj != nullptr) ? nums_obj->get_object_number() : 0 };
+    if (low_memory)
+        for (int n : node_nbrs)
+            pin_object(n);
+    obj_location node_loc = object_location(obj, loc);
+    obj_location kids_loc = object_location(kids_obj, locate(node_loc, L"Kids"));
+    obj_location nums_loc = object_location(nums_obj, locate(node_loc, L"Nums"));
 
     if (nums_obj != nullptr) {
         if (nums_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeArray) {
             ArlPDFArray *array_obj = (ArlPDFArray*)nums_obj;
-            for (int i = 0; i < array_obj->get_num_elements(); i += 2) {
+            for (int i = 0; (i < array_obj->get_num_elements()) && !past_deadline(); i += 2) {
                 // Pairs of entries: number, value. value has to be validated
                 ArlPDFObject* obj1 = array_obj->get_value(i);
 
@@ -703,37 +832,40 @@ void CParsePDF::parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::
                             std::string  as = std::to_string(val);
                             std::string  best_link = recommended_link_for_object(obj2, links, as);
                             if (best_link.size() > 0)
-                                add_parse_object(obj, obj2, best_link, context + "->[" + as + "]");
+                                add_parse_object(obj, obj2, best_link, context + "->[" + as + "]", locate(nums_loc, i + 1));
                             else
                                 delete obj2;
                         }
                         else {
                             // Error: every even entry in a number tree Nums array are supposed be objects
-                            show_context(fake_e);
-                            output << COLOR_ERROR << "number tree Nums array element #" << i << " was null for " << strip_leading_whitespace(context) << COLOR_RESET;
+                            if (report(ArlMessageCode::NumberTreeNullValue, obj, context, "", "", std::to_string(i)))
+                                output << COLOR_ERROR << "number tree Nums array element #" << i << " was null for " << strip_leading_whitespace(context) << COLOR_RESET;
                         }
                     }
                     else {
                         // Error: every odd entry in a number tree Nums array are supposed be integers
-                        show_context(fake_e);
-                        output << COLOR_ERROR << "number tree Nums array element #" << i << " was not an integer for " << strip_leading_whitespace(context);
-                        if (debug_mode)
-                            output << " (" << *obj1 << ")";
-                        output << COLOR_RESET;
+                        if (report(ArlMessageCode::NumberTreeKeyNotInteger, obj, context, "", "", std::to_string(i))) {
+                            output << COLOR_ERROR << "number tree Nums array element #" << i << " was not an integer for " << strip_leading_whitespace(context);
+                            if (debug_mode)
+                                output << " (" << *obj1 << ")";
+                            output << COLOR_RESET;
+                        }
                     }
                     delete obj1;
                 }
                 else {
                     // Error: one of the pair of objects was not OK in PDF number tree
-                    show_context(fake_e);
-                    output << COLOR_ERROR << "number tree Nums array was invalid for " << strip_leading_whitespace(context) << COLOR_RESET;
+                    if (report(ArlMessageCode::NumberTreeNumsInvalid, obj, context, ""))
+                        output << COLOR_ERROR << "number tree Nums array was invalid for " << strip_leading_whitespace(context) << COLOR_RESET;
                 }
+                if (spill_file != nullptr)
+                    flush_spill();
             } // for
         }
         else {
             // Error: Nums isn't an array in PDF number tree
-            show_context(fake_e);
-            output << COLOR_ERROR << "number tree Nums object was not an array for " << strip_leading_whitespace(context) << COLOR_RESET;
+            if (report(ArlMessageCode::NumberTreeNumsNotArray, obj, context, ""))
+                output << COLOR_ERROR << "number tree Nums object was not an array for " << strip_leading_whitespace(context) << COLOR_RESET;
         }
         delete nums_obj;
     }
@@ -741,51 +873,74 @@ void CParsePDF::parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::
         // Table 37 Nums: "Root and leaf nodes only; shall be required in leaf nodes;
         //                 present in the root node if and only if Kids is not present
         if (root && (kids_obj == nullptr)) {
-            show_context(fake_e);
-            output << COLOR_ERROR << "number tree Nums object was missing when Kids was also missing for " << strip_leading_whitespace(context);
-            output << COLOR_RESET;
+            if (report(ArlMessageCode::NumberTreeNoNums, obj, context, ""))
+                output << COLOR_ERROR << "number tree Nums object was missing when Kids was also missing for " << strip_leading_whitespace(context) << COLOR_RESET;
         }
     }
 
     if (kids_obj != nullptr) {
         if (kids_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeArray) {
             ArlPDFArray* array_obj = (ArlPDFArray*)kids_obj;
-            for (int i = 0; i < array_obj->get_num_elements(); i++) {
+            for (int i = 0; (i < array_obj->get_num_elements()) && !past_deadline(); i++) {
                 ArlPDFObject* item = array_obj->get_value(i);
                 if ((item != nullptr) && (item->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary))
-                    parse_number_tree((ArlPDFDictionary*)item, links, context, false);
+                    parse_number_tree((ArlPDFDictionary*)item, links, context, locate(kids_loc, i), false);
                 else {
                     // Error: individual kid isn't dictionary in PDF number tree
-                    show_context(fake_e);
-                    output << COLOR_ERROR << "number tree Kids array element number #" << i << " was not a dictionary for " << strip_leading_whitespace(context);
-                    if (debug_mode && (item != nullptr))
-                        output << " (" << *item << ")";
-                    output << COLOR_RESET;
+                    if (report(ArlMessageCode::NumberTreeKidNotDictionary, obj, context, "", "", std::to_string(i))) {
+                        output << COLOR_ERROR << "number tree Kids array element number #" << i << " was not a dictionary for " << strip_leading_whitespace(context);
+                        if (debug_mode && (item != nullptr))
+                            output << " (" << *item << ")";
+                        output << COLOR_RESET;
+                    }
                 }
                 delete item;
             }
         }
         else {
             // Error: Kids isn't array in PDF number tree
-            show_context(fake_e);
-            output << COLOR_ERROR << "number tree Kids object was not an array for " << strip_leading_whitespace(context);
-            if (debug_mode)
-                output << " (" << *kids_obj << ")";
-            output << COLOR_RESET;
+            if (report(ArlMessageCode::NumberTreeKidsNotArray, obj, context, "")) {
+                output << COLOR_ERROR << "number tree Kids object was not an array for " << strip_leading_whitespace(context);
+                if (debug_mode)
+                    output << " (" << *kids_obj << ")";
+                output << COLOR_RESET;
+            }
         }
         delete kids_obj;
     }
+    if (low_memory)
+        for (int n : node_nbrs)
+            unpin_object(n, false);
 }
 
 
-/// @brief Queues a PDF object for processing against an Arlington link, and with a PDF path context
+/// @brief Queues a PDF object for processing against an Arlington link, and with a PDF path context.
+/// With low_memory, objects beyond MAX_IN_MEMORY are spilled by flush_spill() once the caller is done with them.
 ///
 /// @param[in]     parent       parent PDF object that contains object (nullptr for root objects)
 /// @param[in]     object       PDF object (not nullptr)
 /// @param[in]     link         Arlington link (TSV filename)
 /// @param[in,out] context      current content (PDF path)
-void CParsePDF::add_parse_object(ArlPDFObject* parent, ArlPDFObject* object, const std::string& link, const std::string& context) {
-    to_process.emplace(parent, object, link, context);
+/// @param[in]     loc          where object was reached from (only for low_memory)
+void CParsePDF::add_parse_object(ArlPDFObject* parent, ArlPDFObject* object, const std::string& link, const std::string& context, const obj_location& loc) {
+    int depth = (parent == nullptr) ? 0 : current_depth + 1;
+    if ((max_depth > 0) && (depth > max_depth)) {
+        depth_skipped++;
+        if (object->is_deleteable())
+            delete object;
+        return;
+    }
+    if (low_memory) {
+        // Direct objects have the negative object number of their containing indirect object
+        pin_object(object->get_object_number());
+        if ((spill_file != nullptr) && ((spill_pending > 0) || !spill_outgoing.empty() || (to_process.size() >= MAX_IN_MEMORY))) {
+            spill_outgoing.emplace(object, link, context, depth, object_location(object, loc));
+            return;
+        }
+        to_process.emplace(object, link, context, depth, object_location(object, loc));
+        return;
+    }
+    to_process.emplace(object, link, context, depth);
 }
 
 
@@ -796,24 +951,334 @@ void CParsePDF::add_parse_object(ArlPDFObject* parent, ArlPDFObject* object, con
 /// @param[in]     link         Arlington link (TSV filename)
 /// @param[in,out] context      current content (PDF path)
 void CParsePDF::add_root_parse_object(ArlPDFObject* object, const std::string& link, const std::string& context) {
-    to_process.emplace(nullptr, object, link, context);
+    add_parse_object(nullptr, object, link, context);
+}
+
+
+/// @brief Adds a reference to an indirect object so that the PDF SDK does not release it (--low-memory).
+///
+/// @param[in] obj_nbr   object number. Negative for direct objects (their containing object). 0 is ignored.
+void CParsePDF::pin_object(const int obj_nbr) {
+    if (obj_nbr != 0)
+        pending_refs[abs(obj_nbr)]++;
+}
+
+
+/// @brief Drops a reference to an indirect object from a checked queue element. When no more
+/// queued objects reference it, the PDF SDK can release it (--low-memory).
+///
+/// @param[in] obj_nbr   object number. Negative for direct objects (their containing object). 0 is ignored.
+/// @param[in] release   false if the caller still uses the object (it is then released later, if queued again)
+void CParsePDF::unpin_object(const int obj_nbr, const bool release) {
+    auto it = pending_refs.find(abs(obj_nbr));
+    if (it == pending_refs.end())
+        return;
+    if (--it->second == 0) {
+        pending_refs.erase(it);
+        if (release)
+            pdfc->release_object(abs(obj_nbr));
+    }
+}
+
+
+/// @brief Returns where a PDF object is (--low-memory)
+///
+/// @param[in] obj            PDF object (can be nullptr)
+/// @param[in] reached_from   where obj was reached from (the key or array element of its parent)
+///
+/// @returns the indirect object itself or else reached_from. Unknown if not low_memory.
+CParsePDF::obj_location CParsePDF::object_location(ArlPDFObject* obj, const obj_location& reached_from) {
+    if (!low_memory)
+        return obj_location();
+    if ((obj != nullptr) && obj->is_indirect_ref() && (obj->get_object_number() > 0))
+        return obj_location(obj->get_object_number());
+    return reached_from;
+}
+
+
+/// @brief Returns where the value of a dictionary key is (--low-memory)
+///
+/// @param[in] loc   where the dictionary is
+/// @param[in] key   dictionary key
+CParsePDF::obj_location CParsePDF::locate(const obj_location& loc, const std::wstring& key) {
+    if (!low_memory || (loc.obj_nbr == 0))
+        return obj_location();
+    obj_location retval = loc;
+    retval.path.push_back(L"/" + key);
+    return retval;
+}
+
+
+/// @brief Returns where an array element is (--low-memory)
+///
+/// @param[in] loc     where the array is
+/// @param[in] index   array index
+CParsePDF::obj_location CParsePDF::locate(const obj_location& loc, const int index) {
+    if (!low_memory || (loc.obj_nbr == 0))
+        return obj_location();
+    obj_location retval = loc;
+    retval.path.push_back(L"[" + std::to_wstring(index));
+    return retval;
+}
+
+
+/// @brief Reads a PDF object again from where it is (--low-memory)
+///
+/// @param[in] loc   where the PDF object is
+///
+/// @returns the PDF object (the same as when it was queued) or nullptr if it cannot be read
+ArlPDFObject* CParsePDF::get_object_at(const obj_location& loc) {
+    ArlPDFObject* obj = pdfc->get_indirect_object(loc.obj_nbr);
+    for (auto& step : loc.path) {
+        if (obj == nullptr)
+            break;
+        ArlPDFObject* next = nullptr;
+        auto t = obj->get_object_type();
+        if ((step == L"#") && (t == PDFObjectType::ArlPDFObjTypeStream))
+            next = ((ArlPDFStream*)obj)->get_dictionary();
+        else if ((step[0] == L'/') && (t == PDFObjectType::ArlPDFObjTypeDictionary))
+            next = ((ArlPDFDictionary*)obj)->get_value(step.substr(1));
+        else if ((step[0] == L'[') && (t == PDFObjectType::ArlPDFObjTypeArray))
+            next = ((ArlPDFArray*)obj)->get_value(std::stoi(step.substr(1)));
+        delete obj;
+        obj = next;
+    }
+    return obj;
+}
+
+
+/// @brief Writes queue elements from spill_outgoing to the end of spill_file (--low-memory).
+/// Indirect objects are deleted and can then be released by the PDF SDK. Only call when no other
+/// wrapper of a spilled object is in use (other than queued or pinned ones).
+void CParsePDF::flush_spill() {
+    if (spill_outgoing.empty())
+        return;
+    if (!spill_writing) {
+        std::fseek(spill_file, spill_write_pos, SEEK_SET);
+        spill_writing = true;
+    }
+    auto write = [this](const void* buffer, const size_t size) { std::fwrite(buffer, 1, size, spill_file); };
+    while (!spill_outgoing.empty()) {
+        queue_elem& elem = spill_outgoing.front();
+        bool indirect = elem.object->is_indirect_ref() && (elem.object->get_object_number() > 0);
+        int32_t obj_nbr = 0;
+        if (elem.object->is_deleteable() && (elem.location().obj_nbr > 0) && (indirect || !elem.location().path.empty()))
+            obj_nbr = elem.location().obj_nbr;
+
+        // Record: object number (0 = next in spill_kept), path, depth, link and context
+        write(&obj_nbr, sizeof(obj_nbr));
+        if (obj_nbr > 0) {
+            uint32_t n = (uint32_t)elem.location().path.size();
+            write(&n, sizeof(n));
+            for (auto& step : elem.location().path) {
+                n = (uint32_t)step.size();
+                write(&n, sizeof(n));
+                write(step.data(), n * sizeof(wchar_t));
+            }
+            int32_t depth = elem.depth;
+            write(&depth, sizeof(depth));
+            n = (uint32_t)elem.link.size();
+            write(&n, sizeof(n));
+            write(elem.link.data(), n);
+            n = (uint32_t)elem.context.size();
+            write(&n, sizeof(n));
+            write(elem.context.data(), n);
+
+            // Already checked objects are queued again from other places (page tree nodes, fonts, etc.) so are
+            // kept until then. Releasing them would mean parsing them again for every other reference.
+            bool checked = indirect && (mapped.find(object_key(elem.object)) != mapped.end());
+            int pinned_nbr = elem.object->get_object_number();
+            delete elem.object;
+            unpin_object(pinned_nbr, !checked);
+        }
+        else
+            spill_kept.push(std::move(elem));
+        spill_pending++;
+        spill_outgoing.pop();
+    }
+    spill_write_pos = std::ftell(spill_file);
+}
+
+
+/// @brief Reads up to MAX_IN_MEMORY queue elements from spill_file into an empty to_process (--low-memory).
+void CParsePDF::refill_from_spill() {
+    assert(to_process.empty() && spill_outgoing.empty());
+    if (spill_writing) {
+        std::fseek(spill_file, spill_read_pos, SEEK_SET);
+        spill_writing = false;
+    }
+    auto read = [this](void* buffer, const size_t size) { return std::fread(buffer, 1, size, spill_file) == size; };
+    while ((spill_pending > 0) && (to_process.size() < MAX_IN_MEMORY)) {
+        int32_t         depth = 0;
+        uint32_t        n = 0;
+        obj_location    loc;
+        std::string     link;
+        std::string     context;
+
+        spill_pending--;
+        bool ok = read(&loc.obj_nbr, sizeof(loc.obj_nbr)) && (loc.obj_nbr >= 0);
+        if (ok && (loc.obj_nbr == 0)) {
+            to_process.push(std::move(spill_kept.front()));
+            spill_kept.pop();
+            continue;
+        }
+        ok = ok && read(&n, sizeof(n));
+        if (ok) {
+            loc.path.resize(n);
+            for (auto& step : loc.path) {
+                ok = ok && read(&n, sizeof(n));
+                if (ok) {
+                    step.resize(n);
+                    ok = read(step.data(), n * sizeof(wchar_t));
+                }
+            }
+        }
+        ok = ok && read(&depth, sizeof(depth)) && read(&n, sizeof(n));
+        if (ok) {
+            link.resize(n);
+            ok = read(link.data(), n) && read(&n, sizeof(n));
+        }
+        if (ok) {
+            context.resize(n);
+            ok = read(context.data(), n);
+        }
+        if (!ok) {
+            // I/O error: the rest of spill_file cannot be trusted
+            spill_pending = 0;
+            while (!spill_kept.empty()) {
+                to_process.push(std::move(spill_kept.front()));
+                spill_kept.pop();
+            }
+            break;
+        }
+
+        ArlPDFObject* object = get_object_at(loc);
+        if (object != nullptr) {
+            pin_object(object->get_object_number());
+            to_process.emplace(object, link, context, depth, loc);
+        }
+    }
+    spill_read_pos = std::ftell(spill_file);
+
+    if (spill_pending == 0) {
+        // Everything was read back so start the file again
+        spill_read_pos = 0;
+        spill_write_pos = 0;
+    }
 }
 
 
 /// @brief prints the context line to console if not already done so
 /// 
-/// @param[in] e    the element
-void CParsePDF::show_context(queue_elem &e) {
+/// @param[in] object   the PDF object being checked
+/// @param[in] context  context (PDF DOM path) of object
+void CParsePDF::show_context(ArlPDFObject* object, const std::string& context) {
     if (!context_shown) {
-        output << COLOR_RESET_NO_EOL << std::setw(8) << counter << ": " << e.context;
+        output << COLOR_RESET_NO_EOL << std::setw(8) << counter << ": " << context;
         if (debug_mode)
-            output << " (" << *e.object << ")";
-        output << std::endl;
+            output << " (" << *object << ")";
+        output << '\n';
         context_shown = true;
     }
 }
 
 
+/// @brief Counts a message in the findings of the PDF and records it in the message log (if any).
+/// For text reports the caller then outputs the text of the message.
+///
+/// @param[in] code     message code
+/// @param[in] link     Arlington TSV object
+/// @param[in] key      key, array index or PDF version
+/// @param[in] object   the PDF object the message is about, or nullptr
+/// @param[in] context  PDF DOM path of object
+/// @param[in] value    additional data of the message
+void CParsePDF::add_finding(const ArlMessageCode code, const std::string& link, const std::string& key, ArlPDFObject* object, const std::string& context, const std::string& value) {
+    ::add_finding(findings, code, link, key);
+    if (log != nullptr)
+        log->add(code, link, key, object, context, value, format);
+}
+
+
+/// @brief Starts a message about an object. Text reports output the context line (once) and the caller then
+/// outputs the text of the message. JSON Lines reports write the whole message here instead.
+/// With --max-repeats, messages beyond the limit for the same code, Arlington object and key are
+/// only counted and summarized once the PDF has been checked.
+///
+/// @param[in] code     message code
+/// @param[in] object   the PDF object the message is about
+/// @param[in] context  context (PDF DOM path) of object
+/// @param[in] link     Arlington TSV object
+/// @param[in] key      key or array index
+/// @param[in] value    additional data of the message (JSON Lines only)
+///
+/// @returns true if the caller is to output the text of the message
+bool CParsePDF::report(const ArlMessageCode code, ArlPDFObject* object, const std::string& context, const std::string& link, const std::string& key, const std::string& value) {
+    ::add_finding(findings, code, link, key);
+    // --max-repeats: further messages are only counted
+    if ((max_repeats > 0) && (++repeats[std::make_tuple((int)code, link, key)] > max_repeats))
+        return false;
+    // Lines are not flushed one by one, but a crash should lose at most the last few hundred messages
+    if (++unflushed >= 512) {
+        output.flush();
+        unflushed = 0;
+    }
+    if (format == ReportFormat::Text) {
+        show_context(object, context);
+        if (log != nullptr)
+            log->add(code, link, key, object, strip_leading_whitespace(context), value, format);
+        return true;
+    }
+    if (log != nullptr)
+        log->add(code, link, key, object, strip_leading_whitespace(context), value, format);
+    write_jsonl_message(output, code, link, key, object, pdf_version, strip_leading_whitespace(context), value);
+    return false;
+}
+
+
+/// @brief Reports a version-based feature of a key or array element that does not match the PDF version
+///
+/// @param[in] versioner  version information of the key or array element
+/// @param[in] elem       the dictionary or array being checked
+/// @param[in] object     the key value or array element
+/// @param[in] feature    "a dictionary key", "a dictionary wildcard" or "an array"
+/// @param[in] key        key name or array index
+void CParsePDF::report_version_reason(ArlVersion& versioner, const queue_elem& elem, ArlPDFObject* object, const char* feature, const std::string& key) {
+    ArlVersionReason reason = versioner.get_version_reason();
+    ArlMessageCode   code;
+    const char*      what;
+    switch (reason) {
+    case ArlVersionReason::After_fnBeforeVersion:
+        code = ArlMessageCode::FeatureAfterObsolescence;
+        what = " version-based feature after obsolescence in PDF";
+        break;
+    case ArlVersionReason::Before_fnSinceVersion:
+        code = ArlMessageCode::FeatureBeforeIntroduction;
+        what = " version-based feature before official introduction in PDF ";
+        break;
+    case ArlVersionReason::Is_fnDeprecated:
+        code = ArlMessageCode::FeatureDeprecated;
+        what = " version-based feature that was deprecated in PDF ";
+        break;
+    case ArlVersionReason::Not_fnIsPDFVersion:
+        code = ArlMessageCode::FeatureOnlyInVersion;
+        what = " version-based feature that was only in PDF ";
+        break;
+    default:
+        return;
+    }
+
+    int ver = versioner.get_reason_version();
+    if (report(code, object, elem.context, elem.link, key, std::to_string(ver / 10) + "." + std::to_string(ver % 10))) {
+        output << COLOR_INFO << "detected " << feature << what << std::fixed << std::setprecision(1) << (ver / 10.0);
+        if (elem.object->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)
+            output << " (in PDF ";
+        else
+            output << " (using PDF ";
+        output << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << ") for " << elem.link << "/" << key << COLOR_RESET;
+    }
+}
+
+
 
 /// @brief Iteratively parse PDF objects from the to_process queue
 ///
@@ -823,25 +1288,63 @@ void CParsePDF::show_context(queue_elem &e) {
 bool CParsePDF::parse_object(CPDFFile &pdf)
 {
     pdfc = &pdf;
-    std::string ver = pdfc->check_and_get_pdf_version(output); // will produce output messages
+    std::string ver = pdfc->check_and_get_pdf_version(output, format, findings, log); // will produce output messages
 
-    output << COLOR_INFO << "Processing as PDF " << ver;
     auto extns = pdfc->get_extensions();
-    if (extns.size() > 0) {
-        output << " with extensions ";
-        for (size_t i = 0; i < extns.size(); i++)
-            output << extns[i] << ((i < (extns.size() - 1)) ? ", " : "");
+    std::string extns_list;
+    for (size_t i = 0; i < extns.size(); i++)
+        extns_list += extns[i] + ((i < (extns.size() - 1)) ? "," : "");
+    add_finding(ArlMessageCode::ProcessingAsVersion, "", ver, nullptr, "", extns_list);
+    if (format == ReportFormat::JSONL) {
+        write_jsonl_message(output, ArlMessageCode::ProcessingAsVersion, "", "", nullptr, string_to_pdf_version(ver), "", extns_list);
+    }
+    else {
+        output << COLOR_INFO << "Processing as PDF " << ver;
+        if (extns.size() > 0) {
+            output << " with extensions ";
+            for (size_t i = 0; i < extns.size(); i++)
+                output << extns[i] << ((i < (extns.size() - 1)) ? ", " : "");
+        }
+        output << COLOR_RESET;
     }
-    output << COLOR_RESET;
     pdf_version = string_to_pdf_version(ver);
 
     counter = 0;
-
-    while (to_process.size() > 0) {
+    int checked_obj_nbr = 0;    // for low_memory: object number of previous queue element
+    std::string budget;         // which budget was exceeded (if any)
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(max_seconds);
+    deadline_ticks = 0;
+    out_of_time = false;
+    if (low_memory && pdfc->can_release_objects())
+        spill_file = std::tmpfile(); // if nullptr then everything stays in memory
+
+    while (true) {
         context_shown = false;
+        if (checked_obj_nbr > 0) {
+            unpin_object(checked_obj_nbr);
+            checked_obj_nbr = 0;
+        }
+        if (spill_file != nullptr) {
+            flush_spill();
+            if (to_process.empty() && (spill_pending > 0))
+                refill_from_spill();
+        }
+        if (to_process.empty())
+            break;
 
-        queue_elem elem = to_process.front();
+        // The clock is also looked at inside name and number trees, dictionaries and arrays
+        if ((max_objects > 0) && (counter >= max_objects))
+            budget = "--max-objects " + std::to_string(max_objects);
+        else if (past_deadline())
+            budget = "--max-seconds " + std::to_string(max_seconds);
+        if (!budget.empty())
+            break;
+
+        queue_elem elem = std::move(to_process.front());
         to_process.pop();
+        current_depth = elem.depth;
+        if (low_memory)
+            checked_obj_nbr = abs(elem.object->get_object_number());
         if (elem.link == "") {
             delete elem.object;
             continue;
@@ -852,38 +1355,51 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
 
         // To debug: look at a full DOM tree and then do conditional breakpoints on counter==X
         counter++;
-        if (!terse)
-            show_context(elem);
+        if ((objects_checked != nullptr) && ((counter & 0xFF) == 0))
+            *objects_checked += 256;
+        if (!terse && (format == ReportFormat::Text))
+            show_context(elem.object, elem.context);
         elem.context = "  " + elem.context; // ident for nested DOM display
 
         assert(elem.object != nullptr);
         if (elem.object->is_indirect_ref()) {
-            auto hash = elem.object->get_hash_id();
+            auto hash = object_key(elem.object);
             auto found = mapped.find(hash);
             if (found != mapped.end()) {
+                const std::string& first_link = *found->second;
                 // "_Universal..." objects match anything so ignore them.
-                if ((found->second != elem.link) &&
+                if ((first_link != elem.link) &&
                     (((elem.link != "_UniversalDictionary") && (elem.link != "_UniversalArray")) &&
-                    ((found->second != "_UniversalDictionary") && (found->second != "_UniversalArray")))) {
-                    show_context(elem);
-                    output << COLOR_WARNING << "object ";
-                    if (debug_mode)
-                        output << *elem.object << " ";
-                    output << "identified in two different contexts. Originally: " << found->second << "; second: " << elem.link << COLOR_RESET;
+                    ((first_link != "_UniversalDictionary") && (first_link != "_UniversalArray")))) {
+                    if (report(ArlMessageCode::TwoContexts, elem.object, elem.context, elem.link, "", first_link)) {
+                        output << COLOR_WARNING << "object ";
+                        if (debug_mode)
+                            output << *elem.object << " ";
+                        output << "identified in two different contexts. Originally: " << first_link << "; second: " << elem.link << COLOR_RESET;
+                    }
                 }
                 delete elem.object;
                 continue;
             }
             // remember visited object with a link used for validation
-            mapped.insert(std::make_pair(hash, elem.link));
+            mapped.insert(std::make_pair(hash, &*link_names.insert(elem.link).first));
         }
 
         fs::path  grammar_file = grammar_folder;
         grammar_file /= elem.link + ".tsv";
         const ArlTSVmatrix &tsv = get_grammar(elem.link);
         if (tsv.size() == 0) {
-            output << COLOR_ERROR << "could not open " << grammar_file << COLOR_RESET;
+            add_finding(ArlMessageCode::NoGrammar, elem.link, "", elem.object, strip_leading_whitespace(elem.context), grammar_file.string());
+            if (format == ReportFormat::JSONL)
+                write_jsonl_message(output, ArlMessageCode::NoGrammar, elem.link, "", elem.object, pdf_version, strip_leading_whitespace(elem.context), grammar_file.string());
+            else
+                output << COLOR_ERROR << "could not open " << grammar_file << COLOR_RESET;
             delete elem.object;
+            if (objects_checked != nullptr)
+                *objects_checked += (counter & 0xFF);
+            if (spill_file != nullptr)
+                std::fclose(spill_file);
+            spill_file = nullptr;
             return false;
         }
 
@@ -897,8 +1413,8 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
         // Check if object number is out-of-range as per trailer /Size
         // Allow for multiple indirections and thus negative object numbers
         if (abs(elem.object->get_object_number()) >= pdfc->get_trailer_size()) {
-            show_context(elem);
-            output << COLOR_ERROR << "object number " << abs(elem.object->get_object_number()) << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
+            if (report(ArlMessageCode::IllegalObjectNumber, elem.object, elem.context, elem.link))
+                output << COLOR_ERROR << "object number " << abs(elem.object->get_object_number()) << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
         }
 
         if ((obj_type == PDFObjectType::ArlPDFObjTypeDictionary) || (obj_type == PDFObjectType::ArlPDFObjTypeStream)) {
@@ -910,17 +1426,22 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
             else
                 dictObj = (ArlPDFDictionary*)elem.object;
 
+            // Where dictObj is (only for low_memory)
+            obj_location dict_loc = elem.location();
+            if ((obj_type == PDFObjectType::ArlPDFObjTypeStream) && (dict_loc.obj_nbr > 0))
+                dict_loc.path.push_back(L"#");
+
             // Check for duplicate keys of the same name. Depends on underlying PDF SDK!!
             // https://assets.devoted.com/plan-documents/2022/DH-DisenrollmentForm-2022-ENG.pdf
             if (dictObj->has_duplicate_keys()) {
-                show_context(elem);
                 auto dup_keys = dictObj->get_duplicate_keys();
                 for (auto dup_key : dup_keys)
-                    output << COLOR_ERROR << "Duplicate dictionary key: " << dup_key << COLOR_RESET;
+                    if (report(ArlMessageCode::DuplicateKey, elem.object, elem.context, elem.link, dup_key))
+                        output << COLOR_ERROR << "Duplicate dictionary key: " << dup_key << COLOR_RESET;
             }
 
             auto dict_num_keys = dictObj->get_num_keys();
-            for (int i = 0; i < dict_num_keys; i++) {
+            for (int i = 0; (i < dict_num_keys) && !past_deadline(); i++) {
                 std::wstring key = dictObj->get_key_name_by_index(i);
                 std::string  key_utf8 = ToUtf8(key);
                 ArlPDFObject* inner_obj = dictObj->get_value(key);
@@ -931,8 +1452,8 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
                 if (inner_obj != nullptr) {
                     // Check if object number is out-of-range as per trailer /Size
                     if (inner_obj->get_object_number() >= pdfc->get_trailer_size()) {
-                        show_context(elem);
-                        output << COLOR_ERROR << "object number " << inner_obj->get_object_number() << " of key " << key_utf8 << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
+                        if (report(ArlMessageCode::IllegalObjectNumber, inner_obj, elem.context, elem.link, key_utf8))
+                            output << COLOR_ERROR << "object number " << inner_obj->get_object_number() << " of key " << key_utf8 << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
                     }
 
                     bool is_found = false;
@@ -950,31 +1471,30 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
 
                             if (versioner.object_matched_arlington_type()) {
                                 std::string arl_type = versioner.get_matched_arlington_type();
-                                std::string as = elem.context + "->" + key_utf8;
-                                std::vector<std::string>  full_linkset = versioner.get_full_linkset(vec[TSV_LINK]);
                                 auto t = inner_obj->get_object_type();
                                 if (arl_type == "number-tree") {
                                     if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
-                                        show_context(elem);
-                                        output << COLOR_ERROR << "number-tree was not a dictionary for " << elem.link << "/" << key_utf8 << " (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
+                                        if (report(ArlMessageCode::NumberTreeNotDictionary, inner_obj, elem.context, elem.link, key_utf8, PDFObjectType_strings[(int)t]))
+                                            output << COLOR_ERROR << "number-tree was not a dictionary for " << elem.link << "/" << key_utf8 << " (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
                                     }
                                     else // safe to cast as dict
-                                        parse_number_tree((ArlPDFDictionary*)inner_obj, full_linkset, as + " (as number-tree)");
+                                        parse_number_tree((ArlPDFDictionary*)inner_obj, versioner.get_full_linkset(vec[TSV_LINK]), elem.context + "->" + key_utf8 + " (as number-tree)", locate(dict_loc, key));
                                 }
                                 else if (arl_type == "name-tree") {
                                     if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
-                                        show_context(elem);
-                                        output << COLOR_ERROR << "name-tree was not a dictionary for " << elem.link << "/" << key_utf8 << " (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
+                                        if (report(ArlMessageCode::NameTreeNotDictionary, inner_obj, elem.context, elem.link, key_utf8, PDFObjectType_strings[(int)t]))
+                                            output << COLOR_ERROR << "name-tree was not a dictionary for " << elem.link << "/" << key_utf8 << " (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
                                     }
                                     else // safe to cast as dict
-                                        parse_name_tree((ArlPDFDictionary*)inner_obj, full_linkset, as + " (as name-tree)");
+                                        parse_name_tree((ArlPDFDictionary*)inner_obj, versioner.get_full_linkset(vec[TSV_LINK]), elem.context + "->" + key_utf8 + " (as name-tree)", locate(dict_loc, key));
                                 }
                                 else if (FindInVector(v_ArlComplexTypes, arl_type)) {
-                                    std::string best_link = recommended_link_for_object(inner_obj, full_linkset, as);
+                                    std::string as = elem.context + "->" + key_utf8;
+                                    std::string best_link = recommended_link_for_object(inner_obj, versioner.get_full_linkset(vec[TSV_LINK]), as);
                                     if (best_link.size() > 0) {
                                         if (vec[TSV_KEYNAME] != best_link)
                                             as = as + " (as " + best_link + ")";
-                                        add_parse_object(dictObj, inner_obj, best_link, as); // DON'T DELETE inner_obj!
+                                        add_parse_object(dictObj, inner_obj, best_link, as, locate(dict_loc, key)); // DON'T DELETE inner_obj!
                                         kept_inner_obj = true;
                                     }
                                 }
@@ -986,31 +1506,8 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
                                 // Already reported via check_basics() above.
                             }
                             // Report version mis-matches
-                            ArlVersionReason reason = versioner.get_version_reason();
-                            if ((reason != ArlVersionReason::OK) && (reason != ArlVersionReason::Unknown)) {
-                                show_context(elem);
-                                bool reason_shown = false;
-                                if (reason == ArlVersionReason::After_fnBeforeVersion) {
-                                    output << COLOR_INFO << "detected a dictionary key version-based feature after obsolescence in PDF";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Before_fnSinceVersion) {
-                                    output << COLOR_INFO << "detected a dictionary key version-based feature before official introduction in PDF ";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Is_fnDeprecated) {
-                                    output << COLOR_INFO << "detected a dictionary key version-based feature that was deprecated in PDF ";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Not_fnIsPDFVersion) {
-                                    output << COLOR_INFO << "detected a dictionary key version-based feature that was only in PDF ";
-                                    reason_shown = true;
-                                }
-                                if (reason_shown) {
-                                    output << std::fixed << std::setprecision(1) << (versioner.get_reason_version() / 10.0) << " (using PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-                                    output << ") for " << elem.link << "/" << key_utf8 << COLOR_RESET;
-                                }
-                            }
+                            if ((versioner.get_version_reason() != ArlVersionReason::OK) && (versioner.get_version_reason() != ArlVersionReason::Unknown))
+                                report_version_reason(versioner, elem, inner_obj, "a dictionary key", key_utf8);
                             if (versioner.is_unsupported_extension())
                                 is_found = false;
                             break;
@@ -1019,20 +1516,20 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
 
                     // Metadata streams are allowed anywhere since PDF 1.4
                     if ((!is_found) && (key == L"Metadata")) {
-                        add_parse_object(dictObj, inner_obj, "Metadata", elem.context + "->Metadata");
+                        add_parse_object(dictObj, inner_obj, "Metadata", elem.context + "->Metadata", locate(dict_loc, key));
                         kept_inner_obj = true;
-                        show_context(elem);
-                        output << COLOR_INFO << "found a PDF 1.4 Metadata key" << COLOR_RESET;
+                        if (report(ArlMessageCode::MetadataKey, inner_obj, elem.context, elem.link, key_utf8))
+                            output << COLOR_INFO << "found a PDF 1.4 Metadata key" << COLOR_RESET;
                         pdf.set_feature_version("1.4", "Metadata", ""); // see clause 14.3
                         is_found = true;
                     }
 
                     // AF (Associated File) objects are allowed anywhere in PDF 2.0
                     if ((!is_found) && (key == L"AF")) {
-                        add_parse_object(dictObj, inner_obj, "FileSpecification", elem.context + "->AF (as FileSpecification)");
+                        add_parse_object(dictObj, inner_obj, "FileSpecification", elem.context + "->AF (as FileSpecification)", locate(dict_loc, key));
                         kept_inner_obj = true;
-                        show_context(elem);
-                        output << COLOR_INFO << "found a PDF 2.0 Associated File AF key" << COLOR_RESET;
+                        if (report(ArlMessageCode::AssociatedFilesKey, inner_obj, elem.context, elem.link, key_utf8))
+                            output << COLOR_INFO << "found a PDF 2.0 Associated File AF key" << COLOR_RESET;
                         pdf.set_feature_version("2.0", "Associated File", "");
                         is_found = true;
                     }
@@ -1046,31 +1543,30 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
                             // Process version predicates properly (PDF version and object type aware)
                             ArlVersion versioner(inner_obj, vec, pdf_version, pdfc->get_extensions());
                             if (versioner.object_matched_arlington_type()) {
-                                std::string as = elem.context + "->" + key_utf8;
                                 std::string arl_type = versioner.get_matched_arlington_type();
-                                std::vector<std::string>  full_linkset = versioner.get_full_linkset(vec[TSV_LINK]);
                                 auto t = inner_obj->get_object_type();
                                 if (arl_type == "number-tree") {
                                     if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
-                                        show_context(elem);
-                                        output << COLOR_ERROR << "number-tree was not a dictionary for " << elem.link << "/* (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
+                                        if (report(ArlMessageCode::NumberTreeNotDictionary, inner_obj, elem.context, elem.link, key_utf8, PDFObjectType_strings[(int)t]))
+                                            output << COLOR_ERROR << "number-tree was not a dictionary for " << elem.link << "/* (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
                                     }
                                     else // safe to cast to dict
-                                        parse_number_tree((ArlPDFDictionary*)inner_obj, full_linkset, as + " (as number-tree)");
+                                        parse_number_tree((ArlPDFDictionary*)inner_obj, versioner.get_full_linkset(vec[TSV_LINK]), elem.context + "->" + key_utf8 + " (as number-tree)", locate(dict_loc, key));
                                 }
                                 else if (arl_type == "name-tree") {
                                     if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
-                                        show_context(elem);
-                                        output << COLOR_ERROR << "name-tree was not a dictionary for " << elem.link << "/* (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
+                                        if (report(ArlMessageCode::NameTreeNotDictionary, inner_obj, elem.context, elem.link, key_utf8, PDFObjectType_strings[(int)t]))
+                                            output << COLOR_ERROR << "name-tree was not a dictionary for " << elem.link << "/* (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
                                     }
                                     else // safe to cast to dict
-                                        parse_name_tree((ArlPDFDictionary*)inner_obj, full_linkset, as + " (as name-tree)");
+                                        parse_name_tree((ArlPDFDictionary*)inner_obj, versioner.get_full_linkset(vec[TSV_LINK]), elem.context + "->" + key_utf8 + " (as name-tree)", locate(dict_loc, key));
                                 }
                                 else if (FindInVector(v_ArlComplexTypes, arl_type)) {
-                                    std::string best_link = recommended_link_for_object(inner_obj, full_linkset, as);
+                                    std::string as = elem.context + "->" + key_utf8;
+                                    std::string best_link = recommended_link_for_object(inner_obj, versioner.get_full_linkset(vec[TSV_LINK]), as);
                                     if (best_link.size() > 0) {
                                         as = as + " (as " + best_link + ")";
-                                        add_parse_object(dictObj, inner_obj, best_link, as); // DON'T DELETE inner_obj!
+                                        add_parse_object(dictObj, inner_obj, best_link, as, locate(dict_loc, key)); // DON'T DELETE inner_obj!
                                         kept_inner_obj = true;
                                     }
                                 }
@@ -1080,65 +1576,51 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
                             }
                             else if (inner_obj->get_object_type() != PDFObjectType::ArlPDFObjTypeNull) {
                                 // PDF object type is not correct to Arlington for wildcard. Explicit "null" is always allowed.
-                                show_context(elem);
-                                output << COLOR_ERROR << "wrong type for dictionary wildcard for " << elem.link << "/" << ToUtf8(key);
-                                output << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << ": wanted " << vec[TSV_TYPE] << ", PDF was " << versioner.get_object_arlington_type() << COLOR_RESET;
-                            }
-                            // Report version mis-matches
-                            ArlVersionReason reason = versioner.get_version_reason();
-                            if ((reason != ArlVersionReason::OK) && (reason != ArlVersionReason::Unknown)) {
-                                show_context(elem);
-                                bool reason_shown = false;
-                                if (reason == ArlVersionReason::After_fnBeforeVersion) {
-                                    output << COLOR_INFO << "detected a dictionary wildcard version-based feature after obsolescence in PDF";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Before_fnSinceVersion) {
-                                    output << COLOR_INFO << "detected a dictionary wildcard version-based feature before official introduction in PDF ";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Is_fnDeprecated) {
-                                    output << COLOR_INFO << "detected a dictionary wildcard version-based feature that was deprecated in PDF ";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Not_fnIsPDFVersion) {
-                                    output << COLOR_INFO << "detected a dictionary wildcard version-based feature that was only in PDF ";
-                                    reason_shown = true;
-                                }
-                                if (reason_shown) {
-                                    output << std::fixed << std::setprecision(1) << (versioner.get_reason_version() / 10.0) << " (using PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-                                    output << ") for " << elem.link << "/" << key_utf8 << COLOR_RESET;
+                                if (report(ArlMessageCode::WildcardWrongType, inner_obj, elem.context, elem.link, key_utf8, versioner.get_object_arlington_type())) {
+                                    output << COLOR_ERROR << "wrong type for dictionary wildcard for " << elem.link << "/" << ToUtf8(key);
+                                    output << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << ": wanted " << vec[TSV_TYPE] << ", PDF was " << versioner.get_object_arlington_type() << COLOR_RESET;
                                 }
                             }
+                            // Report version mis-matches
+                            if ((versioner.get_version_reason() != ArlVersionReason::OK) && (versioner.get_version_reason() != ArlVersionReason::Unknown))
+                                report_version_reason(versioner, elem, inner_obj, "a dictionary wildcard", key_utf8);
                         } // last row was a wildcard
                     }
 
                     // Still didn't find the key - report as an extension
                     if (!is_found) {
-                        show_context(elem);
-                        if (is_second_class_pdf_name(key_utf8))
-                            output << COLOR_INFO << "second class key '" << key_utf8 << "' is not defined in Arlington for ";
-                        else if (is_third_class_pdf_name(key_utf8))
-                            output << COLOR_INFO << "third class key '" << key_utf8 << "' found in ";
-                        else
-                            output << COLOR_INFO << "unknown key '" << key_utf8 << "' is not defined in Arlington for ";
-                        output << elem.link << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+                        bool second_class = is_second_class_pdf_name(key_utf8);
+                        bool third_class = !second_class && is_third_class_pdf_name(key_utf8);
+                        ArlMessageCode code = (second_class ? ArlMessageCode::SecondClassKey : (third_class ? ArlMessageCode::ThirdClassKey : ArlMessageCode::UnknownKey));
+                        if (report(code, inner_obj, elem.context, elem.link, key_utf8)) {
+                            if (second_class)
+                                output << COLOR_INFO << "second class key '" << key_utf8 << "' is not defined in Arlington for ";
+                            else if (third_class)
+                                output << COLOR_INFO << "third class key '" << key_utf8 << "' found in ";
+                            else
+                                output << COLOR_INFO << "unknown key '" << key_utf8 << "' is not defined in Arlington for ";
+                            output << elem.link << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+                        }
                     }
                 }
                 else {
                     // inner_objj == nullptr so malformed PDF or parsing limitation in PDF SDK?
-                    show_context(elem);
-                    output << COLOR_ERROR << "could not get value for key '" << key_utf8 << "' (" << elem.link << ")" << COLOR_RESET;
+                    if (report(ArlMessageCode::NoKeyValue, elem.object, elem.context, elem.link, key_utf8))
+                        output << COLOR_ERROR << "could not get value for key '" << key_utf8 << "' (" << elem.link << ")" << COLOR_RESET;
                 }
 
                 if (!kept_inner_obj)
                     delete inner_obj;
+                if (spill_file != nullptr)
+                    flush_spill();
             } // for-each key in PDF object
 
             // Now process Arlington definition of the same PDF object
             PredicateProcessor req_pp(pdfc, tsv);
             int key_idx = -1;
             for (auto& vec : tsv) {
+                if (past_deadline())
+                    break;
                 key_idx++;
                 // Check for missing required values in object, and parents if inheritable
                 ArlVersion versioner(dictObj, vec, pdf_version, pdfc->get_extensions());
@@ -1151,27 +1633,12 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
                         // Arlington 'Inheritable' field NEVER has predicates
                         assert(vec[TSV_INHERITABLE].find("fn:") == std::string::npos);
                         if (vec[TSV_INHERITABLE] == "FALSE") {
-                            show_context(elem);
-                            if (req_pp.WasFullyImplemented())
-                                output << COLOR_ERROR << "non-inheritable required key does not exist: ";
-                            else
-                                output << COLOR_WARNING << "non-inheritable required key may not exist: ";
-                            output << vec[TSV_KEYNAME] << " (" << elem.link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-                            if (debug_mode)
-                                output << " (" << *dictObj << ")";
-                            if ((vec[TSV_REQUIRED].find("fn:") != std::string::npos) || !req_pp.WasFullyImplemented())
-                                output << " because " << vec[TSV_REQUIRED];
-                            output << COLOR_RESET;
-                        }
-                        else {
-                            assert(vec[TSV_INHERITABLE] == "TRUE");
-                            inner_obj = find_via_inheritance(dictObj, ToWString(vec[TSV_KEYNAME]));
-                            if (inner_obj == nullptr) {
-                                show_context(elem);
+                            ArlMessageCode code = (req_pp.WasFullyImplemented() ? ArlMessageCode::RequiredKeyMissing : ArlMessageCode::RequiredKeyMaybeMissing);
+                            if (report(code, elem.object, elem.context, elem.link, vec[TSV_KEYNAME], vec[TSV_REQUIRED])) {
                                 if (req_pp.WasFullyImplemented())
-                                    output << COLOR_ERROR << "inheritable required key does not exist: ";
+                                    output << COLOR_ERROR << "non-inheritable required key does not exist: ";
                                 else
-                                    output << COLOR_WARNING << "inheritable required key may not exist: ";
+                                    output << COLOR_WARNING << "non-inheritable required key may not exist: ";
                                 output << vec[TSV_KEYNAME] << " (" << elem.link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
                                 if (debug_mode)
                                     output << " (" << *dictObj << ")";
@@ -1180,16 +1647,36 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
                                 output << COLOR_RESET;
                             }
                         }
+                        else {
+                            assert(vec[TSV_INHERITABLE] == "TRUE");
+                            inner_obj = find_via_inheritance(dictObj, ToWString(vec[TSV_KEYNAME]));
+                            if (inner_obj == nullptr) {
+                                ArlMessageCode code = (req_pp.WasFullyImplemented() ? ArlMessageCode::InheritableKeyMissing : ArlMessageCode::InheritableKeyMaybeMissing);
+                                if (report(code, elem.object, elem.context, elem.link, vec[TSV_KEYNAME], vec[TSV_REQUIRED])) {
+                                    if (req_pp.WasFullyImplemented())
+                                        output << COLOR_ERROR << "inheritable required key does not exist: ";
+                                    else
+                                        output << COLOR_WARNING << "inheritable required key may not exist: ";
+                                    output << vec[TSV_KEYNAME] << " (" << elem.link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+                                    if (debug_mode)
+                                        output << " (" << *dictObj << ")";
+                                    if ((vec[TSV_REQUIRED].find("fn:") != std::string::npos) || !req_pp.WasFullyImplemented())
+                                        output << " because " << vec[TSV_REQUIRED];
+                                    output << COLOR_RESET;
+                                }
+                            }
+                        }
                     }
                     delete inner_obj;
                 }
                 else if (!req_pp.WasFullyImplemented()) {
                     // Partial support is a warning as don't know if really required or not
-                    show_context(elem);
-                    output << COLOR_WARNING << "required key may not exist: " << vec[TSV_KEYNAME] << " (" << elem.link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-                    if (debug_mode)
-                        output << " (" << *dictObj << ")";
-                    output << " because " << vec[TSV_REQUIRED] << COLOR_RESET;
+                    if (report(ArlMessageCode::ConditionalKeyMaybeMissing, elem.object, elem.context, elem.link, vec[TSV_KEYNAME], vec[TSV_REQUIRED])) {
+                        output << COLOR_WARNING << "required key may not exist: " << vec[TSV_KEYNAME] << " (" << elem.link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+                        if (debug_mode)
+                            output << " (" << *dictObj << ")";
+                        output << " because " << vec[TSV_REQUIRED] << COLOR_RESET;
+                    }
                 }
             } // for-each Arlington row
 
@@ -1207,8 +1694,8 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
 
                 bool ambiguous;
                 if (!check_valid_array_definition(elem.link, array_index_list, cnull, &ambiguous)) {
-                    show_context(elem);
-                    output << COLOR_ERROR << "PDF array object encountered, but using Arlington dictionary " << elem.link << COLOR_RESET;
+                    if (report(ArlMessageCode::ArrayAsDictionary, elem.object, elem.context, elem.link))
+                        output << COLOR_ERROR << "PDF array object encountered, but using Arlington dictionary " << elem.link << COLOR_RESET;
                     delete elem.object;
                     continue;
                 }
@@ -1248,12 +1735,13 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
 
             // Are all required rows present?
             if ((first_optional_idx >= 0) && (array_size < first_optional_idx)) {
-                show_context(elem);
-                output << COLOR_ERROR << "minimum required array length incorrect for " << elem.link;
-                output << ": wanted " << first_optional_idx << ", got " << array_size;
-                if (debug_mode)
-                    output << " (" << *arrayObj << ")";
-                output << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+                if (report(ArlMessageCode::ArrayMinimumLength, elem.object, elem.context, elem.link, "", std::to_string(array_size))) {
+                    output << COLOR_ERROR << "minimum required array length incorrect for " << elem.link;
+                    output << ": wanted " << first_optional_idx << ", got " << array_size;
+                    if (debug_mode)
+                        output << " (" << *arrayObj << ")";
+                    output << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+                }
             }
 
             // For array repeat sets, rows in repeating set need to be DIGIT + '*' 
@@ -1277,21 +1765,22 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
 
             // PDF array object must always contain sufficient required rows  
             if (array_size < num_required_rows) {
-                show_context(elem);
-                output << COLOR_ERROR << "array length was too short (needed " << num_required_rows << ", was " << array_size << ") for " << elem.link << COLOR_RESET;
+                if (report(ArlMessageCode::ArrayTooShort, elem.object, elem.context, elem.link, "", std::to_string(array_size)))
+                    output << COLOR_ERROR << "array length was too short (needed " << num_required_rows << ", was " << array_size << ") for " << elem.link << COLOR_RESET;
             }
 
             // If all rows required (both fixed + repeating) AND some repeating rows, then array length less the number of fixed rows
             // must be an exact multiple of the repeat
             if ((num_required_rows == (int)tsv.size()) && (num_array_rows_repeats > 0) && 
                 ((((array_size - num_array_rows_fixed) % num_array_rows_repeats)) != 0) && (first_optional_idx == -1)) {
-                show_context(elem);
-                output << COLOR_WARNING << "array length was not an exact multiple of " << num_required_rows << " (was " << array_size << ") for " << elem.link;
-                output << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+                if (report(ArlMessageCode::ArrayNotMultiple, elem.object, elem.context, elem.link, "", std::to_string(array_size))) {
+                    output << COLOR_WARNING << "array length was not an exact multiple of " << num_required_rows << " (was " << array_size << ") for " << elem.link;
+                    output << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+                }
             }
 
             int last_idx = -1; // Keep track of previous TSV row (so can loop for repeat sets)
-            for (int i = 0; i < array_size; i++) {
+            for (int i = 0; (i < array_size) && !past_deadline(); i++) {
                 ArlPDFObject* item = arrayObj->get_value(i);
                 bool item_kept = false;
                 if (item != nullptr) {
@@ -1300,8 +1789,8 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
                     // Check if object number is out-of-range as per trailer /Size.
                     // Allow for multiple indirections and thus negative object numbers.
                     if (item->get_object_number() >= pdfc->get_trailer_size()) {
-                        show_context(elem);
-                        output << COLOR_ERROR << "object number " << item->get_object_number() << " of array element " << i << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
+                        if (report(ArlMessageCode::IllegalObjectNumber, item, elem.context, elem.link, std::to_string(i)))
+                            output << COLOR_ERROR << "object number " << item->get_object_number() << " of array element " << i << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
                     }
 
                     // Arlington data model array repeat sets and required/optional logic
@@ -1355,53 +1844,91 @@ bool CParsePDF::parse_object(CPDFFile &pdf)
                             std::string best_link = recommended_link_for_object(item, full_linkset, as + "]");
                             if (best_link.size() > 0) {
                                 as = as + " (as " + best_link + ")]";
-                                add_parse_object(arrayObj, item, best_link, as);
+                                add_parse_object(arrayObj, item, best_link, as, locate(elem.location(), i));
                                 item_kept = true;
                             }
                         }
 
                         // Report version mis-matches
-                        ArlVersionReason reason = versioner.get_version_reason();
-                        if ((reason != ArlVersionReason::OK) && (reason != ArlVersionReason::Unknown)) {
-                            show_context(elem);
-                            bool reason_shown = false;
-                            if (reason == ArlVersionReason::After_fnBeforeVersion) {
-                                output << COLOR_INFO << "detected an array version-based feature after obsolescence in PDF";
-                                reason_shown = true;
-                            }
-                            else if (reason == ArlVersionReason::Before_fnSinceVersion) {
-                                output << COLOR_INFO << "detected an array version-based feature before official introduction in PDF ";
-                                reason_shown = true;
-                            }
-                            else if (reason == ArlVersionReason::Is_fnDeprecated) {
-                                output << COLOR_INFO << "detected an array version-based feature that was deprecated in PDF ";
-                                reason_shown = true;
-                            }
-                            else if (reason == ArlVersionReason::Not_fnIsPDFVersion) {
-                                output << COLOR_INFO << "detected an array version-based feature that was only in PDF ";
-                                reason_shown = true;
-                            }
-                            if (reason_shown)
-                                output << std::fixed << std::setprecision(1) << (versioner.get_reason_version() / 10.0) << " (in PDF " << (pdf_version / 10.0) << ") for " << elem.link << "/" << i << COLOR_RESET;
-                        }
+                        if ((versioner.get_version_reason() != ArlVersionReason::OK) && (versioner.get_version_reason() != ArlVersionReason::Unknown))
+                            report_version_reason(versioner, elem, item, "an array", std::to_string(i));
                     }
                     else {
-                        show_context(elem);
-                        output << COLOR_INFO << "array was longer than needed (wanted " << (int)tsv.size() << ", got " << array_size;
-                        output << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << " for " << elem.link << "/" << i+1 << COLOR_RESET;
+                        if (report(ArlMessageCode::ArrayTooLong, item, elem.context, elem.link, std::to_string(i), std::to_string(array_size))) {
+                            output << COLOR_INFO << "array was longer than needed (wanted " << (int)tsv.size() << ", got " << array_size;
+                            output << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << " for " << elem.link << "/" << i+1 << COLOR_RESET;
+                        }
                     }
                 }
                 if (!item_kept)
                     delete item;
+                if (spill_file != nullptr)
+                    flush_spill();
             } // for-each array element
         }
         else {
-            show_context(elem);
-            output << COLOR_ERROR << "unexpected object type " << PDFObjectType_strings[(int)obj_type] << " for " << elem.link << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+            if (report(ArlMessageCode::UnexpectedObjectType, elem.object, elem.context, elem.link, "", PDFObjectType_strings[(int)obj_type]))
+                output << COLOR_ERROR << "unexpected object type " << PDFObjectType_strings[(int)obj_type] << " for " << elem.link << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
         }
         if (elem.object->is_deleteable())
             delete elem.object;
     } // while queue not empty
+    if (checked_obj_nbr > 0)
+        unpin_object(checked_obj_nbr);
+    if (objects_checked != nullptr)
+        *objects_checked += (counter & 0xFF);
+
+    // The deadline can also pass while the last queued object is checked
+    if (budget.empty() && out_of_time)
+        budget = "--max-seconds " + std::to_string(max_seconds);
+    if (!budget.empty()) {
+        // The key is the budget option so that timeouts can be told apart
+        std::string budget_option = budget.substr(0, budget.find(' '));
+        add_finding(ArlMessageCode::BudgetExceeded, "", budget_option, nullptr, "", budget);
+        if (format == ReportFormat::JSONL)
+            write_jsonl_message(output, ArlMessageCode::BudgetExceeded, "", budget_option, nullptr, pdf_version, "", budget);
+        else
+            output << COLOR_ERROR << "budget exceeded (" << budget << "): stopped after " << counter << " objects with " << (to_process.size() + spill_pending) << " objects not checked" << COLOR_RESET;
+        while (to_process.size() > 0) {
+            if (to_process.front().object->is_deleteable())
+                delete to_process.front().object;
+            to_process.pop();
+        }
+        while (spill_kept.size() > 0) {
+            if (spill_kept.front().object->is_deleteable())
+                delete spill_kept.front().object;
+            spill_kept.pop();
+        }
+        spill_pending = 0;
+    }
+    if (spill_file != nullptr)
+        std::fclose(spill_file);
+    spill_file = nullptr;
+    if (depth_skipped > 0) {
+        add_finding(ArlMessageCode::DepthBudgetExceeded, "", "", nullptr, "", std::to_string(depth_skipped));
+        if (format == ReportFormat::JSONL)
+            write_jsonl_message(output, ArlMessageCode::DepthBudgetExceeded, "", "", nullptr, pdf_version, "", std::to_string(depth_skipped));
+        else
+            output << COLOR_ERROR << "budget exceeded (--max-depth " << max_depth << "): " << depth_skipped << " objects were not checked" << COLOR_RESET;
+    }
+    for (auto& r : repeats) {
+        if (r.second <= max_repeats)
+            continue;
+        int                 code = std::get<0>(r.first);
+        const std::string&  link = std::get<1>(r.first);
+        const std::string&  key = std::get<2>(r.first);
+        unsigned int        n = r.second - max_repeats;
+        if (log != nullptr)
+            log->add(ArlMessageCode::Suppressed, link, key, nullptr, "", std::to_string(code) + ":" + std::to_string(n), format);
+        if (format == ReportFormat::JSONL)
+            write_jsonl_message(output, ArlMessageCode::Suppressed, link, key, nullptr, pdf_version, "", std::to_string(code) + ":" + std::to_string(n));
+        else {
+            output << COLOR_INFO << n << " more " << get_message_type_name(get_message_type((ArlMessageCode)code)) << " messages (code " << code << ")";
+            if (!link.empty())
+                output << " for " << link << (key.empty() ? "" : "/") << key;
+            output << " suppressed (--max-repeats " << max_repeats << ")" << COLOR_RESET;
+        }
+    }
 
     // Clean up
     pdfc = nullptr;
@@ -27,8 +27,15 @@
 #define ParseObjects_h
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <string>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <iostream>
 #include <queue>
 #include <cassert>
@@ -45,29 +52,62 @@ using namespace ArlingtonPDFShim;
 class CParsePDF
 {
 private:
+    /// @brief Key of an indirect object in mapped and link_scores: object number (high 32 bits) and generation number
+    static uint64_t object_key(ArlPDFObject* obj) {
+        return ((uint64_t)(uint32_t)obj->get_object_number() << 32) | (uint32_t)obj->get_generation_number();
+    }
+
+    /// @brief Hash for link_scores keys (object key, link set id)
+    struct link_score_hash {
+        size_t operator()(const std::pair<uint64_t, int>& k) const {
+            return std::hash<uint64_t>()(k.first * 31 + (uint64_t)k.second);
+        }
+    };
+
+    /// @brief Arlington links (TSV filenames) referenced by mapped. There are only a few hundred.
+    std::unordered_set<std::string>         link_names;
+
     /// @brief Remembering processed PDF objects (and how they were validated).
-    ///        Storing hash_id of object as key and link with which we validated the object as the value.
-    std::map<std::string, std::string>      mapped;
+    ///        Storing object_key() of object as key and link (in link_names) with which we validated the object as the value.
+    std::unordered_map<uint64_t, const std::string*>    mapped;
 
-    /// @brief the Arlington PDF model (cache of loaded TSV grammar files)
-    std::map<std::string, std::unique_ptr<CArlingtonTSVGrammarFile>>  grammar_map;
+
+    /// @brief Where a PDF object is (only for low_memory): an indirect object number (0 if unknown) and the
+    ///        dictionary keys (L"/Key"), array indices (L"[0") and stream dictionaries (L"#") from there.
+    struct obj_location {
+        int                         obj_nbr;
+        std::vector<std::wstring>   path;
+
+        obj_location(const int n = 0)
+            : obj_nbr(n)
+            { /* constructor */ }
+    };
 
     /// @brief Data structure for recursive processing of the ArlPDFObjects
-    /// @todo - lifetime management of recursive parent objects AND not blow out memory!
     struct queue_elem {
-        ArlPDFObject* parent;   // PDF object of parent (can be null for trailer)
         ArlPDFObject* object;   // PDF object (e.g. of a key)
         std::string   link;     // Arlington TSV filename
         std::string   context;  // PDF DOM path
+        int           depth;    // number of levels below a root object
+        std::unique_ptr<obj_location> loc; // where object is (only for low_memory, else nullptr)
 
-        queue_elem(ArlPDFObject* p, ArlPDFObject* o, const std::string &l, const std::string &c)
-            : parent(p), object(o), link(l), context(c)
+        queue_elem(ArlPDFObject* o, const std::string &l, const std::string &c, const int d = 0, const obj_location& w = obj_location())
+            : object(o), link(l), context(c), depth(d), loc((w.obj_nbr != 0) ? new obj_location(w) : nullptr)
             { /* constructor */ assert(object != nullptr); assert(link.size() > 0); }
+
+        /// @brief returns where the object is, or an unknown location
+        const obj_location& location() const {
+            static const obj_location unknown;
+            return (loc != nullptr) ? *loc : unknown;
+        }
     };
 
     /// @brief The list of PDF objects to process
     std::queue<queue_elem>  to_process;
 
+    /// @brief the Arlington PDF model (cache of loaded TSV grammar files, shared across PDFs)
+    CArlingtonTSVGrammarCache&  grammar_cache;
+
     /// @brief The folder with an Arlington TSV file set
     fs::path                grammar_folder;
 
@@ -94,33 +134,173 @@ private:
     /// @brief Line counter of the PDF DOM for easier analysis and debugging
     unsigned int            counter;
 
-    void show_context(queue_elem& e);
+    /// @brief Release PDF objects in the PDF SDK once they and all their children have been checked (--low-memory)
+    bool                    low_memory;
+
+    /// @brief Number of queued objects (values) that still reference each indirect object number (keys). Only for low_memory.
+    ///        Name and number tree nodes are also counted while their values are being queued.
+    std::map<int, int>      pending_refs;
+
+    void pin_object(const int obj_nbr);
+    void unpin_object(const int obj_nbr, const bool release = true);
+
+    /// @brief low_memory: at most this many queued PDF objects are kept in to_process. Later ones are spilled.
+    static constexpr size_t MAX_IN_MEMORY = 1024;
+
+    /// @brief low_memory: temporary file of spilled queue elements (in queue order, after to_process), or nullptr.
+    ///        PDF objects are written as their location and read back with get_object_at().
+    std::FILE*              spill_file;
+
+    /// @brief low_memory: read and write offsets into spill_file, and whether it was last written to
+    long                    spill_read_pos;
+    long                    spill_write_pos;
+    bool                    spill_writing;
+
+    /// @brief low_memory: number of queue elements in spill_file
+    size_t                  spill_pending;
+
+    /// @brief low_memory: queue elements to be spilled once their PDF objects are no longer used by the caller
+    std::queue<queue_elem>  spill_outgoing;
+
+    /// @brief low_memory: spilled queue elements that cannot be read back (direct objects, etc.) so stay in memory.
+    ///        spill_file only has a marker for these.
+    std::queue<queue_elem>  spill_kept;
+
+    void flush_spill();
+    void refill_from_spill();
+
+    obj_location object_location(ArlPDFObject* obj, const obj_location& reached_from);
+    obj_location locate(const obj_location& loc, const std::wstring& key);
+    obj_location locate(const obj_location& loc, const int index);
+    ArlPDFObject* get_object_at(const obj_location& loc);
+
+    /// @brief Per-PDF processing budgets (--max-objects, --max-seconds, --max-depth). 0 = unlimited.
+    unsigned int            max_objects;
+    unsigned int            max_seconds;
+    int                     max_depth;
+
+    /// @brief --max-seconds: when the time budget is spent
+    std::chrono::steady_clock::time_point   deadline;
+
+    /// @brief number of calls of past_deadline(). The clock is only looked at every 256 calls.
+    unsigned int            deadline_ticks;
+
+    /// @brief true once the time budget is spent. Everything then unwinds to parse_object().
+    bool                    out_of_time;
+
+    /// @brief returns true once the time budget (--max-seconds) is spent
+    bool past_deadline() {
+        if (out_of_time)
+            return true;
+        if ((max_seconds == 0) || ((++deadline_ticks & 0xFF) != 0))
+            return false;
+        out_of_time = (std::chrono::steady_clock::now() >= deadline);
+        return out_of_time;
+    }
+
+    /// @brief depth of the queue element currently being processed
+    int                     current_depth;
+
+    /// @brief number of PDF objects not checked because of --max-depth
+    unsigned int            depth_skipped;
+
+    /// @brief Maximum number of messages with the same code, Arlington object and key (--max-repeats). 0 = unlimited.
+    unsigned int            max_repeats;
+
+    /// @brief Number of messages for each code, Arlington object and key. Only for max_repeats.
+    arl_findings            repeats;
+
+    /// @brief Number of messages since the report was last flushed. See report().
+    unsigned int            unflushed;
+
+    /// @brief Text or JSON Lines report (--format)
+    ReportFormat            format;
+
+    /// @brief Findings of the PDF for --stats, or nullptr
+    arl_findings*           findings;
+
+    /// @brief Messages of the PDF for the structured API, or nullptr
+    CArlMessageLog*         log;
+
+    /// @brief --metrics: PDF objects checked are added to this every 256 objects, or nullptr
+    std::atomic<uint64_t>*  objects_checked;
+
+    /// @brief Counts a message in the findings and records it in the message log
+    void add_finding(const ArlMessageCode code, const std::string& link, const std::string& key, ArlPDFObject* object, const std::string& context, const std::string& value);
+
+    /// @brief Outputs the context line once, before the first message about the current queue element
+    void show_context(ArlPDFObject* object, const std::string& context);
+
+    /// @brief Starts a message about an object. Returns true if the caller is to output the text of the message.
+    bool report(const ArlMessageCode code, ArlPDFObject* object, const std::string& context, const std::string& link, const std::string& key = "", const std::string& value = "");
+
+    /// @brief Reports a version-based feature that does not match the PDF version
+    void report_version_reason(ArlVersion& versioner, const queue_elem& elem, ArlPDFObject* object, const char* feature, const std::string& key);
 
     /// @brief Locates & reads in a single Arlington TSV grammar file.
     const ArlTSVmatrix& get_grammar(const std::string& link);
 
-    void parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::string>& links, const std::string context, const bool root = true);
-    void parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::string>& links, const std::string context, const bool root = true);
+    void parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::string>& links, const std::string context, const obj_location& loc, const bool root = true);
+    void parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::string>& links, const std::string context, const obj_location& loc, const bool root = true);
 
-    std::string recommended_link_for_object(ArlPDFObject* obj, const std::vector<std::string> links, const std::string obj_name);
+    /// @brief Remembered outcomes of recommended_link_for_object() for indirect objects.
+    ///        Key is object_key() of object plus the id of the link set. Value is index into the link set (or -1).
+    std::unordered_map<std::pair<uint64_t, int>, int, link_score_hash>  link_scores;
+
+    /// @brief Ids of the link sets in link_scores. Key is the links joined with ';'.
+    std::unordered_map<std::string, int>    link_set_ids;
+
+    /// @brief Best possible link scores for each Arlington TSV file (suffix sums per row)
+    std::map<std::string, std::vector<int>> best_row_scores;
+
+    const std::vector<int>& get_best_row_scores(const std::string& link);
+
+    std::string recommended_link_for_object(ArlPDFObject* obj, const std::vector<std::string>& links, const std::string& obj_name);
+    int score_links_for_object(ArlPDFObject* obj, const std::vector<std::string>& links, const std::string& obj_name);
 
     bool check_numeric_array(ArlPDFArray* arr, const int elems_to_check);
     void check_everything(ArlPDFObject* parent, ArlPDFObject* obj, const int key_idx, const ArlTSVmatrix& tsv_data, const std::string& grammar_file, const std::string& context, std::ostream& ofs);
-    ArlPDFObject* find_via_inheritance(ArlPDFDictionary* obj, const std::wstring& key, const int depth = 0);
+    ArlPDFObject* find_via_inheritance(ArlPDFDictionary* obj, const std::wstring& key);
 
     /// @brief add an object to be checked
-    void add_parse_object(ArlPDFObject* parent, ArlPDFObject* object, const std::string& link, const std::string& context);
+    void add_parse_object(ArlPDFObject* parent, ArlPDFObject* object, const std::string& link, const std::string& context, const obj_location& loc = obj_location());
 
 public:
-    CParsePDF(const fs::path& tsv_folder, std::ostream &ofs, const bool terser_output, const bool debug_output)
-        : grammar_folder(tsv_folder), output(ofs), terse(terser_output), pdfc(nullptr), counter(0), context_shown(false), debug_mode(debug_output), pdf_version(0)
+    CParsePDF(CArlingtonTSVGrammarCache& tsv_cache, std::ostream &ofs, const bool terser_output, const bool debug_output)
+        : grammar_cache(tsv_cache), grammar_folder(tsv_cache.get_tsv_dir()), output(ofs), terse(terser_output), pdfc(nullptr), counter(0), context_shown(false), debug_mode(debug_output), pdf_version(0),
+          low_memory(false), spill_file(nullptr), spill_read_pos(0), spill_write_pos(0), spill_writing(false), spill_pending(0), max_objects(0), max_seconds(0), max_depth(0), deadline_ticks(0), out_of_time(false), current_depth(0), depth_skipped(0), max_repeats(0), unflushed(0), format(ReportFormat::Text), findings(nullptr), log(nullptr), objects_checked(nullptr)
         { /* constructor */ }
 
+    /// @brief set per-PDF processing budgets. 0 = unlimited.
+    void set_budgets(const unsigned int objects, const unsigned int seconds, const int depth)
+        { max_objects = objects; max_seconds = seconds; max_depth = depth; }
+
+    /// @brief set the maximum number of messages with the same code, Arlington object and key. 0 = unlimited.
+    void set_max_repeats(const unsigned int n) { max_repeats = n; }
+
+    /// @brief enable bounded-memory traversal
+    void set_low_memory(const bool b) { low_memory = b; }
+
+    /// @brief set the report format
+    void set_format(const ReportFormat f) { format = f; }
+
+    /// @brief set where findings are counted for --stats (nullptr if not needed)
+    void set_findings(arl_findings* f) { findings = f; }
+
+    /// @brief set where messages are recorded for the structured API (nullptr if not needed)
+    void set_message_log(CArlMessageLog* l) { log = l; }
+
+    /// @brief set the counter that PDF objects checked are added to as they are checked (nullptr if not needed)
+    void set_objects_checked(std::atomic<uint64_t>* n) { objects_checked = n; }
+
     /// @brief add an object to be checked
     void add_root_parse_object(ArlPDFObject* object, const std::string& link, const std::string& context);
 
     /// @brief begin analysing a PDF file from a "root" object (most likely the trailer)
     bool parse_object(CPDFFile& pdf);
+
+    /// @brief number of PDF objects checked by parse_object()
+    unsigned int get_objects_checked() const { return counter; }
 };
 
 #endif // ParseObjects_h
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief CReportStore class definition
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <sstream>
+
+#include "ReportStore.h"
+
+
+/// @brief Opens (or creates) a store. Segments are only created when reports are appended.
+///
+/// @param[in] folder     store folder (created if needed)
+/// @param[in] extension  report extension (.txt, .ansi or .jsonl) used for the segments
+/// @param[in] writers    number of writers that append reports concurrently
+///
+/// @returns true if the index could be opened
+bool CReportStore::open(const fs::path& folder, const std::string& extension, const unsigned int writers) {
+    try {
+        store_folder = folder;
+        rpt_extension = extension;
+        fs::create_directories(store_folder);
+
+        char id[16];
+        snprintf(id, sizeof(id), "%08x", (unsigned int)std::random_device{}());
+        run_id = id;
+        segments.clear();
+        for (unsigned int i = 0; i < writers; i++)
+            segments.emplace_back(new segment);
+
+        fs::path idx = store_folder / INDEX_NAME;
+        bool is_new = !fs::exists(idx);
+        index.open(idx, std::ofstream::out | std::ofstream::app | std::ofstream::binary);
+        if (is_new && index.is_open())
+            index << "# TestGrammar report store: segment<TAB>offset<TAB>length<TAB>status<TAB>errors<TAB>warnings<TAB>infos<TAB>PDF" << std::endl;
+        return index.is_open();
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+
+/// @brief Returns the segment file of a writer
+///
+/// @param[in] writer   the writer (0 to writers - 1)
+fs::path CReportStore::get_segment(const unsigned int writer) {
+    return store_folder / ("reports-" + run_id + "-" + std::to_string(writer + 1) + rpt_extension);
+}
+
+
+/// @brief Appends a report to the segment of a writer and then adds it to the index. Each writer
+/// only ever appends to its own segment so only the index is locked. Both are flushed for every
+/// report so the store remains valid if the run is killed.
+///
+/// @param[in] writer    the writer (0 to writers - 1)
+/// @param[in] pdf_file  the PDF
+/// @param[in] report    the full report
+/// @param[in] status    the outcome: "OK", "FATAL" or "FAILED"
+/// @param[in] findings  findings of the PDF, to count errors, warnings and infos
+///
+/// @returns true on success
+bool CReportStore::append(const unsigned int writer, const fs::path& pdf_file, const std::string& report, const std::string& status, const arl_findings& findings) {
+    if ((writer >= segments.size()) || !index.is_open())
+        return false;
+
+    segment& seg = *segments[writer];
+    if (!seg.file.is_open()) {
+        seg.filename = get_segment(writer);
+        seg.file.open(seg.filename, std::ofstream::out | std::ofstream::app | std::ofstream::binary);
+        if (!seg.file.is_open())
+            return false;
+        std::error_code ec;
+        auto sz = fs::file_size(seg.filename, ec);
+        seg.size = ec ? 0 : (uint64_t)sz;
+    }
+    uint64_t offset = seg.size;
+    seg.file.write(report.data(), (std::streamsize)report.size());
+    seg.file.flush();
+    if (seg.file.fail())
+        return false;
+    seg.size += report.size();
+
+    unsigned int counts[3] = { 0, 0, 0 };  // by ArlMessageType
+    for (auto& f : findings)
+        counts[(int)get_message_type((ArlMessageCode)std::get<0>(f.first))] += f.second;
+
+    std::ostringstream line;
+    line << seg.filename.filename().string() << '\t' << offset << '\t' << report.size() << '\t' << status << '\t'
+         << counts[(int)ArlMessageType::Error] << '\t' << counts[(int)ArlMessageType::Warning] << '\t' << counts[(int)ArlMessageType::Info] << '\t'
+         << fs::absolute(pdf_file).lexically_normal().string() << '\n';
+    std::lock_guard<std::mutex> lock(idx_mutex);
+    index << line.str();
+    index.flush();
+    return !index.fail();
+}
+
+
+/// @brief Reads the index of a store once so that any number of reports can then be extracted
+/// without rescanning it. Later entries for a PDF replace earlier ones so the latest report is kept.
+///
+/// @param[in] folder    store folder
+///
+/// @returns true if the index could be read
+bool CReportStore::load_index(const fs::path& folder) {
+    std::ifstream   idx(folder / INDEX_NAME);
+    std::string     line;
+    if (!idx.is_open())
+        return false;
+    store_folder = folder;
+    located.clear();
+    while (std::getline(idx, line)) {
+        if (line.empty() || (line[0] == '#'))
+            continue;
+        // The PDF is the last field so it can contain tabs
+        size_t t = 0;
+        std::vector<std::string> fields;
+        for (int i = 0; (i < 7) && (t != std::string::npos); i++) {
+            size_t next = line.find('\t', t);
+            if (next == std::string::npos)
+                break;
+            fields.push_back(line.substr(t, next - t));
+            t = next + 1;
+        }
+        if (fields.size() < 7)
+            continue;
+        try {
+            report_location loc;
+            loc.offset = std::stoull(fields[1]);
+            loc.length = std::stoull(fields[2]);
+            loc.segment = fields[0];
+            located[line.substr(t)] = loc;
+        }
+        catch (...) {
+            // ignore corrupt lines
+        }
+    }
+    return true;
+}
+
+
+/// @brief Writes the latest report of a PDF in a store loaded with load_index()
+///
+/// @param[in] pdf_file  the PDF, as it was given to --pdf
+/// @param[in] ofs       output stream for the report
+///
+/// @returns true if the PDF was found and its report written
+bool CReportStore::extract(const fs::path& pdf_file, std::ostream& ofs) const {
+    auto it = located.find(fs::absolute(pdf_file).lexically_normal().string());
+    if (it == located.end())
+        return false;
+    uint64_t length = it->second.length;
+
+    std::ifstream seg(store_folder / it->second.segment, std::ios::in | std::ios::binary);
+    if (!seg.is_open() || !seg.seekg((std::streamoff)it->second.offset))
+        return false;
+    std::vector<char> buf(1024 * 1024);
+    while (length > 0) {
+        std::streamsize n = (std::streamsize)std::min<uint64_t>(length, buf.size());
+        if (!seg.read(buf.data(), n))
+            return false;
+        ofs.write(buf.data(), n);
+        length -= (uint64_t)n;
+    }
+    ofs.flush();
+    return true;
+}
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief CReportStore class declaration
+///
+/// An append-only store of reports (--store) so that a large corpus does not
+/// create one report file per PDF.
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ReportStore_h
+#define ReportStore_h
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ArlMessages.h"
+
+namespace fs = std::filesystem;
+
+
+/// @class CReportStore
+/// Reports are appended to segment files in a store folder, one segment per writer (e.g. per
+/// --jobs worker thread) per run, so writers never share a segment. Every report is listed in
+/// an index file (index.tsv) shared by all writers and runs: segment, offset, length, status,
+/// number of errors, warnings and infos, and PDF. A report is written to its segment before
+/// it is added to the index so the index only lists complete reports.
+class CReportStore {
+    /// @brief a segment file being appended to by a single writer
+    struct segment {
+        fs::path        filename;
+        std::ofstream   file;
+        uint64_t        size = 0;   // current size = offset of the next report
+    };
+
+    /// @brief folder with the segments and the index
+    fs::path            store_folder;
+
+    /// @brief segment names are "reports-<run>-<writer>" plus this extension
+    std::string         rpt_extension;
+
+    /// @brief random identifier of this run so concurrent runs never share a segment
+    std::string         run_id;
+
+    /// @brief the segment of each writer, opened when the writer first appends a report
+    std::vector<std::unique_ptr<segment>> segments;
+
+    /// @brief protects index
+    std::mutex          idx_mutex;
+
+    /// @brief index.tsv, opened for appending
+    std::ofstream       index;
+
+    /// @brief where a report is in a store
+    struct report_location {
+        std::string     segment;
+        uint64_t        offset = 0;
+        uint64_t        length = 0;
+    };
+
+    /// @brief the latest report of each PDF (absolute path), read from index.tsv by load_index()
+    std::unordered_map<std::string, report_location> located;
+
+public:
+    /// @brief name of the index file in a store folder
+    static constexpr const char* INDEX_NAME = "index.tsv";
+
+    /// @brief Opens (or creates) a store for a number of concurrent writers
+    bool open(const fs::path& folder, const std::string& extension, const unsigned int writers);
+
+    /// @brief Appends a report and adds it to the index. Thread-safe for different writers.
+    bool append(const unsigned int writer, const fs::path& pdf_file, const std::string& report, const std::string& status, const arl_findings& findings);
+
+    /// @brief Returns the segment file of a writer
+    fs::path get_segment(const unsigned int writer);
+
+    /// @brief Reads the index of a store so that reports can be extracted
+    bool load_index(const fs::path& folder);
+
+    /// @brief Writes the latest report of a PDF in a store loaded with load_index()
+    bool extract(const fs::path& pdf_file, std::ostream& ofs) const;
+};
+
+#endif // ReportStore_h
@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief CResultCache class definition
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "ResultCache.h"
+
+// pdfium's vendored SHA-256 implementation (always compiled, regardless of PDF SDK)
+#include "core/include/fxcrt/fx_basic.h"
+#include "core/include/fdrm/fx_crypt.h"
+
+/// @brief first line of every cache entry, followed by OK or FATAL. The findings of the PDF
+/// (for --stats) and an empty line follow, then the report.
+constexpr auto CACHE_MAGIC = "ArlingtonResultCache2 ";
+
+
+/// @brief Converts a SHA-256 digest to lowercase hex
+static std::string to_hex(const FX_BYTE digest[32]) {
+    static const char hex[] = "0123456789abcdef";
+    std::string s;
+    s.reserve(64);
+    for (int i = 0; i < 32; i++) {
+        s += hex[digest[i] >> 4];
+        s += hex[digest[i] & 0x0F];
+    }
+    return s;
+}
+
+
+/// @brief Streams a file through SHA-256
+///
+/// @param[in,out] ctx    SHA-256 context that has been started
+/// @param[in]     fname  file to hash
+///
+/// @returns false if the file could not be read
+static bool sha256_update_file(sha256_context* ctx, const fs::path& fname) {
+    std::ifstream f(fname, std::ios::in | std::ios::binary);
+    if (!f.is_open())
+        return false;
+    std::vector<char> buf(1024 * 1024);
+    while (f) {
+        f.read(buf.data(), buf.size());
+        std::streamsize n = f.gcount();
+        if (n > 0)
+            CRYPT_SHA256Update(ctx, (FX_LPCBYTE)buf.data(), (FX_DWORD)n);
+    }
+    return f.eof();
+}
+
+
+/// @brief Adds a string to a SHA-256, including a terminator so adjacent strings cannot run together
+static void sha256_update_string(sha256_context* ctx, const std::string& s) {
+    CRYPT_SHA256Update(ctx, (FX_LPCBYTE)s.data(), (FX_DWORD)s.size());
+    CRYPT_SHA256Update(ctx, (FX_LPCBYTE)"\n", 1);
+}
+
+
+/// @brief Creates the cache and calculates the hash of the Arlington TSV file set and options.
+/// is_valid() will be false if the cache folder cannot be created or the TSV files cannot be read.
+///
+/// @param[in] cache_dir  folder for cached reports (created if needed)
+/// @param[in] tsv_dir    folder with the Arlington TSV file set
+/// @param[in] options    TestGrammar and PDF SDK versions and all options that affect reports
+CResultCache::CResultCache(const fs::path& cache_dir, const fs::path& tsv_dir, const std::string& options)
+    : cache_folder(cache_dir), tsv_folder(fs::absolute(tsv_dir).lexically_normal()), hits(0), misses(0)
+{
+    try {
+        fs::create_directories(cache_folder);
+
+        // Hash all TSV files in a stable (sorted) order
+        std::vector<fs::path> tsv_files;
+        for (const auto& entry : fs::directory_iterator(tsv_dir))
+            if (entry.is_regular_file() && (entry.path().extension() == ".tsv"))
+                tsv_files.push_back(entry.path());
+        std::sort(tsv_files.begin(), tsv_files.end());
+
+        sha256_context ctx;
+        FX_BYTE digest[32];
+        CRYPT_SHA256Start(&ctx);
+        sha256_update_string(&ctx, options);
+        for (const auto& tsv : tsv_files) {
+            sha256_update_string(&ctx, tsv.filename().string());
+            if (!sha256_update_file(&ctx, tsv))
+                return;
+        }
+        CRYPT_SHA256Finish(&ctx, digest);
+        base_key = to_hex(digest);
+    }
+    catch (...) {
+        base_key.clear();
+    }
+}
+
+
+/// @brief Calculates the cache key for a PDF file from its content. Thread-safe.
+///
+/// @param[in] pdf_file   the PDF file
+///
+/// @returns the key (hex SHA-256) or empty string if the PDF could not be read
+std::string CResultCache::make_key(const fs::path& pdf_file) {
+    sha256_context ctx;
+    FX_BYTE digest[32];
+    CRYPT_SHA256Start(&ctx);
+    sha256_update_string(&ctx, base_key);
+    if (!sha256_update_file(&ctx, pdf_file))
+        return "";
+    CRYPT_SHA256Finish(&ctx, digest);
+    return to_hex(digest);
+}
+
+
+/// @brief Writes a cached report, if there is one. The "PDF:" line (or the Begin record of a
+/// JSON Lines report) is replaced with the current PDF filename as identical PDFs may have different names.
+/// Likewise the "Arlington TSV data:" line is replaced as identical TSV file sets may be in different folders.
+///
+/// @param[in]  key       cache key from make_key()
+/// @param[in]  pdf_file  the PDF file
+/// @param[in]  ofs       report output stream
+/// @param[out] ok        true if the cached report was not a fatal error
+/// @param[out] findings  findings of the PDF for --stats, or nullptr
+///
+/// @returns true if the report was in the cache and has been written to ofs
+bool CResultCache::lookup(const std::string& key, const fs::path& pdf_file, std::ostream& ofs, bool& ok, arl_findings* findings) {
+    std::ifstream entry(cache_folder / key.substr(0, 2) / key, std::ios::in | std::ios::binary);
+    std::string   line;
+    if (!entry.is_open() || !std::getline(entry, line) || (line.rfind(CACHE_MAGIC, 0) != 0)) {
+        misses++;
+        return false;
+    }
+    ok = (line.substr(strlen(CACHE_MAGIC)) == "OK");
+
+    std::string cached_findings;
+    while (std::getline(entry, line) && !line.empty())
+        cached_findings += line + "\n";
+    if ((findings != nullptr) && !findings_from_string(cached_findings, *findings)) {
+        misses++;
+        return false;
+    }
+
+    bool pdf_line_done = false;
+    while (std::getline(entry, line)) {
+        if (!pdf_line_done && (line.rfind("Arlington TSV data: ", 0) == 0))
+            ofs << "Arlington TSV data: " << tsv_folder << "\n";
+        else if (!pdf_line_done && (line.rfind("PDF: ", 0) == 0)) {
+            ofs << "PDF: " << fs::absolute(pdf_file).lexically_normal() << "\n";
+            pdf_line_done = true;
+        }
+        else if (!pdf_line_done && (line.rfind("{\"code\":1,", 0) == 0)) {
+            write_jsonl_message(ofs, ArlMessageCode::Begin, "", "", nullptr, 0, "", fs::absolute(pdf_file).lexically_normal().string());
+            pdf_line_done = true;
+        }
+        else
+            ofs << line << "\n";
+    }
+    ofs.flush();
+    hits++;
+    return true;
+}
+
+
+/// @brief Adds a report to the cache. The entry is written to a temporary file and then renamed
+/// so that other threads and processes never see a partial entry. Errors are silently ignored.
+///
+/// @param[in] key      cache key from make_key()
+/// @param[in] report   the full report
+/// @param[in] ok       false if the report was a fatal error
+/// @param[in] findings findings of the PDF for --stats
+void CResultCache::store(const std::string& key, const std::string& report, const bool ok, const arl_findings& findings) {
+    try {
+        fs::path dir = cache_folder / key.substr(0, 2);
+        fs::create_directories(dir);
+        fs::path tmp = dir / (key + ".tmp" + std::to_string(std::random_device{}()));
+        {
+            std::ofstream out(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+            out << CACHE_MAGIC << (ok ? "OK" : "FATAL") << "\n" << findings_to_string(findings) << "\n" << report;
+            out.close();
+            if (out.fail()) {
+                fs::remove(tmp);
+                return;
+            }
+        }
+        fs::rename(tmp, dir / key);
+    }
+    catch (...) {
+        // ignore - the cache is only an optimization
+    }
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief CResultCache class declaration
+///
+/// A persistent, content-addressed cache of PDF reports (--cache) so that
+/// unchanged PDFs are not re-checked against an unchanged Arlington model.
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ResultCache_h
+#define ResultCache_h
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "ArlMessages.h"
+
+namespace fs = std::filesystem;
+
+
+/// @class CResultCache
+/// Reports are stored in a cache folder under the SHA-256 of (PDF file content, Arlington TSV
+/// file set content, TestGrammar and PDF SDK versions, options that affect the report).
+/// Cache entries are written atomically so the cache can be shared by --jobs threads,
+/// --isolate worker processes and concurrent runs.
+class CResultCache {
+    /// @brief folder with the cached reports
+    fs::path            cache_folder;
+
+    /// @brief folder of the Arlington TSV file set, for the "Arlington TSV data:" line of cached reports
+    fs::path            tsv_folder;
+
+    /// @brief SHA-256 (hex) of everything other than the PDF that affects a report
+    std::string         base_key;
+
+public:
+    /// @brief number of reports found in the cache
+    std::atomic<unsigned int>   hits;
+
+    /// @brief number of reports not found in the cache
+    std::atomic<unsigned int>   misses;
+
+    CResultCache(const fs::path& cache_dir, const fs::path& tsv_dir, const std::string& options);
+
+    /// @brief Returns true if the cache folder could be created
+    bool is_valid() { return !base_key.empty(); }
+
+    /// @brief Calculates the cache key for a PDF file
+    std::string make_key(const fs::path& pdf_file);
+
+    /// @brief Writes a cached report, if there is one
+    bool lookup(const std::string& key, const fs::path& pdf_file, std::ostream& ofs, bool& ok, arl_findings* findings);
+
+    /// @brief Adds a report to the cache
+    void store(const std::string& key, const std::string& report, const bool ok, const arl_findings& findings);
+};
+
+#endif // ResultCache_h
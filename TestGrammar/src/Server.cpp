@@ -0,0 +1,598 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Long-running validation server (--serve) and its client (--connect)
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "Server.h"
+#include "ArlPredicates.h"
+#include "utils.h"
+
+#if defined(_WIN32) || defined(WIN32)
+
+/// @brief The server is not supported on Windows
+int serve(const fs::path& socket_path, const unsigned int workers, const serve_request& defaults, serve_check_fn check) {
+    UNREFERENCED_FORMAL_PARAM(socket_path);
+    UNREFERENCED_FORMAL_PARAM(workers);
+    UNREFERENCED_FORMAL_PARAM(defaults);
+    UNREFERENCED_FORMAL_PARAM(check);
+    std::cerr << COLOR_ERROR << "--serve is not supported on Windows!" << COLOR_RESET;
+    return -1;
+}
+
+/// @brief The client is not supported on Windows
+int serve_client(const fs::path& socket_path, const std::vector<fs::path>& pdfs, const fs::path& save_path, const std::string& rpt_extension, const std::string& options, const unsigned int connections) {
+    UNREFERENCED_FORMAL_PARAM(socket_path);
+    UNREFERENCED_FORMAL_PARAM(pdfs);
+    UNREFERENCED_FORMAL_PARAM(save_path);
+    UNREFERENCED_FORMAL_PARAM(rpt_extension);
+    UNREFERENCED_FORMAL_PARAM(options);
+    UNREFERENCED_FORMAL_PARAM(connections);
+    std::cerr << COLOR_ERROR << "--connect is not supported on Windows!" << COLOR_RESET;
+    return -1;
+}
+
+#else
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0      // macOS: SIGPIPE is ignored instead
+#endif
+
+/// @brief Maximum size of a request payload
+constexpr uint32_t MAX_REQUEST_SIZE = 64 * 1024;
+
+/// @brief Maximum number of file descriptors received with one read. Only the first is used.
+constexpr int MAX_RECV_FDS = 16;
+
+/// @brief Set by SIGINT/SIGTERM to stop the server
+static volatile sig_atomic_t serve_stop = 0;
+
+static void serve_signal_handler(int) {
+    serve_stop = 1;
+}
+
+
+/// @brief Reads exactly len bytes from a socket, optionally receiving a file descriptor
+///
+/// @param[in]  fd       socket
+/// @param[out] buf      buffer
+/// @param[in]  len      number of bytes
+/// @param[in,out] recv_fd  if not nullptr, set to the first file descriptor sent with the data (or left as -1).
+///                          Any other file descriptors are closed.
+///
+/// @returns true if all len bytes were read, false on EOF or error
+static bool sock_read(int fd, void* buf, size_t len, int* recv_fd = nullptr) {
+    char* p = (char*)buf;
+    while (len > 0) {
+        struct iovec iov = { p, len };
+        struct msghdr msg;
+        union {
+            char            buf[CMSG_SPACE(sizeof(int) * MAX_RECV_FDS)];
+            struct cmsghdr  align;
+        } ctrl;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (recv_fd != nullptr) {
+            msg.msg_control = ctrl.buf;
+            msg.msg_controllen = sizeof(ctrl.buf);
+        }
+        ssize_t n = recvmsg(fd, &msg, 0);
+        if ((n < 0) && (errno == EINTR))
+            continue;
+        if (n <= 0)
+            return false;
+        if (recv_fd != nullptr)
+            for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c != nullptr; c = CMSG_NXTHDR(&msg, c))
+                if ((c->cmsg_level == SOL_SOCKET) && (c->cmsg_type == SCM_RIGHTS)) {
+                    size_t nfds = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                    for (size_t i = 0; i < nfds; i++) {
+                        int sent_fd;
+                        memcpy(&sent_fd, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+                        if (*recv_fd < 0)
+                            *recv_fd = sent_fd;
+                        else
+                            close(sent_fd);
+                    }
+                }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+
+/// @brief Writes exactly len bytes to a socket
+///
+/// @returns true if all len bytes were written
+static bool sock_write(int fd, const void* buf, size_t len) {
+    const char* p = (const char*)buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if ((n < 0) && (errno == EINTR))
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+
+/// @brief Writes a 32-bit big-endian value to a socket
+static bool sock_write_u32(int fd, uint32_t v) {
+    v = htonl(v);
+    return sock_write(fd, &v, sizeof(v));
+}
+
+
+/// @brief Reads a 32-bit big-endian value from a socket
+static bool sock_read_u32(int fd, uint32_t& v, int* recv_fd = nullptr) {
+    if (!sock_read(fd, &v, sizeof(v), recv_fd))
+        return false;
+    v = ntohl(v);
+    return true;
+}
+
+
+/// @class socket_streambuf
+/// Output stream buffer that sends a report back to a client as length-prefixed frames.
+/// std::endl flushes are ignored so that each frame holds many lines.
+class socket_streambuf : public std::streambuf {
+    int                 sock;
+    std::vector<char>   buffer;
+    bool                failed = false;
+
+    bool send_frame() {
+        size_t n = pptr() - pbase();
+        if ((n > 0) && !failed)
+            failed = !sock_write_u32(sock, (uint32_t)n) || !sock_write(sock, pbase(), n);
+        setp(buffer.data(), buffer.data() + buffer.size());
+        return !failed;
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!send_frame())
+            return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return ch;
+    }
+
+    int sync() override { return 0; }
+
+public:
+    explicit socket_streambuf(int fd) : sock(fd), buffer(64 * 1024) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+    /// @brief Sends any remaining report data and the end of report status
+    bool finish(ServeStatus status) {
+        return send_frame() && sock_write_u32(sock, 0) && sock_write_u32(sock, (uint32_t)status);
+    }
+};
+
+
+/// @brief Parses a request payload of "key=value" lines
+///
+/// @param[in]  payload  the request
+/// @param[out] req      the request, already initialized with the server defaults
+/// @param[out] error    description of a bad request
+///
+/// @returns true if the request is valid
+static bool parse_request(const std::string& payload, serve_request& req, std::string& error) {
+    std::istringstream  in(payload);
+    std::string         line;
+    while (std::getline(in, line)) {
+        if (line.empty())
+            continue;
+        auto eq = line.find('=');
+        if (eq == std::string::npos) {
+            error = "malformed request line '" + line + "'";
+            return false;
+        }
+        std::string key = line.substr(0, eq);
+        std::string val = line.substr(eq + 1);
+        if (key == "pdf")
+            req.pdf_file = val;
+        else if (key == "force") {
+            if (!FindInVector(v_ArlPDFVersions, val) && (val != "exact") && !val.empty()) {
+                error = "invalid force PDF version '" + val + "'";
+                return false;
+            }
+            req.force_version = val;
+        }
+        else if (key == "extensions")
+            req.extns = split(val, ',');
+        else if (key == "brief")
+            req.terse = (val == "1") || (val == "true");
+        else if (key == "debug")
+            req.debug_mode = (val == "1") || (val == "true");
+        else if (key == "password")
+            req.password = ToWString(val);
+        else if (key == "format") {
+            if ((val != "text") && (val != "jsonl")) {
+                error = "invalid report format '" + val + "'";
+                return false;
+            }
+            req.format = (val == "jsonl") ? ReportFormat::JSONL : ReportFormat::Text;
+        }
+        else {
+            error = "unknown request key '" + key + "'";
+            return false;
+        }
+    }
+    if (req.pdf_file.empty()) {
+        error = "no PDF was specified";
+        return false;
+    }
+    return true;
+}
+
+
+/// @brief Handles the next request on a client connection
+///
+/// @param[in] conn      client connection with a request waiting
+/// @param[in] worker    worker thread number
+/// @param[in] defaults  default options for the request
+/// @param[in] check     checks a single PDF
+///
+/// @returns true if the connection can be used for another request, false if it is to be closed
+static bool serve_one_request(int conn, const unsigned int worker, const serve_request& defaults, serve_check_fn& check) {
+    uint32_t len = 0;
+    int      pdf_fd = -1;
+    bool     keep = false;
+    if (sock_read_u32(conn, len, &pdf_fd) && (len <= MAX_REQUEST_SIZE)) {
+        std::string payload(len, '\0');
+        if (sock_read(conn, &payload[0], len, &pdf_fd)) {
+            serve_request       req = defaults;
+            std::string         error;
+            socket_streambuf    sbuf(conn);
+            std::ostream        ofs(&sbuf);
+            ServeStatus         status;
+            if (pdf_fd >= 0)
+                req.pdf_file = "/dev/fd/" + std::to_string(pdf_fd);
+            if (parse_request(payload, req, error)) {
+                // A file descriptor sent with the request takes precedence over any "pdf" path
+                if (pdf_fd >= 0)
+                    req.pdf_file = "/dev/fd/" + std::to_string(pdf_fd);
+                status = check(worker, req, ofs) ? ServeStatus::OK : ServeStatus::Fatal;
+            }
+            else {
+                ofs << COLOR_ERROR << "bad request: " << error << COLOR_RESET;
+                status = ServeStatus::BadRequest;
+            }
+            ofs.flush();
+            keep = sbuf.finish(status);
+        }
+    }
+    if (pdf_fd >= 0)
+        close(pdf_fd);
+    return keep;
+}
+
+
+/// @brief Runs the validation server on a Unix domain socket until SIGINT or SIGTERM.
+/// Requests, not connections, are handed to the worker threads: the main thread waits for the
+/// next request on every idle connection, so idle clients never tie up a worker.
+///
+/// @param[in] socket_path  Unix domain socket to create (an existing socket is replaced)
+/// @param[in] workers      number of worker threads
+/// @param[in] defaults     default options for each request
+/// @param[in] check        checks a single PDF
+///
+/// @returns 0 on success, -1 if the server could not be started
+int serve(const fs::path& socket_path, const unsigned int workers, const serve_request& defaults, serve_check_fn check) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.string().size() >= sizeof(addr.sun_path)) {
+        std::cerr << COLOR_ERROR << "--serve socket path " << socket_path << " is too long!" << COLOR_RESET;
+        return -1;
+    }
+    strncpy(addr.sun_path, socket_path.string().c_str(), sizeof(addr.sun_path) - 1);
+
+    struct stat st;
+    if ((stat(addr.sun_path, &st) == 0) && S_ISSOCK(st.st_mode))
+        (void)unlink(addr.sun_path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((listener < 0) || (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) != 0) || (listen(listener, 64) != 0)) {
+        std::cerr << COLOR_ERROR << "--serve could not listen on " << socket_path << ": " << strerror(errno) << COLOR_RESET;
+        if (listener >= 0)
+            close(listener);
+        return -1;
+    }
+
+    // No SA_RESTART so that accept() is interrupted
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = serve_signal_handler;
+    sigemptyset(&sa.sa_mask);
+    (void)sigaction(SIGINT, &sa, nullptr);
+    (void)sigaction(SIGTERM, &sa, nullptr);
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    // Workers hand connections back to the main thread through "returned" and wake up poll() with wake_pipe
+    int wake_pipe[2];
+    if (pipe(wake_pipe) != 0) {
+        std::cerr << COLOR_ERROR << "--serve could not create a pipe: " << strerror(errno) << COLOR_RESET;
+        close(listener);
+        return -1;
+    }
+    (void)fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+    (void)fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+
+    std::mutex      conn_mutex;
+    std::set<int>   active;                 // connections with a request being handled by a worker
+    std::queue<int> pending;                // connections with a request waiting for a worker
+    std::vector<int> returned;              // connections handed back by workers after a request
+    std::vector<int> idle;                  // connections waiting for their next request (main thread only)
+    std::condition_variable conn_cv;
+    bool            stopping = false;
+
+    std::vector<std::thread> pool;
+    for (unsigned int w = 0; w < std::max(1u, workers); w++)
+        pool.emplace_back([&, w]() {
+            while (true) {
+                int conn;
+                {
+                    std::unique_lock<std::mutex> lock(conn_mutex);
+                    conn_cv.wait(lock, [&] { return stopping || !pending.empty(); });
+                    if (stopping)
+                        return;
+                    conn = pending.front();
+                    pending.pop();
+                    active.insert(conn);
+                }
+                bool keep = serve_one_request(conn, w, defaults, check);
+                {
+                    std::lock_guard<std::mutex> lock(conn_mutex);
+                    active.erase(conn);
+                    if (keep && !stopping) {
+                        returned.push_back(conn);
+                        (void)!write(wake_pipe[1], "", 1);
+                        continue;
+                    }
+                }
+                close(conn);
+            }
+        });
+
+    std::cout << "Serving on " << socket_path << " with " << pool.size() << " worker(s)" << std::endl;
+    std::vector<struct pollfd> fds;
+    while (!serve_stop) {
+        {
+            std::lock_guard<std::mutex> lock(conn_mutex);
+            idle.insert(idle.end(), returned.begin(), returned.end());
+            returned.clear();
+        }
+        fds.clear();
+        fds.push_back({ listener, POLLIN, 0 });
+        fds.push_back({ wake_pipe[0], POLLIN, 0 });
+        for (int conn : idle)
+            fds.push_back({ conn, POLLIN, 0 });
+        if (poll(fds.data(), (nfds_t)fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cerr << COLOR_ERROR << "--serve poll failed: " << strerror(errno) << COLOR_RESET;
+            break;
+        }
+        if (fds[1].revents != 0) {
+            char drain[64];
+            while (read(wake_pipe[0], drain, sizeof(drain)) > 0)
+                ;
+        }
+
+        // A request (or the end of the connection) on an idle connection is handed to a worker
+        std::vector<int> still_idle;
+        for (size_t i = 2; i < fds.size(); i++)
+            if (fds[i].revents != 0) {
+                std::lock_guard<std::mutex> lock(conn_mutex);
+                pending.push(fds[i].fd);
+                conn_cv.notify_one();
+            }
+            else
+                still_idle.push_back(fds[i].fd);
+        idle.swap(still_idle);
+
+        if (fds[0].revents != 0) {
+            int conn = accept(listener, nullptr, nullptr);
+            if (conn >= 0)
+                idle.push_back(conn);
+            else if ((errno != EINTR) && (errno != ECONNABORTED)) {
+                std::cerr << COLOR_ERROR << "--serve accept failed: " << strerror(errno) << COLOR_RESET;
+                break;
+            }
+        }
+    }
+
+    // Stop: requests being handled are finished, connections that are still reading a request are woken up
+    {
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        stopping = true;
+        for (int conn : active)
+            (void)shutdown(conn, SHUT_RD);
+    }
+    conn_cv.notify_all();
+    for (auto& t : pool)
+        t.join();
+    while (!pending.empty()) {
+        close(pending.front());
+        pending.pop();
+    }
+    for (int conn : idle)
+        close(conn);
+    for (int conn : returned)
+        close(conn);
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    close(listener);
+    (void)unlink(addr.sun_path);
+    std::cout << "Server stopped" << std::endl;
+    return 0;
+}
+
+
+/// @brief Connects to a server
+///
+/// @param[in] socket_path    the server's Unix domain socket
+///
+/// @returns the connection, or -1 (with an error written)
+static int connect_to_server(const fs::path& socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path.string().c_str(), sizeof(addr.sun_path) - 1);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((sock < 0) || (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0)) {
+        std::cerr << COLOR_ERROR << "--connect could not connect to " << socket_path << ": " << strerror(errno) << COLOR_RESET;
+        if (sock >= 0)
+            close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+
+/// @brief Sends each PDF to a server, optionally saving the reports, and reports latency percentiles.
+/// Each connection sends one request at a time, so the number of connections is the number of
+/// requests in flight.
+///
+/// @param[in] socket_path    the server's Unix domain socket
+/// @param[in] pdfs           PDF files to check
+/// @param[in] save_path      folder for reports or empty to discard reports
+/// @param[in] rpt_extension  file extension of saved reports (".txt", ".ansi" or ".jsonl")
+/// @param[in] options        extra "key=value" request lines
+/// @param[in] connections    number of connections to the server (at least 1)
+///
+/// @returns 0 if all PDFs were checked without fatal errors, otherwise -1
+int serve_client(const fs::path& socket_path, const std::vector<fs::path>& pdfs, const fs::path& save_path, const std::string& rpt_extension, const std::string& options, const unsigned int connections) {
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    // PDFs in different folders can have the same name so add underscores, as for --pdf
+    std::vector<fs::path>   rptfiles(pdfs.size());
+    if (!save_path.empty()) {
+        std::set<std::string> saved;
+        for (size_t i = 0; i < pdfs.size(); i++) {
+            std::string stem = pdfs[i].stem().string();
+            do {
+                rptfiles[i] = save_path / (stem + rpt_extension);
+                stem += "_";
+            } while (!saved.insert(rptfiles[i].string()).second);
+        }
+    }
+
+    unsigned int n_conns = (unsigned int)std::max<size_t>(1, std::min<size_t>(std::max(1u, connections), pdfs.size()));
+    std::cout << "Sending " << pdfs.size() << " PDF(s) over " << n_conns << " connection(s), one request at a time per connection" << std::endl;
+
+    int                 retval = 0;
+    std::vector<double> latencies;
+    std::mutex          client_mutex;   // protects retval, latencies and std::cout
+    std::atomic<size_t> next_pdf(0);
+
+    auto send_pdfs = [&]() {
+        int sock = connect_to_server(socket_path);
+        if (sock < 0) {
+            std::lock_guard<std::mutex> lock(client_mutex);
+            retval = -1;
+            return;
+        }
+        std::vector<char>   frame;
+        size_t              i;
+        while ((i = next_pdf++) < pdfs.size()) {
+            const fs::path& pdf = pdfs[i];
+            std::string payload = "pdf=" + fs::absolute(pdf).lexically_normal().string() + "\n" + options;
+            std::ofstream rpt;
+            if (!rptfiles[i].empty())
+                rpt.open(rptfiles[i], std::ofstream::out | std::ofstream::trunc);
+
+            auto start = std::chrono::steady_clock::now();
+            uint32_t len = 0;
+            uint32_t status = 0;
+            bool     ok = sock_write_u32(sock, (uint32_t)payload.size()) && sock_write(sock, payload.data(), payload.size());
+            while (ok && (ok = sock_read_u32(sock, len)) && (len > 0)) {
+                frame.resize(len);
+                if (!(ok = sock_read(sock, frame.data(), len)))
+                    break;
+                if (rpt.is_open())
+                    rpt.write(frame.data(), len);
+            }
+            std::lock_guard<std::mutex> lock(client_mutex);
+            if (!ok || !sock_read_u32(sock, status)) {
+                std::cerr << COLOR_ERROR << "--connect lost connection to server" << COLOR_RESET;
+                retval = -1;
+                break;
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            latencies.push_back(ms);
+
+            std::cout << "Processed " << pdf.lexically_normal() << " in " << std::fixed << std::setprecision(1) << ms << " ms ";
+            if (status != (uint32_t)ServeStatus::OK) {
+                std::cout << COLOR_ERROR << (status == (uint32_t)ServeStatus::BadRequest ? "- BAD REQUEST!" : "- FATAL ERROR!") << COLOR_RESET_NO_EOL;
+                retval = -1;
+            }
+            std::cout << std::endl;
+        }
+        close(sock);
+    };
+
+    std::vector<std::thread> senders;
+    for (unsigned int c = 1; c < n_conns; c++)
+        senders.emplace_back(send_pdfs);
+    send_pdfs();
+    for (auto& t : senders)
+        t.join();
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        auto pct = [&](double p) { return latencies[std::min(latencies.size() - 1, (size_t)(p * (double)latencies.size()))]; };
+        std::cout << "Latency: " << latencies.size() << " requests over " << n_conns << " connection(s), p50 " << std::fixed << std::setprecision(1) << pct(0.50)
+                  << " ms, p99 " << pct(0.99) << " ms, max " << latencies.back() << " ms" << std::endl;
+    }
+    return retval;
+}
+
+#endif // _WIN32 || WIN32
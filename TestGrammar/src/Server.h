@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Long-running validation server (--serve) and its client (--connect)
+///
+/// Protocol over a Unix domain stream socket. All lengths are 32-bit big-endian.
+/// - request:  length + payload of "key=value" lines: pdf (required), force,
+///             extensions, brief, debug, password. The PDF may instead be passed
+///             as an open file descriptor (SCM_RIGHTS) sent with the request.
+/// - response: any number of (length + report data) frames, then a 0 length,
+///             then a 32-bit status: 0 = OK, 1 = fatal error, 2 = bad request.
+/// A connection can be used for any number of requests.
+///
+/// @copyright
+/// Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef Server_h
+#define Server_h
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ArlMessages.h"
+
+namespace fs = std::filesystem;
+
+
+/// @brief Response status codes
+enum class ServeStatus : uint32_t {
+    OK          = 0,
+    Fatal       = 1,
+    BadRequest  = 2
+};
+
+
+/// @brief A single validation request. Defaults come from the server command line.
+struct serve_request {
+    fs::path                    pdf_file;
+    std::string                 force_version;
+    std::vector<std::string>    extns;
+    bool                        terse = false;
+    bool                        debug_mode = false;
+    std::wstring                password;
+    ReportFormat                format = ReportFormat::Text;
+};
+
+
+/// @brief Checks a single PDF for a server worker thread, writing the report to ofs.
+/// Returns false on a fatal error.
+typedef std::function<bool(const unsigned int worker, const serve_request& req, std::ostream& ofs)> serve_check_fn;
+
+/// @brief Runs the server until SIGINT or SIGTERM
+int serve(const fs::path& socket_path, const unsigned int workers, const serve_request& defaults, serve_check_fn check);
+
+/// @brief Sends each PDF to a server over one or more connections and reports per-request latency
+int serve_client(const fs::path& socket_path, const std::vector<fs::path>& pdfs, const fs::path& save_path, const std::string& rpt_extension, const std::string& options, const unsigned int connections = 1);
+
+#endif // Server_h
@@ -29,6 +29,9 @@
 #include "utils.h"
 #include "ArlPredicates.h"
 
+// pdfium's vendored zlib (always compiled, regardless of PDF SDK)
+#include "core/src/fxcodec/fx_zlib/zlib_v128/zlib.h"
+
 #include <iostream>
 #include <locale>
 #include <codecvt>
@@ -40,14 +43,27 @@
 
 #ifdef _WIN32
 #include <Windows.h>
+#include <Psapi.h>
+#pragma comment(lib, "psapi.lib")
 extern HINSTANCE ghInstance;
 #else
 #include <cstring>
 #include <limits.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
 #endif // _WIN32
 
 
+/// @brief /dev/null equivalent streams for chars - see https://stackoverflow.com/questions/6240950/platform-independent-dev-null-in-c#6240980
+std::ostream  cnull(0);
+
+/// @brief /dev/null equivalent stream for wide chars - see https://stackoverflow.com/questions/6240950/platform-independent-dev-null-in-c#6240980
+std::wostream wcnull(0);
+
+/// @brief Global control over colorized output
+bool no_color = false;
+
+
 /// @brief Converts a Unicode string to UTF8
 ///
 /// @param[in] unicode Unicode input
@@ -328,6 +344,25 @@ bool iequals(const std::string& a, const std::string& b)
 }
 
 
+/// @brief Case INsensitive check for a ".pdf" extension. Same result as
+/// iequals(p.extension().string(), ".pdf") but without creating any strings,
+/// as it is called for every file in a folder.
+///
+/// @param[in] p   file name
+///
+/// @returns true if p has a .pdf extension
+bool has_pdf_extension(const std::filesystem::path& p)
+{
+    const auto&  n = p.native();
+    const size_t len = n.size();
+    // need at least 1 character in the filename before ".pdf" (".pdf" is a hidden file with no extension)
+    if ((len < 5) || (n[len - 4] != '.') || (n[len - 5] == '/') || (n[len - 5] == std::filesystem::path::preferred_separator))
+        return false;
+    // ASCII lowercase via 0x20 bit so that non-ASCII characters never match
+    return ((n[len - 3] | 0x20) == 'p') && ((n[len - 2] | 0x20) == 'd') && ((n[len - 1] | 0x20) == 'f');
+}
+
+
 /// @brief Case INsensitive substring search
 ///
 /// @param[in] s   string 
@@ -624,3 +659,138 @@ std::string rightTrim(const std::string& s) {
 std::string trim(const std::string& s) {
     return rightTrim(leftTrim(s));
 }
+
+
+/// @brief Peak memory use (resident set size / working set) of this process so far
+/// @returns peak memory in MB or 0 if unknown
+unsigned int get_peak_memory_mb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return (unsigned int)(pmc.PeakWorkingSetSize / (1024 * 1024));
+    return 0;
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return (unsigned int)(ru.ru_maxrss / (1024 * 1024));   // bytes
+#else
+    return (unsigned int)(ru.ru_maxrss / 1024);            // kilobytes
+#endif
+#endif // _WIN32
+}
+
+
+/// @brief Opens a report file. A gzip stream is started if a compression level is set.
+///
+/// @param[in] fname  report filename
+/// @param[in] mode   file open mode
+///
+/// @returns true if the file was opened
+bool CReportBuf::open(const std::filesystem::path& fname, std::ios_base::openmode mode) {
+    close();
+    file.open(fname, ((level > 0) ? (mode | std::ios_base::binary) : mode));
+    if (!file.is_open())
+        return false;
+    if (level > 0) {
+        zs = new z_stream();
+        // pdfium's zlib is built with NO_GZIP so write a raw deflate stream
+        // with a gzip header (RFC 1952) and trailer added here
+        if (deflateInit2(zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            delete zs;
+            zs = nullptr;
+            file.close();
+            return false;
+        }
+        if (zbuffer == nullptr)
+            zbuffer.reset(new char[REPORT_BUFFER_SIZE]);
+        crc = crc32(0L, Z_NULL, 0);
+        total_in = 0;
+        const char gzip_header[10] = { '\x1F', '\x8B', Z_DEFLATED, 0, 0, 0, 0, 0, 0, '\x03' /* Unix */ };
+        file.write(gzip_header, sizeof(gzip_header));
+    }
+    return true;
+}
+
+
+/// @brief Writes the buffered data to the file, compressing it if needed
+///
+/// @param[in] flush  Z_NO_FLUSH, Z_SYNC_FLUSH or Z_FINISH (to end the gzip stream)
+///
+/// @returns true on success
+bool CReportBuf::write_buffer(const int flush) {
+    std::streamsize n = pptr() - pbase();
+    setp(buffer.get(), buffer.get() + REPORT_BUFFER_SIZE);
+    if (!file.is_open())
+        return false;
+    if (zs == nullptr) {
+        if (n > 0)
+            file.write(buffer.get(), n);
+        return !file.fail();
+    }
+
+    crc = crc32(crc, (const Bytef*)buffer.get(), (uInt)n);
+    total_in += (unsigned long)n;
+    zs->next_in = (Bytef*)buffer.get();
+    zs->avail_in = (uInt)n;
+    int rc;
+    do {
+        zs->next_out = (Bytef*)zbuffer.get();
+        zs->avail_out = (uInt)REPORT_BUFFER_SIZE;
+        rc = deflate(zs, flush);
+        if (rc == Z_STREAM_ERROR)
+            return false;
+        file.write(zbuffer.get(), (std::streamsize)REPORT_BUFFER_SIZE - zs->avail_out);
+        // Z_BUF_ERROR is only returned when there was nothing to do
+    } while ((rc != Z_BUF_ERROR) && ((zs->avail_out == 0) || ((flush == Z_FINISH) && (rc != Z_STREAM_END))));
+
+    if (flush == Z_FINISH) {
+        // gzip trailer: CRC-32 and uncompressed size modulo 2^32, both little-endian
+        char gzip_trailer[8];
+        for (int i = 0; i < 4; i++) {
+            gzip_trailer[i]     = (char)((crc >> (8 * i)) & 0xFF);
+            gzip_trailer[i + 4] = (char)((total_in >> (8 * i)) & 0xFF);
+        }
+        file.write(gzip_trailer, sizeof(gzip_trailer));
+    }
+    return !file.fail();
+}
+
+
+/// @brief Buffer is full
+std::streambuf::int_type CReportBuf::overflow(int_type ch) {
+    if (!write_buffer(Z_NO_FLUSH))
+        return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+
+/// @brief Explicit flush
+int CReportBuf::sync() {
+    if (!write_buffer(Z_SYNC_FLUSH))
+        return -1;
+    file.flush();
+    return file.fail() ? -1 : 0;
+}
+
+
+/// @brief Writes all buffered data, ends the gzip stream (if compressing) and closes the file
+///
+/// @returns true on success
+bool CReportBuf::close() {
+    if (!file.is_open())
+        return true;
+    bool ok = write_buffer(Z_FINISH);
+    if (zs != nullptr) {
+        (void)deflateEnd(zs);
+        delete zs;
+        zs = nullptr;
+    }
+    file.close();
+    return ok && !file.fail();
+}
@@ -26,6 +26,8 @@
 
 #include <string>
 #include <filesystem>
+#include <fstream>
+#include <memory>
 #include <vector>
 
 /// @brief Macro to silence unreferenced formal parameter warnings
@@ -50,7 +52,8 @@ extern bool no_color;
 inline std::ostream& COLOR_RESET_NO_EOL(std::ostream& os) { if (!no_color) { os << COLOR_RESET_ANSI; } return os; }
 
 /// @brief Inline function to reset terminal colors for text outout if not disabled. Also outputs EOL.
-inline std::ostream& COLOR_RESET(std::ostream& os)    { if (!no_color) { os << COLOR_RESET_ANSI; } os << std::endl; return os; }
+/// Does not flush, as reports can have hundreds of thousands of lines. CParsePDF::report() flushes every 512 messages.
+inline std::ostream& COLOR_RESET(std::ostream& os)    { if (!no_color) { os << COLOR_RESET_ANSI; } os << '\n'; return os; }
 
 /// @brief Inline function to set error color for text outout if not disabled
 inline std::ostream& COLOR_ERROR(std::ostream& os) { if (!no_color) { os << COLOR_ERROR_ANSI; } os << "Error: "; return os; }
@@ -94,6 +97,9 @@ std::string strip_leading_whitespace(const std::string& str);
 /// @brief Case insensitive comparison of two strings
 bool iequals(const std::string& a, const std::string& b);
 
+/// @brief Returns true if a file has a ".pdf" extension (case insensitive)
+bool has_pdf_extension(const std::filesystem::path& p);
+
 /// @brief Case insensitive substring match of s1 in s
 bool icontains(const std::string& s, const std::string& s1);
 
@@ -127,4 +133,84 @@ std::string rightTrim(const std::string & s);
 /// @brief Generic whitespace trimming of strings (NOT for use with TSV data!)
 std::string trim(const std::string & s);
 
+/// @brief Peak memory use of this process so far in MB (0 if unknown)
+unsigned int get_peak_memory_mb();
+
+
+/// @brief Size of the output buffer of a CReportFile
+constexpr std::streamsize REPORT_BUFFER_SIZE = 1024 * 1024;
+
+/// @brief zlib stream state (zlib.h is only included by Utils.cpp)
+struct z_stream_s;
+
+/// @class CReportBuf
+/// Stream buffer of a CReportFile. Buffered data is written to the file, or gzip-compressed
+/// first if a compression level was set, when the buffer is full, on sync() and on close().
+class CReportBuf : public std::streambuf {
+    std::ofstream               file;
+    std::unique_ptr<char[]>     buffer;
+    std::unique_ptr<char[]>     zbuffer;    // compressed data
+    z_stream_s*                 zs;         // nullptr unless compressing
+    int                         level;      // gzip compression level or 0
+    unsigned long               crc;        // CRC-32 of the uncompressed data
+    unsigned long               total_in;   // size of the uncompressed data
+
+    bool write_buffer(const int flush);
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+public:
+    CReportBuf()
+        : buffer(new char[REPORT_BUFFER_SIZE]), zs(nullptr), level(0), crc(0), total_in(0)
+        { setp(buffer.get(), buffer.get() + REPORT_BUFFER_SIZE); }
+
+    ~CReportBuf() { close(); }
+
+    void set_compression(const int lvl) { level = lvl; }
+    bool open(const std::filesystem::path& fname, std::ios_base::openmode mode);
+    bool is_open() const { return file.is_open(); }
+    bool close();
+};
+
+
+/// @class CReportFile
+/// Output file stream for reports with a large buffer, so that a report is written
+/// in a few large writes rather than a write per line. Data is written when the buffer
+/// is full, on an explicit flush() and on close(). Can be reopened for another report.
+/// Reports can be gzip-compressed as they are written (--compress).
+class CReportFile : public std::ostream {
+    CReportBuf  buf;
+
+public:
+    CReportFile()
+        : std::ostream(nullptr)
+        { rdbuf(&buf); }
+
+    CReportFile(const std::filesystem::path& fname, std::ios_base::openmode mode, const int compression = 0)
+        : CReportFile()
+        {
+            buf.set_compression(compression);
+            open(fname, mode);
+        }
+
+    /// @brief gzip compression level (1 to 9) of reports opened afterwards, or 0 for no compression
+    void set_compression(const int level) { buf.set_compression(level); }
+
+    void open(const std::filesystem::path& fname, std::ios_base::openmode mode) {
+        if (buf.open(fname, mode))
+            clear();
+        else
+            setstate(std::ios_base::failbit);
+    }
+
+    bool is_open() const { return buf.is_open(); }
+
+    void close() {
+        if (!buf.close())
+            setstate(std::ios_base::failbit);
+    }
+};
+
 #endif // Utils_h
@@ -0,0 +1,42 @@
+#!/bin/sh
+# Checks that --compress reports are valid gzip files that decompress to the uncompressed reports.
+#
+# Usage: compress-roundtrip.sh <TestGrammar> <tsvdir> <pdf> [<pdf> ...]
+#
+# Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+# SPDX-License-Identifier: Apache-2.0
+
+set -u
+TESTGRAMMAR=$1
+TSVDIR=$2
+shift 2
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+failed=0
+
+for pdf in "$@"; do
+    for format in text jsonl; do
+        rm -rf "$WORK/plain" "$WORK/gzip"
+        mkdir "$WORK/plain" "$WORK/gzip"
+        "$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --format $format --pdf "$pdf" --out "$WORK/plain" > /dev/null
+        "$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --format $format --pdf "$pdf" --out "$WORK/gzip" --compress 6 > /dev/null
+
+        plain=$(ls "$WORK/plain"/*)
+        gz=$(ls "$WORK/gzip"/*.gz)
+        if [ ! -s "$plain" ] || [ ! -s "$gz" ]; then
+            echo "FAIL: $pdf ($format): report missing"
+            failed=1
+        elif ! gzip -t "$gz"; then
+            echo "FAIL: $pdf ($format): $(basename "$gz") is not a valid gzip file"
+            failed=1
+        elif ! gzip -dc "$gz" | diff -q - "$plain" > /dev/null; then
+            echo "FAIL: $pdf ($format): decompressed report differs from the uncompressed report"
+            failed=1
+        else
+            echo "OK: $pdf ($format)"
+        fi
+    done
+done
+
+exit $failed
@@ -0,0 +1,53 @@
+#!/bin/sh
+# Checks that a --journal run over a folder of PDFs skips the PDFs completed by an earlier
+# (here partial, --shard 1/2) run with the same journal, and checks all the others.
+#
+# Usage: journal-resume.sh <TestGrammar> <tsvdir> <pdf> [<pdf> ...]
+#
+# Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+# SPDX-License-Identifier: Apache-2.0
+
+set -u
+TESTGRAMMAR=$1
+TSVDIR=$2
+shift 2
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+mkdir "$WORK/pdfs" "$WORK/first" "$WORK/resumed" "$WORK/again"
+# Several copies of each PDF so that the PDFs spread over the shards
+for pdf in "$@"; do
+    for i in 1 2 3 4; do
+        cp "$pdf" "$WORK/pdfs/$(basename "$pdf" .pdf)-$i.pdf"
+    done
+done
+ls "$WORK/pdfs" | sed 's/\.pdf$//' | sort > "$WORK/all.txt"
+JOURNAL="$WORK/journal.txt"
+failed=0
+
+"$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --brief --pdf "$WORK/pdfs" --out "$WORK/first" --shard 1/2 --journal "$JOURNAL" > /dev/null
+"$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --brief --pdf "$WORK/pdfs" --out "$WORK/resumed" --journal "$JOURNAL" --jobs 2 > /dev/null
+"$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --brief --pdf "$WORK/pdfs" --out "$WORK/again" --journal "$JOURNAL" > /dev/null
+
+# The first and resumed runs check every PDF exactly once
+(ls "$WORK/first"; ls "$WORK/resumed") | sed 's/\.txt$//' | sort > "$WORK/checked.txt"
+if ! diff "$WORK/checked.txt" "$WORK/all.txt" > /dev/null; then
+    echo "FAIL: resumed run did not check exactly the PDFs missing from the journal:"
+    diff "$WORK/checked.txt" "$WORK/all.txt"
+    failed=1
+fi
+
+# The journal has one completed entry for each PDF, so nothing is left to check
+grep -v '^#' "$JOURNAL" | cut -f2 | sed 's|.*/||; s/\.pdf$//' | sort > "$WORK/journaled.txt"
+if ! diff "$WORK/journaled.txt" "$WORK/all.txt" > /dev/null; then
+    echo "FAIL: journal does not record each PDF once:"
+    diff "$WORK/journaled.txt" "$WORK/all.txt"
+    failed=1
+fi
+if [ -n "$(ls "$WORK/again")" ]; then
+    echo "FAIL: PDFs checked again although all are in the journal: $(ls "$WORK/again")"
+    failed=1
+fi
+
+[ $failed -eq 0 ] && echo "OK: $(ls "$WORK/first" | wc -l) then $(ls "$WORK/resumed" | wc -l) PDF(s) checked, none on the third run"
+exit $failed
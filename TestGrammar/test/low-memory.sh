@@ -0,0 +1,80 @@
+#!/bin/sh
+# Checks that --low-memory gives the same reports as a normal run for a PDF with 20,000 pages and
+# that its peak memory does not grow with the number of pages like a normal run does (about 3 KB a page).
+#
+# Usage: low-memory.sh <TestGrammar> <tsvdir>
+#
+# Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+# SPDX-License-Identifier: Apache-2.0
+
+set -u
+TESTGRAMMAR=$1
+TSVDIR=$2
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+mkdir "$WORK/normal" "$WORK/low"
+failed=0
+
+# A PDF with a flat page tree of n pages, each with its own content stream and a shared font.
+# All pages are queued at once when /Kids is checked so the queue is far longer than is kept in memory.
+make_pdf() {
+    awk -v n="$1" 'BEGIN {
+        pos = 0
+        out("%PDF-1.7\n")
+        off[1] = pos; out("1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n")
+        off[2] = pos; out("2 0 obj\n<< /Type /Pages /Count " n " /Kids [")
+        for (i = 0; i < n; i++)
+            out((4 + 2 * i) " 0 R ")
+        out("] >>\nendobj\n")
+        off[3] = pos; out("3 0 obj\n<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>\nendobj\n")
+        for (i = 0; i < n; i++) {
+            p = 4 + 2 * i
+            off[p] = pos; out(p " 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] /Resources << /Font << /F1 3 0 R >> >> /Contents " (p + 1) " 0 R >>\nendobj\n")
+            s = "BT /F1 12 Tf 72 720 Td (Page " i ") Tj ET"
+            off[p + 1] = pos; out((p + 1) " 0 obj\n<< /Length " length(s) " >>\nstream\n" s "\nendstream\nendobj\n")
+        }
+        total = 4 + 2 * n
+        xref = pos
+        out("xref\n0 " total "\n0000000000 65535 f \n")
+        for (i = 1; i < total; i++)
+            out(sprintf("%010d 00000 n \n", off[i]))
+        out("trailer\n<< /Size " total " /Root 1 0 R >>\nstartxref\n" xref "\n%%EOF\n")
+    }
+    function out(s) { printf "%s", s; pos += length(s) }' > "$2"
+}
+
+# Peak memory in MB of a --low-memory run, from "(peak memory N MB)" on stdout
+peak_mb() {
+    "$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --brief --low-memory --pdf "$1" --out "$WORK/low" --clobber | sed -n 's/.*(peak memory \([0-9]*\) MB).*/\1/p'
+}
+
+make_pdf 2000 "$WORK/pages-2k.pdf"
+make_pdf 20000 "$WORK/pages-20k.pdf"
+
+for format in text jsonl; do
+    "$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --format $format --pdf "$WORK/pages-20k.pdf" --out "$WORK/normal" > /dev/null
+    "$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --format $format --pdf "$WORK/pages-20k.pdf" --out "$WORK/low" --low-memory > /dev/null
+    if ! diff -q "$WORK/normal"/pages-20k.* "$WORK/low"/pages-20k.* > /dev/null; then
+        echo "FAIL: --low-memory report differs ($format)"
+        failed=1
+    else
+        echo "OK: --low-memory report is the same ($format)"
+    fi
+    rm -f "$WORK/normal"/* "$WORK/low"/*
+done
+
+small=$(peak_mb "$WORK/pages-2k.pdf")
+large=$(peak_mb "$WORK/pages-20k.pdf")
+if [ -z "$small" ] || [ -z "$large" ]; then
+    echo "FAIL: --low-memory did not report peak memory"
+    failed=1
+elif [ $((large - small)) -ge 25 ]; then
+    # a normal run needs about 55 MB more for the 18,000 extra pages
+    echo "FAIL: --low-memory peak memory grew from $small MB (2,000 pages) to $large MB (20,000 pages)"
+    failed=1
+else
+    echo "OK: --low-memory peak memory $small MB (2,000 pages), $large MB (20,000 pages)"
+fi
+
+exit $failed
@@ -0,0 +1,55 @@
+#!/bin/sh
+# Checks that --max-seconds stops checking a page with very many keys, that the report says so
+# even though no other objects were left to check, and that --cache does not keep the report.
+#
+# Usage: max-seconds-budget.sh <TestGrammar> <tsvdir>
+#
+# Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+# SPDX-License-Identifier: Apache-2.0
+
+set -u
+TESTGRAMMAR=$1
+TSVDIR=$2
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+mkdir "$WORK/out" "$WORK/cache"
+failed=0
+
+# A PDF whose only page has 400,000 keys, which takes far longer than a second to check.
+# The page is the last object that is queued so the deadline passes inside its dictionary.
+awk -v n=400000 'BEGIN {
+    pos = 0
+    out("%PDF-1.7\n")
+    off[1] = pos; out("1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n")
+    off[2] = pos; out("2 0 obj\n<< /Type /Pages /Kids [3 0 R] /Count 1 >>\nendobj\n")
+    off[3] = pos; out("3 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792]\n")
+    for (i = 0; i < n; i++)
+        out("/K" i " " i "\n")
+    out(">>\nendobj\n")
+    xref = pos
+    out("xref\n0 4\n0000000000 65535 f \n")
+    for (i = 1; i <= 3; i++)
+        out(sprintf("%010d 00000 n \n", off[i]))
+    out("trailer\n<< /Size 4 /Root 1 0 R >>\nstartxref\n" xref "\n%%EOF\n")
+}
+function out(s) { printf "%s", s; pos += length(s) }' > "$WORK/many-keys.pdf"
+
+"$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --brief --pdf "$WORK/many-keys.pdf" --out "$WORK/out" --max-seconds 1 --cache "$WORK/cache" > /dev/null
+if ! grep -q '^Error: budget exceeded (--max-seconds 1)' "$WORK/out/many-keys.txt"; then
+    echo "FAIL: text report does not say that --max-seconds was exceeded"
+    failed=1
+fi
+if [ -n "$(find "$WORK/cache" -type f)" ]; then
+    echo "FAIL: report cut short by --max-seconds was cached"
+    failed=1
+fi
+
+"$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --brief --format jsonl --pdf "$WORK/many-keys.pdf" --out "$WORK/out" --max-seconds 1 > /dev/null
+if ! grep -q '"code":207,.*"key":"--max-seconds"' "$WORK/out/many-keys.jsonl"; then
+    echo "FAIL: JSON Lines report does not say that --max-seconds was exceeded"
+    failed=1
+fi
+
+[ $failed -eq 0 ] && echo "OK: --max-seconds reported and not cached"
+exit $failed
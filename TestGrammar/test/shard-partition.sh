@@ -0,0 +1,51 @@
+#!/bin/sh
+# Checks that the --shard k/n runs over a folder of PDFs together check every PDF exactly once,
+# and that each shard is the same with and without --jobs.
+#
+# Usage: shard-partition.sh <TestGrammar> <tsvdir> <pdf> [<pdf> ...]
+#
+# Copyright 2023 PDF Association, Inc. https://www.pdfa.org
+# SPDX-License-Identifier: Apache-2.0
+
+set -u
+TESTGRAMMAR=$1
+TSVDIR=$2
+shift 2
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+mkdir "$WORK/pdfs"
+# Several copies of each PDF so that the PDFs spread over the shards
+for pdf in "$@"; do
+    for i in 1 2 3 4; do
+        cp "$pdf" "$WORK/pdfs/$(basename "$pdf" .pdf)-$i.pdf"
+    done
+done
+ls "$WORK/pdfs" | sed 's/\.pdf$//' | sort > "$WORK/all.txt"
+failed=0
+
+for n in 1 2 3 4; do
+    : > "$WORK/union.txt"
+    k=1
+    while [ $k -le $n ]; do
+        rm -rf "$WORK/out" "$WORK/out-jobs"
+        mkdir "$WORK/out" "$WORK/out-jobs"
+        "$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --brief --pdf "$WORK/pdfs" --out "$WORK/out" --shard $k/$n > /dev/null
+        "$TESTGRAMMAR" --tsvdir "$TSVDIR" --no-color --brief --pdf "$WORK/pdfs" --out "$WORK/out-jobs" --shard $k/$n --jobs 2 > /dev/null
+        if [ "$(ls "$WORK/out")" != "$(ls "$WORK/out-jobs")" ]; then
+            echo "FAIL: shard $k/$n differs with --jobs 2"
+            failed=1
+        fi
+        ls "$WORK/out" | sed 's/\.txt$//' >> "$WORK/union.txt"
+        k=$((k + 1))
+    done
+    if ! sort "$WORK/union.txt" | diff - "$WORK/all.txt" > /dev/null; then
+        echo "FAIL: shards of $n do not check every PDF exactly once:"
+        sort "$WORK/union.txt" | diff - "$WORK/all.txt"
+        failed=1
+    else
+        echo "OK: $n shard(s)"
+    fi
+done
+
+exit $failed